@@ -36,6 +36,11 @@
 
 #include "kis_selection.h"
 #include <kis_iterator_ng.h>
+#include <kis_convolution_painter.h>
+#include <kis_convolution_kernel.h>
+#include <kis_gaussian_kernel.h>
+#include <kis_fast_gaussian_blur.h>
+#include <kis_circle_mask_generator.h>
 
 void KisBlurBenchmark::initTestCase()
 {
@@ -87,6 +92,97 @@ void KisBlurBenchmark::benchmarkFilter()
     }
 }
 
+void KisBlurBenchmark::benchmarkSeparableGaussian_data()
+{
+    QTest::addColumn<qreal>("radius");
+
+    QTest::newRow("radius-5") << 5.0;
+    QTest::newRow("radius-20") << 20.0;
+    QTest::newRow("radius-50") << 50.0;
+}
+
+void KisBlurBenchmark::benchmarkSeparableGaussian()
+{
+    QFETCH(qreal, radius);
+
+    /**
+     * A 2D Gaussian kernel is separable, so the painter
+     * applies it in two 1D passes
+     */
+    const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix =
+        KisGaussianKernel::createVerticalMatrix(radius) *
+        KisGaussianKernel::createHorizontalMatrix(radius);
+
+    KisConvolutionKernelSP kernel =
+        KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+
+    const QRect rc(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+    KisPaintDeviceSP dst = new KisPaintDevice(m_colorSpace);
+
+    QBENCHMARK{
+        KisConvolutionPainter painter(dst);
+        painter.applyMatrix(kernel, m_device, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+    }
+}
+
+void KisBlurBenchmark::benchmarkFastGaussian_data()
+{
+    QTest::addColumn<qreal>("radius");
+
+    QTest::newRow("radius-25") << 25.0;
+    QTest::newRow("radius-50") << 50.0;
+    QTest::newRow("radius-200") << 200.0;
+}
+
+void KisBlurBenchmark::benchmarkFastGaussian()
+{
+    QFETCH(qreal, radius);
 
+    const QRect rc(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+
+    QBENCHMARK{
+        KisPaintDeviceSP dev = new KisPaintDevice(*m_device);
+        KisFastGaussianBlur::apply(dev, rc, radius, radius, 0);
+    }
+}
+
+void KisBlurBenchmark::benchmarkConvolutionCrossover_data()
+{
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<bool>("useFFT");
+
+    const int radii[] = {2, 4, 6, 8, 10, 12, 16, 24};
+
+    for (int radius : radii) {
+        QTest::newRow(QString("spatial-radius-%1").arg(radius).toLatin1()) << radius << false;
+        QTest::newRow(QString("fft-radius-%1").arg(radius).toLatin1()) << radius << true;
+    }
+}
+
+void KisBlurBenchmark::benchmarkConvolutionCrossover()
+{
+    QFETCH(int, radius);
+    QFETCH(bool, useFFT);
+
+    /**
+     * A disk kernel is not separable, so the painter has to choose
+     * between the spatial and the FFT workers. The radius where the
+     * FFT rows become faster than the spatial ones is the threshold
+     * used by KisConvolutionPainter::useFFTImplemenation()
+     */
+    const int diameter = 2 * radius + 1;
+    KisCircleMaskGenerator gen(diameter, 1.0, 1.0, 1.0, 2, false);
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMaskGenerator(&gen);
+
+    const QRect rc(0, 0, 1024, 1024);
+    KisPaintDeviceSP dst = new KisPaintDevice(m_colorSpace);
+
+    QBENCHMARK{
+        KisConvolutionPainter painter(dst, useFFT ?
+                                      KisConvolutionPainter::FFTW :
+                                      KisConvolutionPainter::SPATIAL);
+        painter.applyMatrix(kernel, m_device, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+    }
+}
 
 QTEST_MAIN(KisBlurBenchmark)
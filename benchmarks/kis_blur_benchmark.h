@@ -39,6 +39,15 @@ private Q_SLOTS:
     void cleanupTestCase();
     
     void benchmarkFilter();
+
+    void benchmarkSeparableGaussian_data();
+    void benchmarkSeparableGaussian();
+
+    void benchmarkFastGaussian_data();
+    void benchmarkFastGaussian();
+
+    void benchmarkConvolutionCrossover_data();
+    void benchmarkConvolutionCrossover();
     
 };
 
@@ -37,6 +37,9 @@
 
 #include "kis_circle_mask_generator.h"
 #include "kis_rect_mask_generator.h"
+#include "kis_curve_circle_mask_generator.h"
+#include "kis_curve_rect_mask_generator.h"
+#include "kis_cubic_curve.h"
 
 void KisMaskGeneratorBenchmark::benchmarkCircle()
 {
@@ -60,7 +63,7 @@ void KisMaskGeneratorBenchmark::benchmarkCircle()
 #include "krita_utils.h"
 
 
-void benchmarkSIMD(qreal fade) {
+void benchmarkSIMD(KisMaskGenerator *gen) {
     const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
     KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
     dev->setRect(QRect(0, 0, 1000, 1000));
@@ -70,9 +73,7 @@ void benchmarkSIMD(qreal fade) {
                             0.0, 1.0,
                             500, 500, 0);
 
-    KisCircleMaskGenerator gen(1000, 1.0, fade, fade, 2, false);
-
-    KisBrushMaskApplicatorBase *applicator = gen.applicator();
+    KisBrushMaskApplicatorBase *applicator = gen->applicator();
     applicator->initializeData(&data);
 
     QVector<QRect> rects = KritaUtils::splitRectIntoPatches(dev->bounds(), QSize(63, 63));
@@ -86,12 +87,38 @@ void benchmarkSIMD(qreal fade) {
 
 void KisMaskGeneratorBenchmark::benchmarkSIMD_SharpBrush()
 {
-    benchmarkSIMD(1.0);
+    KisCircleMaskGenerator gen(1000, 1.0, 1.0, 1.0, 2, false);
+    benchmarkSIMD(&gen);
 }
 
 void KisMaskGeneratorBenchmark::benchmarkSIMD_FadedBrush()
 {
-    benchmarkSIMD(0.5);
+    KisCircleMaskGenerator gen(1000, 1.0, 0.5, 0.5, 2, false);
+    benchmarkSIMD(&gen);
+}
+
+void KisMaskGeneratorBenchmark::benchmarkSIMD_RectBrush()
+{
+    KisRectangleMaskGenerator gen(1000, 1.0, 0.5, 0.5, 2, false);
+    benchmarkSIMD(&gen);
+}
+
+void KisMaskGeneratorBenchmark::benchmarkSIMD_CurveCircleBrush()
+{
+    KisCubicCurve curve;
+    curve.fromString("0,1;0.25,0.8;0.75,0.2;1,0;");
+
+    KisCurveCircleMaskGenerator gen(1000, 1.0, 0.5, 0.5, 2, curve, false);
+    benchmarkSIMD(&gen);
+}
+
+void KisMaskGeneratorBenchmark::benchmarkSIMD_CurveRectBrush()
+{
+    KisCubicCurve curve;
+    curve.fromString("0,1;0.25,0.8;0.75,0.2;1,0;");
+
+    KisCurveRectangleMaskGenerator gen(1000, 1.0, 0.5, 0.5, 2, curve, false);
+    benchmarkSIMD(&gen);
 }
 
 void KisMaskGeneratorBenchmark::benchmarkSquare()
@@ -108,4 +135,55 @@ void KisMaskGeneratorBenchmark::benchmarkSquare()
     }
 }
 
+#include <KoColor.h>
+#include <kis_gbr_brush.h>
+#include <brushengine/kis_paint_information.h>
+
+/**
+ * Generates dabs of a predefined brush, which go through
+ * resampling of the brush pyramid levels
+ */
+void benchmarkImageBrush(qreal scale, qreal rotation, bool useSubPixel)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QImage image(300, 300, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            const int value = qBound(0, qAbs(x - 150) + qAbs(y - 150) + (x * y) % 37, 255);
+            image.setPixel(x, y, qRgb(value, value, value));
+        }
+    }
+
+    KisGbrBrush brush(image, "benchmark brush");
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+    KoColor color(Qt::black, cs);
+    KisPaintInformation info(QPointF(100.0, 100.0), 0.5);
+
+    // warm up the pyramid
+    brush.mask(dab, color, KisDabShape(scale, 1.0, rotation), info);
+
+    int i = 0;
+
+    QBENCHMARK {
+        const qreal subPixel = useSubPixel ? 0.1 * (i++ % 10) : 0.0;
+        brush.mask(dab, color, KisDabShape(scale, 1.0, rotation), info, subPixel, subPixel);
+    }
+}
+
+void KisMaskGeneratorBenchmark::benchmarkImageBrush_Scaled()
+{
+    benchmarkImageBrush(0.73, 0.0, false);
+}
+
+void KisMaskGeneratorBenchmark::benchmarkImageBrush_Rotated()
+{
+    benchmarkImageBrush(1.0, 0.7, false);
+}
+
+void KisMaskGeneratorBenchmark::benchmarkImageBrush_Subpixel()
+{
+    benchmarkImageBrush(1.0, 0.0, true);
+}
+
 QTEST_MAIN(KisMaskGeneratorBenchmark)
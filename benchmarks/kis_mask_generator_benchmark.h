@@ -28,8 +28,15 @@ private Q_SLOTS:
     void benchmarkCircle();
     void benchmarkSIMD_SharpBrush();
     void benchmarkSIMD_FadedBrush();
+    void benchmarkSIMD_RectBrush();
+    void benchmarkSIMD_CurveCircleBrush();
+    void benchmarkSIMD_CurveRectBrush();
     void benchmarkSquare();
 
+    void benchmarkImageBrush_Scaled();
+    void benchmarkImageBrush_Rotated();
+    void benchmarkImageBrush_Subpixel();
+
 };
 
 #endif
@@ -48,6 +48,10 @@ inline double drand48()
 #define GMP_IMAGE_HEIGHT 2067
 #include <kis_painter.h>
 #include <brushengine/kis_paintop_registry.h>
+#include <brushengine/kis_paintop.h>
+#include <kis_fixed_paint_device.h>
+#include <kis_gbr_brush.h>
+#include <kis_global.h>
 
 //#define SAVE_OUTPUT
 
@@ -327,6 +331,16 @@ void KisStrokeBenchmark::colorsmudgeRL()
     benchmarkStroke(presetFileName);
 }
 
+void KisStrokeBenchmark::imageBrush300px()
+{
+    benchmarkImageBrushLine(1.0, 0.0);
+}
+
+void KisStrokeBenchmark::imageBrushScaledRotated()
+{
+    benchmarkImageBrushLine(0.63, 0.9);
+}
+
 /*
 void KisStrokeBenchmark::predefinedBrush()
 {
@@ -359,6 +373,52 @@ void KisStrokeBenchmark::predefinedBrushRL()
 }
 */
 
+/**
+ * Paints a line of dabs of a predefined brush without going through
+ * the paintop, so no brush resources are needed for the benchmark
+ */
+inline void KisStrokeBenchmark::benchmarkImageBrushLine(qreal scale, qreal rotation)
+{
+    QImage image(300, 300, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            const int value = qBound(0, qAbs(x - 150) + qAbs(y - 150) + (x * y) % 37, 255);
+            image.setPixel(x, y, qRgb(value, value, value));
+        }
+    }
+
+    KisGbrBrush brush(image, "benchmark brush");
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(m_colorSpace);
+    KoColor color(Qt::black, m_colorSpace);
+    KisDabShape shape(scale, 1.0, rotation);
+
+    const QPointF startPoint(0.10 * TEST_IMAGE_WIDTH, 0.5 * TEST_IMAGE_HEIGHT);
+    const QPointF endPoint(0.90 * TEST_IMAGE_WIDTH, 0.5 * TEST_IMAGE_HEIGHT);
+    const qreal spacing = 0.1 * brush.width() * scale;
+    const int numDabs = qMax(1, int(kisDistance(startPoint, endPoint) / spacing));
+
+    QBENCHMARK{
+        for (int i = 0; i <= numDabs; i++) {
+            const QPointF pt = startPoint + (endPoint - startPoint) * qreal(i) / numDabs;
+            KisPaintInformation info(pt, 1.0);
+
+            qint32 x, y;
+            qreal subPixelX, subPixelY;
+            KisPaintOp::splitCoordinate(pt.x(), &x, &subPixelX);
+            KisPaintOp::splitCoordinate(pt.y(), &y, &subPixelY);
+
+            brush.mask(dab, color, shape, info, subPixelX, subPixelY);
+
+            const QRect rc = dab->bounds();
+            m_painter->bltFixed(QPoint(x - rc.width() / 2, y - rc.height() / 2), dab, rc);
+        }
+    }
+
+#ifdef SAVE_OUTPUT
+    m_layer->paintDevice()->convertToQImage(0).save(m_outputPath + "image_brush_line" + OUTPUT_FORMAT);
+#endif
+}
+
 inline void KisStrokeBenchmark::benchmarkLine(QString presetFileName)
 {
     KisPaintOpPresetSP preset = new KisPaintOpPreset(m_dataPath + presetFileName);
@@ -62,6 +62,7 @@ private:
         inline void benchmarkStroke(QString presetFileName);
         inline void benchmarkLine(QString presetFileName);
         inline void benchmarkCircle(QString presetFileName);
+        inline void benchmarkImageBrushLine(qreal scale, qreal rotation);
 
 private Q_SLOTS:
     void initTestCase();
@@ -120,6 +121,10 @@ private Q_SLOTS:
 
     void colorsmudge();
     void colorsmudgeRL();
+
+    // Predefined (image) brush dabs
+    void imageBrush300px();
+    void imageBrushScaledRotated();
 /*
     void predefinedBrush();
     void predefinedBrushRL();
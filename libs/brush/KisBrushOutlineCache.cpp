@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisBrushOutlineCache.h"
+
+#include <QMutexLocker>
+#include <QPainterPath>
+
+#include "kis_boundary.h"
+
+
+namespace {
+/**
+ * The cost of an outline is the number of the elements in its path,
+ * which is about 40 bytes per element together with the polygons
+ */
+const int maxCachedElements = 1 << 20;
+}
+
+Q_GLOBAL_STATIC(KisBrushOutlineCache, s_instance)
+
+KisBrushOutlineCache::KisBrushOutlineCache()
+{
+    m_cache.setMaxCost(maxCachedElements);
+}
+
+KisBrushOutlineCache::~KisBrushOutlineCache()
+{
+}
+
+KisBrushOutlineCache* KisBrushOutlineCache::instance()
+{
+    return s_instance;
+}
+
+QSharedPointer<const KisBoundary> KisBrushOutlineCache::fetchBoundary(const QString &key) const
+{
+    QMutexLocker l(&m_mutex);
+
+    CachedBoundary *boundary = m_cache.object(key);
+    return boundary ? *boundary : CachedBoundary();
+}
+
+void KisBrushOutlineCache::addBoundary(const QString &key, QSharedPointer<const KisBoundary> boundary)
+{
+    const int cost = qMax(1, boundary->path().elementCount());
+
+    QMutexLocker l(&m_mutex);
+    m_cache.insert(key, new CachedBoundary(boundary), cost);
+}
+
+void KisBrushOutlineCache::clear()
+{
+    QMutexLocker l(&m_mutex);
+    m_cache.clear();
+}
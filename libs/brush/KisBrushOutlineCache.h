@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISBRUSHOUTLINECACHE_H
+#define KISBRUSHOUTLINECACHE_H
+
+#include "kritabrush_export.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+
+class KisBoundary;
+
+
+/**
+ * A process-wide cache of the brush outlines. Tracing the outline of
+ * a big image brush is expensive, and the brush objects are recreated
+ * every time a preset is switched or its settings are changed. This
+ * cache keeps the traced outlines, so switching back to a recently
+ * used brush doesn't trace it again.
+ *
+ * The outlines are stored in brush coordinates. Rotation, scale and
+ * mirroring are applied to them later with a transform, so a single
+ * entry serves all of them.
+ */
+class BRUSH_EXPORT KisBrushOutlineCache
+{
+public:
+    KisBrushOutlineCache();
+    ~KisBrushOutlineCache();
+
+    static KisBrushOutlineCache* instance();
+
+    /**
+     * \return the cached boundary for \p key or a null pointer
+     */
+    QSharedPointer<const KisBoundary> fetchBoundary(const QString &key) const;
+
+    void addBoundary(const QString &key, QSharedPointer<const KisBoundary> boundary);
+
+    void clear();
+
+private:
+    typedef QSharedPointer<const KisBoundary> CachedBoundary;
+
+    mutable QMutex m_mutex;
+    mutable QCache<QString, CachedBoundary> m_cache;
+};
+
+#endif // KISBRUSHOUTLINECACHE_H
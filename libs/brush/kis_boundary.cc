@@ -20,13 +20,90 @@
 #include <QPainter>
 #include <QPen>
 
+#include <cmath>
+
 #include "KoColorSpace.h"
 #include "kis_fixed_paint_device.h"
 #include "kis_outline_generator.h"
 
+namespace {
+
+/**
+ * The traced outline is a staircase with a vertex in every corner
+ * of a pixel. Straightening the stairs with this tolerance is not
+ * visible, but makes the path many times shorter.
+ */
+const qreal simplificationTolerance = 0.5;
+
+qreal distanceToSegment(const QPointF &pt, const QPointF &p1, const QPointF &p2)
+{
+    const QPointF d = p2 - p1;
+    const qreal length = std::sqrt(d.x() * d.x() + d.y() * d.y());
+
+    if (length < 1e-6) {
+        const QPointF diff = pt - p1;
+        return std::sqrt(diff.x() * diff.x() + diff.y() * diff.y());
+    }
+
+    return std::abs(d.x() * (p1.y() - pt.y()) - d.y() * (p1.x() - pt.x())) / length;
+}
+
+/**
+ * Ramer-Douglas-Peucker simplification of a polygon. The stack
+ * of the ranges is explicit, because the polygons of big brushes
+ * may have tens of thousands of vertices.
+ */
+QPolygonF simplifyPolygon(const QPolygon &polygon, qreal tolerance)
+{
+    const int size = polygon.size();
+    if (size < 4) return QPolygonF(polygon);
+
+    QVector<bool> keep(size, false);
+    keep[0] = true;
+    keep[size - 1] = true;
+
+    QVector<QPair<int, int>> ranges;
+    ranges.append(qMakePair(0, size - 1));
+
+    while (!ranges.isEmpty()) {
+        const QPair<int, int> range = ranges.takeLast();
+
+        const QPointF p1 = polygon[range.first];
+        const QPointF p2 = polygon[range.second];
+
+        qreal maxDistance = 0.0;
+        int farthestIndex = -1;
+
+        for (int i = range.first + 1; i < range.second; i++) {
+            const qreal distance = distanceToSegment(polygon[i], p1, p2);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                farthestIndex = i;
+            }
+        }
+
+        if (farthestIndex >= 0 && maxDistance > tolerance) {
+            keep[farthestIndex] = true;
+            ranges.append(qMakePair(range.first, farthestIndex));
+            ranges.append(qMakePair(farthestIndex, range.second));
+        }
+    }
+
+    QPolygonF result;
+    for (int i = 0; i < size; i++) {
+        if (keep[i]) {
+            result << polygon[i];
+        }
+    }
+
+    return result;
+}
+
+}
+
 struct KisBoundary::Private {
     KisFixedPaintDeviceSP m_device;
-    QVector<QPolygon> m_boundary;
+    QVector<QPolygonF> m_boundary;
     QPainterPath path;
 };
 
@@ -47,14 +124,22 @@ void KisBoundary::generateBoundary()
 
     KisOutlineGenerator generator(d->m_device->colorSpace(), OPACITY_TRANSPARENT_U8);
     generator.setSimpleOutline(true);
-    d->m_boundary = generator.outline(d->m_device->data(), 0, 0, d->m_device->bounds().width(), d->m_device->bounds().height());
+    const QVector<QPolygon> outline = generator.outline(d->m_device->data(), 0, 0, d->m_device->bounds().width(), d->m_device->bounds().height());
+
+    d->m_boundary.clear();
+    Q_FOREACH (const QPolygon & polygon, outline) {
+        d->m_boundary.append(simplifyPolygon(polygon, simplificationTolerance));
+    }
 
     d->path = QPainterPath();
-    Q_FOREACH (const QPolygon & polygon, d->m_boundary) {
+    Q_FOREACH (const QPolygonF & polygon, d->m_boundary) {
         d->path.addPolygon(polygon);
         d->path.closeSubpath();
     }
 
+    // the boundary may live in KisBrushOutlineCache for a long time,
+    // so don't keep the device
+    d->m_device = 0;
 }
 
 void KisBoundary::paint(QPainter& painter) const
@@ -64,7 +149,7 @@ void KisBoundary::paint(QPainter& painter) const
     pen.setBrush(Qt::black);
     painter.setPen(pen);
 
-    Q_FOREACH (const QPolygon & polygon, d->m_boundary) {
+    Q_FOREACH (const QPolygonF & polygon, d->m_boundary) {
         painter.drawPolygon(polygon);
     }
 }
@@ -23,11 +23,13 @@
 
 #include "kis_brush.h"
 
+#include <QDomDocument>
 #include <QDomElement>
 #include <QFile>
 #include <QPoint>
 #include <QFileInfo>
 #include <QBuffer>
+#include <QCryptographicHash>
 
 #include <kis_debug.h>
 #include <klocalizedstring.h>
@@ -40,6 +42,7 @@
 #include "kis_paint_device.h"
 #include "kis_global.h"
 #include "kis_boundary.h"
+#include "KisBrushOutlineCache.h"
 #include "kis_image.h"
 #include "kis_iterator_ng.h"
 #include "kis_brush_registry.h"
@@ -102,8 +105,7 @@ void KisBrush::PaintDeviceColoringInformation::nextRow()
 
 struct KisBrush::Private {
     Private()
-        : boundary(0)
-        , angle(0)
+        : angle(0)
         , scale(1.0)
         , hasColor(false)
         , brushType(INVALID)
@@ -113,10 +115,9 @@ struct KisBrush::Private {
     {}
 
     ~Private() {
-        delete boundary;
     }
 
-    mutable KisBoundary* boundary;
+    mutable QSharedPointer<const KisBoundary> boundary;
     qreal angle;
     qreal scale;
     bool hasColor;
@@ -130,6 +131,7 @@ struct KisBrush::Private {
     mutable QSharedPointer<KisSharedQImagePyramid> brushPyramid;
 
     QImage brushTipImage;
+    QByteArray brushTipImageHash;
 
     bool autoSpacingActive;
     qreal autoSpacingCoeff;
@@ -175,7 +177,8 @@ KisBrush::KisBrush(const KisBrush& rhs)
      */
     d->brushPyramid = rhs.d->brushPyramid;
 
-    // don't copy the boundary, it will be regenerated -- see bug 291910
+    // don't copy the boundary, it will be regenerated -- see bug 291910.
+    // The copy will most probably find it in KisBrushOutlineCache.
 }
 
 KisBrush::~KisBrush()
@@ -307,6 +310,9 @@ bool KisBrush::canPaintFor(const KisPaintInformation& /*info*/)
 void KisBrush::setBrushTipImage(const QImage& image)
 {
     d->brushTipImage = image;
+    d->brushTipImageHash = image.isNull() ? QByteArray() :
+        QCryptographicHash::hash(QByteArray::fromRawData(reinterpret_cast<const char*>(image.constBits()), image.byteCount()),
+                                 QCryptographicHash::Md5);
 
     if (!image.isNull()) {
         if (image.width() > 128 || image.height() > 128) {
@@ -580,12 +586,42 @@ KisFixedPaintDeviceSP KisBrush::paintDevice(const KoColorSpace * colorSpace,
 
 void KisBrush::resetBoundary()
 {
-    delete d->boundary;
-    d->boundary = 0;
+    d->boundary.clear();
+}
+
+QString KisBrush::contentCacheKey() const
+{
+    QDomDocument document;
+    QDomElement element = document.createElement("Brush");
+    toXML(document, element);
+    document.appendChild(element);
+
+    /**
+     * The XML describes procedural brushes completely. The image brushes
+     * store only their file name there, and all the custom and clipboard
+     * brushes share the same one, so they are distinguished by the
+     * pixels of their tip image and the md5 of their contents.
+     *
+     * NOTE: the XML may contain '%' characters itself, so all the
+     *       fields are substituted in a single pass
+     */
+    return QString("%1|%2|%3|%4|%5|%6x%7")
+        .arg(document.toString(-1),
+             QString::fromLatin1(md5().toHex()),
+             QString::fromLatin1(d->brushTipImageHash.toHex()),
+             QString::number(int(brushType())),
+             QString::number(int(hasColor())),
+             QString::number(width()),
+             QString::number(height()));
 }
 
 void KisBrush::generateBoundary() const
 {
+    const QString cacheKey = contentCacheKey();
+
+    d->boundary = KisBrushOutlineCache::instance()->fetchBoundary(cacheKey);
+    if (d->boundary) return;
+
     KisFixedPaintDeviceSP dev;
     KisDabShape inverseTransform(1.0 / scale(), 1.0, -angle());
 
@@ -599,15 +635,18 @@ void KisBrush::generateBoundary() const
         mask(dev, KoColor(Qt::black, cs), inverseTransform, KisPaintInformation());
     }
 
-    d->boundary = new KisBoundary(dev);
-    d->boundary->generateBoundary();
+    KisBoundary *boundary = new KisBoundary(dev);
+    boundary->generateBoundary();
+    d->boundary = QSharedPointer<const KisBoundary>(boundary);
+
+    KisBrushOutlineCache::instance()->addBoundary(cacheKey, d->boundary);
 }
 
 const KisBoundary* KisBrush::boundary() const
 {
     if (!d->boundary)
         generateBoundary();
-    return d->boundary;
+    return d->boundary.data();
 }
 
 void KisBrush::setScale(qreal _scale)
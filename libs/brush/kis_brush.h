@@ -376,6 +376,14 @@ public:
      */
     bool isPiercedApprox() const;
 
+    /**
+     * A key that identifies the masks this brush generates. It is used
+     * by the caches shared between brush instances, like
+     * KisBrushOutlineCache and the shared dab cache of the paintops.
+     * Two brushes with equal keys generate equal dabs.
+     */
+    QString contentCacheKey() const;
+
 protected:
 
     void resetBoundary();
@@ -20,14 +20,29 @@
 
 #include <limits>
 #include <QPainter>
+#include <QScopedPointer>
 #include <kis_debug.h>
 
+#include "kis_qimage_pyramid_resampler.h"
+
 #define MIPMAP_SIZE_THRESHOLD 512
 #define MAX_MIPMAP_SCALE 8.0
 
 #define QPAINTER_WORKAROUND_BORDER 1
 
 
+namespace {
+
+const KisQImagePyramidResamplerBase* resampler()
+{
+    static const QScopedPointer<KisQImagePyramidResamplerBase> s_resampler(
+        createOptimizedClass<KisQImagePyramidResamplerFactory>(0));
+
+    return s_resampler.data();
+}
+
+}
+
 KisQImagePyramid::KisQImagePyramid(const QImage &baseImage)
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN(!baseImage.isNull());
@@ -290,6 +305,22 @@ QImage KisQImagePyramid::createImage(KisDabShape const& shape,
     }
 
     QImage dstImage(dstSize, QImage::Format_ARGB32);
+
+    /**
+     * The dab transformations are always affine, so we can sample the
+     * pyramid level directly, without going through QPainter. The
+     * transparent border of the level works for the resampler as well.
+     */
+    if (transform.isAffine() &&
+            srcImage.format() == QImage::Format_ARGB32) {
+
+        resampler()->resample(srcImage,
+                              QTransform::fromTranslate(-QPAINTER_WORKAROUND_BORDER,
+                                                        -QPAINTER_WORKAROUND_BORDER) * transform,
+                              &dstImage);
+        return dstImage;
+    }
+
     dstImage.fill(0);
 
 
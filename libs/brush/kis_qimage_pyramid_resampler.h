@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_QIMAGE_PYRAMID_RESAMPLER_H
+#define __KIS_QIMAGE_PYRAMID_RESAMPLER_H
+
+#include <compositeops/KoVcMultiArchBuildSupport.h>
+
+class QImage;
+class QTransform;
+
+
+/**
+ * Transforms a level of KisQImagePyramid into a dab with bilinear
+ * interpolation. It replaces QPainter's SmoothPixmapTransform, which
+ * is rather slow for the images created on every dab.
+ *
+ * The interpolation is done on premultiplied values, the pixels
+ * outside the source image are considered to be transparent.
+ */
+class KisQImagePyramidResamplerBase
+{
+public:
+    virtual ~KisQImagePyramidResamplerBase() {}
+
+    /**
+     * Fills \p dstImage with \p srcImage transformed by an affine
+     * \p transform. Both images should be in QImage::Format_ARGB32.
+     */
+    virtual void resample(const QImage &srcImage, const QTransform &transform, QImage *dstImage) const = 0;
+};
+
+struct KisQImagePyramidResamplerFactory
+{
+    typedef int ParamType; // unused
+    typedef KisQImagePyramidResamplerBase* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType);
+};
+
+#endif /* __KIS_QIMAGE_PYRAMID_RESAMPLER_H */
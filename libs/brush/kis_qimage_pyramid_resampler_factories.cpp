@@ -0,0 +1,274 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_qimage_pyramid_resampler.h"
+
+#include <cmath>
+
+#include <QImage>
+#include <QTransform>
+#include <QtGlobal>
+
+
+namespace {
+
+/**
+ * Pixels with the interpolated alpha less than that are rounded
+ * to the fully transparent ones
+ */
+const float minimalAlpha = 0.5f;
+
+template<Vc::Implementation V> struct TypeHelper {};
+
+struct SourceImage
+{
+    SourceImage(const QImage &image)
+        : data(reinterpret_cast<const quint32*>(image.constBits())),
+          stride(image.bytesPerLine() / 4),
+          width(image.width()),
+          height(image.height())
+    {
+    }
+
+    inline quint32 pixelAt(int x, int y) const {
+        return uint(x) < uint(width) && uint(y) < uint(height) ?
+            data[y * stride + x] : 0;
+    }
+
+    const quint32 *data;
+    const int stride;
+    const int width;
+    const int height;
+};
+
+template<Vc::Implementation _impl>
+class KisQImagePyramidResampler : public KisQImagePyramidResamplerBase
+{
+public:
+    void resample(const QImage &srcImage, const QTransform &transform, QImage *dstImage) const override {
+        bool isInvertible = false;
+        const QTransform invertedTransform = transform.inverted(&isInvertible);
+
+        if (!isInvertible) {
+            dstImage->fill(0);
+            return;
+        }
+
+        const SourceImage src(srcImage);
+        const int width = dstImage->width();
+
+        for (int y = 0; y < dstImage->height(); y++) {
+            quint32 *dstRow = reinterpret_cast<quint32*>(dstImage->scanLine(y));
+
+            /**
+             * Every pixel is sampled at its center, and the coordinates
+             * are shifted by half a pixel to get the position of the
+             * top-left pixel of the bilinear interpolation
+             */
+            const QPointF rowStart = invertedTransform.map(QPointF(0.5, y + 0.5)) - QPointF(0.5, 0.5);
+
+            processRow(src, dstRow, width,
+                       rowStart.x(), rowStart.y(),
+                       invertedTransform.m11(), invertedTransform.m12(),
+                       TypeHelper<_impl>());
+        }
+    }
+
+private:
+    static inline void processRow(const SourceImage &src, quint32 *dst, int width,
+                                  float x, float y, float dxdx, float dydx,
+                                  TypeHelper<Vc::ScalarImpl>) {
+
+        for (int i = 0; i < width; i++) {
+            const float srcX = x + i * dxdx;
+            const float srcY = y + i * dydx;
+
+            const float x0 = std::floor(srcX);
+            const float y0 = std::floor(srcY);
+            const float fx = srcX - x0;
+            const float fy = srcY - y0;
+
+            const quint32 pixels[4] = {
+                src.pixelAt(int(x0), int(y0)),
+                src.pixelAt(int(x0) + 1, int(y0)),
+                src.pixelAt(int(x0), int(y0) + 1),
+                src.pixelAt(int(x0) + 1, int(y0) + 1)
+            };
+
+            const float weights[4] = {
+                (1.0f - fx) * (1.0f - fy),
+                fx * (1.0f - fy),
+                (1.0f - fx) * fy,
+                fx * fy
+            };
+
+            float alpha = 0.0f;
+            float red = 0.0f;
+            float green = 0.0f;
+            float blue = 0.0f;
+
+            for (int k = 0; k < 4; k++) {
+                const float weightedAlpha = weights[k] * qAlpha(pixels[k]);
+                alpha += weightedAlpha;
+                red += weightedAlpha * qRed(pixels[k]);
+                green += weightedAlpha * qGreen(pixels[k]);
+                blue += weightedAlpha * qBlue(pixels[k]);
+            }
+
+            if (alpha < minimalAlpha) {
+                dst[i] = 0;
+                continue;
+            }
+
+            const float norm = 1.0f / alpha;
+
+            dst[i] = qRgba(qMin(255, int(red * norm + 0.5f)),
+                           qMin(255, int(green * norm + 0.5f)),
+                           qMin(255, int(blue * norm + 0.5f)),
+                           qMin(255, int(alpha + 0.5f)));
+        }
+    }
+
+#if defined HAVE_VC
+
+    template<Vc::Implementation V>
+    static inline void processRow(const SourceImage &src, quint32 *dst, int width,
+                                  float x, float y, float dxdx, float dydx,
+                                  TypeHelper<V>) {
+
+        typedef Vc::float_v float_v;
+        typedef Vc::float_m float_m;
+        typedef Vc::SimdArray<int, float_v::size()> int_v;
+
+        const int vectorSize = float_v::size();
+
+        /**
+         * The coordinates and the weights are calculated with vectors,
+         * then the four neighbours of every lane are fetched in scalar
+         * mode and unpacked into premultiplied channels again with
+         * vectors.
+         */
+        float srcX[vectorSize];
+        float srcY[vectorSize];
+        int pixels[4][vectorSize];
+        float channels[4][vectorSize];
+
+        const float_v one(Vc::One);
+        const float_v zero(Vc::Zero);
+        const float_v half(0.5f);
+        const float_v maxValue(255.0f);
+        const int_v channelMask(0xff);
+
+        const float_v vDxDx(dxdx);
+        const float_v vDyDx(dydx);
+        const float_v vX(x);
+        const float_v vY(y);
+
+        float_v indexes = float_v::IndexesFromZero();
+        const float_v increment((float)vectorSize);
+
+        for (int i = 0; i < width; i += vectorSize) {
+            const float_v sampleX = vX + indexes * vDxDx;
+            const float_v sampleY = vY + indexes * vDyDx;
+            indexes += increment;
+
+            const float_v x0 = Vc::floor(sampleX);
+            const float_v y0 = Vc::floor(sampleY);
+            const float_v fx = sampleX - x0;
+            const float_v fy = sampleY - y0;
+
+            x0.store(srcX, Vc::Unaligned);
+            y0.store(srcY, Vc::Unaligned);
+
+            for (int lane = 0; lane < vectorSize; lane++) {
+                const int px = int(srcX[lane]);
+                const int py = int(srcY[lane]);
+
+                pixels[0][lane] = src.pixelAt(px, py);
+                pixels[1][lane] = src.pixelAt(px + 1, py);
+                pixels[2][lane] = src.pixelAt(px, py + 1);
+                pixels[3][lane] = src.pixelAt(px + 1, py + 1);
+            }
+
+            const float_v weights[4] = {
+                (one - fx) * (one - fy),
+                fx * (one - fy),
+                (one - fx) * fy,
+                fx * fy
+            };
+
+            float_v alpha(Vc::Zero);
+            float_v red(Vc::Zero);
+            float_v green(Vc::Zero);
+            float_v blue(Vc::Zero);
+
+            for (int k = 0; k < 4; k++) {
+                const int_v pixel(pixels[k], Vc::Unaligned);
+
+                const float_v weightedAlpha =
+                    weights[k] * Vc::simd_cast<float_v>((pixel >> 24) & channelMask);
+
+                alpha += weightedAlpha;
+                red += weightedAlpha * Vc::simd_cast<float_v>((pixel >> 16) & channelMask);
+                green += weightedAlpha * Vc::simd_cast<float_v>((pixel >> 8) & channelMask);
+                blue += weightedAlpha * Vc::simd_cast<float_v>(pixel & channelMask);
+            }
+
+            const float_m transparentMask = alpha < float_v(minimalAlpha);
+
+            float_v safeAlpha = alpha;
+            safeAlpha(transparentMask) = one;
+            const float_v norm = one / safeAlpha;
+
+            red = Vc::min(red * norm + half, maxValue);
+            green = Vc::min(green * norm + half, maxValue);
+            blue = Vc::min(blue * norm + half, maxValue);
+            alpha = Vc::min(alpha + half, maxValue);
+
+            red(transparentMask) = zero;
+            green(transparentMask) = zero;
+            blue(transparentMask) = zero;
+            alpha(transparentMask) = zero;
+
+            red.store(channels[0], Vc::Unaligned);
+            green.store(channels[1], Vc::Unaligned);
+            blue.store(channels[2], Vc::Unaligned);
+            alpha.store(channels[3], Vc::Unaligned);
+
+            const int pixelsInBlock = qMin(vectorSize, width - i);
+
+            for (int lane = 0; lane < pixelsInBlock; lane++) {
+                dst[i + lane] = qRgba(int(channels[0][lane]),
+                                      int(channels[1][lane]),
+                                      int(channels[2][lane]),
+                                      int(channels[3][lane]));
+            }
+        }
+    }
+
+#endif /* defined HAVE_VC */
+};
+
+}
+
+template<>
+KisQImagePyramidResamplerFactory::ReturnType
+KisQImagePyramidResamplerFactory::create<Vc::CurrentImplementation::current()>(ParamType)
+{
+    return new KisQImagePyramidResampler<Vc::CurrentImplementation::current()>();
+}
@@ -193,4 +193,25 @@ void KisAutoBrushTest::testClone()
     QCOMPARE(res1, res2);
 }
 
+void KisAutoBrushTest::testOutlineCache()
+{
+    KisCircleMaskGenerator* circle = new KisCircleMaskGenerator(300, 1.0, 1.0, 1.0, 2, true);
+    KisBrushSP brush = new KisAutoBrush(circle, 0.0, 0.0);
+
+    const QPainterPath outline = brush->outline();
+    QVERIFY(!outline.isEmpty());
+
+    // the staircase of the traced circle should be straightened
+    QVERIFY(outline.elementCount() < 300);
+
+    // the clone doesn't copy the boundary, but finds it in the cache
+    KisBrushSP clone = brush->clone();
+    QCOMPARE(clone->boundary(), brush->boundary());
+
+    KisCircleMaskGenerator* otherCircle = new KisCircleMaskGenerator(200, 1.0, 1.0, 1.0, 2, true);
+    KisBrushSP otherBrush = new KisAutoBrush(otherCircle, 0.0, 0.0);
+    QVERIFY(otherBrush->boundary() != brush->boundary());
+    QVERIFY(otherBrush->outline().boundingRect().width() < outline.boundingRect().width());
+}
+
 QTEST_MAIN(KisAutoBrushTest)
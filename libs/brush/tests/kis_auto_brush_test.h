@@ -31,6 +31,7 @@ private Q_SLOTS:
     void testDabSize();
     void testCopyMasking();
     void testClone();
+    void testOutlineCache();
 
 };
 
@@ -31,6 +31,8 @@
 #include "brushengine/kis_paint_information.h"
 #include <kis_fixed_paint_device.h>
 #include "kis_qimage_pyramid.h"
+#include <kis_global.h>
+#include <QPainter>
 
 
 void KisGbrBrushTest::testMaskGenerationSingleColor()
@@ -251,6 +253,64 @@ void KisGbrBrushTest::testPyramidDabTransform()
     QCOMPARE(dabTransformHelper(KisDabShape(1.0, 0.5, M_PI / 4)), QSize(160, 160));
 }
 
+void KisGbrBrushTest::testPyramidResampling()
+{
+    // a cone of alpha with a constant color, like a colored brush mask
+    QImage image(256, 256, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            const qreal dist = std::sqrt(pow2(x - 127.5) + pow2(y - 127.5)) / 128.0;
+            image.setPixel(x, y, qRgba(200, 100, 50, qBound(0, qRound(255 * (1.0 - dist)), 255)));
+        }
+    }
+
+    KisQImagePyramid pyramid(image);
+
+    QVector<KisDabShape> shapes;
+    shapes << KisDabShape(1.0, 1.0, 0.3);
+    shapes << KisDabShape(0.37, 1.0, 0.0);
+    shapes << KisDabShape(0.7, 0.5, 1.2);
+    shapes << KisDabShape(1.6, 1.0, 2.5);
+
+    Q_FOREACH (const KisDabShape &shape, shapes) {
+        const qreal subPixelX = 0.3;
+        const qreal subPixelY = 0.7;
+
+        QImage result = pyramid.createImage(shape, subPixelX, subPixelY);
+
+        // the reference is rendered the way QPainter does it
+        qreal baseScale = -1.0;
+        const int level = pyramid.findNearestLevel(shape.scale(), &baseScale);
+
+        QTransform transform;
+        QSize dstSize;
+        KisQImagePyramid::calculateParams(shape, subPixelX, subPixelY,
+                                          pyramid.m_originalSize, baseScale,
+                                          pyramid.m_levels[level].size,
+                                          &transform, &dstSize);
+
+        QImage reference(dstSize, QImage::Format_ARGB32);
+        reference.fill(0);
+
+        QPainter gc(&reference);
+        gc.setTransform(QTransform::fromTranslate(-1, -1) * transform);
+        gc.setRenderHints(QPainter::SmoothPixmapTransform);
+        gc.drawImage(QPointF(), pyramid.m_levels[level].image);
+        gc.end();
+
+        /**
+         * QPainter uses less precise weights for the interpolation,
+         * and loses the color precision of the semi-transparent pixels,
+         * so compare premultiplied values with some tolerance
+         */
+        QPoint pt;
+        QVERIFY(TestUtil::compareQImages(pt,
+                                         result.convertToFormat(QImage::Format_ARGB32_Premultiplied),
+                                         reference.convertToFormat(QImage::Format_ARGB32_Premultiplied),
+                                         3, 3));
+    }
+}
+
 // see comment in KisQImagePyramid::appendPyramidLevel
 void KisGbrBrushTest::testQPainterTransformationBorder()
 {
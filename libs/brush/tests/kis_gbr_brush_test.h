@@ -40,6 +40,7 @@ private Q_SLOTS:
 
     void testPyramidLevelRounding();
     void testPyramidDabTransform();
+    void testPyramidResampling();
 
     void testQPainterTransformationBorder();
 };
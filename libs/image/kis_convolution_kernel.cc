@@ -83,6 +83,52 @@ const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>* KisConvolutionKernel
     return &(d->data);
 }
 
+bool KisConvolutionKernel::separate(Eigen::Matrix<qreal, Eigen::Dynamic, 1> *horizontal,
+                                    Eigen::Matrix<qreal, Eigen::Dynamic, 1> *vertical) const
+{
+    const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> &m = d->data;
+    if (!m.size()) return false;
+
+    /**
+     * A matrix of rank 1 is fully defined by any of its non-zero
+     * rows and columns. We take the ones crossing the largest element
+     * to keep the numerical error as low as possible.
+     */
+    Eigen::Index pivotRow = 0;
+    Eigen::Index pivotColumn = 0;
+    const qreal maxValue = m.cwiseAbs().maxCoeff(&pivotRow, &pivotColumn);
+
+    if (maxValue == 0.0) return false;
+
+    const Eigen::Matrix<qreal, Eigen::Dynamic, 1> h = m.row(pivotRow).transpose();
+    const Eigen::Matrix<qreal, Eigen::Dynamic, 1> v = m.col(pivotColumn) / m(pivotRow, pivotColumn);
+
+    const qreal tolerance = 1e-9 * maxValue;
+
+    for (int r = 0; r < m.rows(); r++) {
+        for (int c = 0; c < m.cols(); c++) {
+            if (qAbs(m(r, c) - v(r) * h(c)) > tolerance) {
+                return false;
+            }
+        }
+    }
+
+    if (horizontal) {
+        *horizontal = h;
+    }
+
+    if (vertical) {
+        *vertical = v;
+    }
+
+    return true;
+}
+
+bool KisConvolutionKernel::isSeparable() const
+{
+    return separate();
+}
+
 KisConvolutionKernelSP KisConvolutionKernel::fromQImage(const QImage& image)
 {
     KisConvolutionKernelSP kernel = new KisConvolutionKernel(image.width(), image.height(), 0, 0);
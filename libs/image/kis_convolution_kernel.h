@@ -47,6 +47,22 @@ public:
     Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>& data();
     const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> * data() const;
 
+    /**
+     * Checks whether the kernel can be represented as an outer product
+     * of a vertical and a horizontal vector:
+     *
+     * kernel(r, c) = vertical(r) * horizontal(c)
+     *
+     * Such kernels (e.g. Gaussian or box ones) can be applied in two
+     * 1D passes, which is much faster than the full 2D convolution.
+     * If the kernel is separable and the pointers are not null, the
+     * vectors are written into them.
+     */
+    bool separate(Eigen::Matrix<qreal, Eigen::Dynamic, 1> *horizontal = 0,
+                  Eigen::Matrix<qreal, Eigen::Dynamic, 1> *vertical = 0) const;
+
+    bool isSeparable() const;
+
     static KisConvolutionKernelSP fromQImage(const QImage& image);
     static KisConvolutionKernelSP fromMaskGenerator(KisMaskGenerator *, qreal angle = 0.0);
     static KisConvolutionKernelSP fromMatrix(Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix, qreal offset, qreal factor);
@@ -50,6 +50,7 @@
 
 #include "kis_convolution_worker.h"
 #include "kis_convolution_worker_spatial.h"
+#include "kis_convolution_worker_separable.h"
 
 #include "config_convolution.h"
 
@@ -58,18 +59,36 @@
 #endif
 
 
+bool KisConvolutionPainter::useSeparableImplementation(const KisConvolutionKernelSP kernel) const
+{
+    return device() &&
+        (m_enginePreference == NONE || m_enginePreference == SEPARABLE) &&
+        KisConvolutionWorkerSeparable<StandardIteratorFactory>::isApplicable(kernel, this, device()->colorSpace());
+}
+
 bool KisConvolutionPainter::useFFTImplemenation(const KisConvolutionKernelSP kernel) const
 {
     bool result = false;
 
 #ifdef HAVE_FFTW3
-    #define THRESHOLD_SIZE 5
+    /**
+     * The FFT worker pays for the transforms of the whole padded
+     * area, while the spatial one grows with the kernel area. The
+     * crossover is around radius 10, see
+     * KisBlurBenchmark::benchmarkConvolutionCrossover()
+     */
+    #define THRESHOLD_SIZE 20
 
+    /**
+     * Separable kernels are faster to apply in two 1D passes,
+     * so FFT is used for them only when explicitly requested.
+     */
     result =
         m_enginePreference == FFTW ||
         (m_enginePreference == NONE &&
          kernel->width() > THRESHOLD_SIZE &&
-         kernel->height() > THRESHOLD_SIZE);
+         kernel->height() > THRESHOLD_SIZE &&
+         !useSeparableImplementation(kernel));
 #else
     Q_UNUSED(kernel);
 #endif
@@ -87,12 +106,17 @@ KisConvolutionWorker<factory>* KisConvolutionPainter::createWorker(const KisConv
 #ifdef HAVE_FFTW3
     if (useFFTImplemenation(kernel)) {
         worker = new KisConvolutionWorkerFFT<factory>(painter, progress);
+    } else if (useSeparableImplementation(kernel)) {
+        worker = new KisConvolutionWorkerSeparable<factory>(painter, progress);
     } else {
         worker = new KisConvolutionWorkerSpatial<factory>(painter, progress);
     }
 #else
-    Q_UNUSED(kernel);
-    worker = new KisConvolutionWorkerSpatial<factory>(painter, progress);
+    if (useSeparableImplementation(kernel)) {
+        worker = new KisConvolutionWorkerSeparable<factory>(painter, progress);
+    } else {
+        worker = new KisConvolutionWorkerSpatial<factory>(painter, progress);
+    }
 #endif
 
     return worker;
@@ -76,10 +76,12 @@ public:
 
 protected:
     friend class KisConvolutionPainterTest;
+    friend class KisBlurBenchmark;
     enum TestingEnginePreference {
         NONE,
         SPATIAL,
-        FFTW
+        FFTW,
+        SEPARABLE
     };
 
 
@@ -93,6 +95,7 @@ private:
                                                     KoUpdater *progress);
 
      bool useFFTImplemenation(const KisConvolutionKernelSP kernel) const;
+     bool useSeparableImplementation(const KisConvolutionKernelSP kernel) const;
 
 private:
     TestingEnginePreference m_enginePreference;
@@ -26,12 +26,19 @@
 
 #include "kis_convolution_worker.h"
 #include "kis_math_toolbox.h"
+#include "kis_paint_device.h"
 
 #include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QList>
+#include <QPair>
+#include <QSize>
 #include <QVector>
 #include <QTextStream>
 #include <QFile>
 #include <QDir>
+#include <QtConcurrentMap>
 
 #include <fftw3.h>
 
@@ -41,11 +48,83 @@ class KisConvolutionWorkerFFTLock
 private:
     static QMutex fftwMutex;
     template<class _IteratorFactory_> friend class KisConvolutionWorkerFFT;
+    friend class KisConvolutionWorkerFFTPlanCache;
 };
 
 QMutex KisConvolutionWorkerFFTLock::fftwMutex;
 
 
+/**
+ * Creating of an FFTW plan is expensive and not thread-safe, so the
+ * plans are created once per transform size and cached.
+ *
+ * The plans are created for in-place transforms over an array
+ * allocated with fftw_malloc(). FFTW allows executing such a plan
+ * over any other array with the same size, layout and alignment
+ * (fftw_execute_dft_r2c/c2r), and the execution itself is thread-safe,
+ * so the same plan is shared by all the channels and all the workers.
+ */
+class KisConvolutionWorkerFFTPlanCache
+{
+public:
+    struct Plans {
+        Plans(int width, int height)
+        {
+            const int length = height * (width / 2 + 1);
+            fftw_complex *buffer = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * length);
+
+            // FFTW_ESTIMATE doesn't touch the contents of the buffer
+            forward = fftw_plan_dft_r2c_2d(height, width, (double*)buffer, buffer, FFTW_ESTIMATE);
+            backward = fftw_plan_dft_c2r_2d(height, width, buffer, (double*)buffer, FFTW_ESTIMATE);
+
+            fftw_free(buffer);
+        }
+
+        ~Plans() {
+            QMutexLocker l(&KisConvolutionWorkerFFTLock::fftwMutex);
+            fftw_destroy_plan(forward);
+            fftw_destroy_plan(backward);
+        }
+
+        fftw_plan forward;
+        fftw_plan backward;
+    };
+
+    typedef QSharedPointer<Plans> PlansSP;
+
+    static PlansSP plans(int width, int height) {
+        // should be destroyed after the mutex is unlocked
+        PlansSP evictedPlans;
+
+        QMutexLocker l(&KisConvolutionWorkerFFTLock::fftwMutex);
+
+        const QSize size(width, height);
+
+        for (int i = 0; i < s_cache.size(); i++) {
+            if (s_cache[i].first == size) {
+                s_cache.move(i, 0);
+                return s_cache.first().second;
+            }
+        }
+
+        PlansSP plans(new Plans(width, height));
+        s_cache.prepend(qMakePair(size, plans));
+
+        if (s_cache.size() > maxCachedPlans) {
+            evictedPlans = s_cache.takeLast().second;
+        }
+
+        return plans;
+    }
+
+private:
+    static const int maxCachedPlans = 16;
+    static QList<QPair<QSize, PlansSP>> s_cache;
+};
+
+QList<QPair<QSize, KisConvolutionWorkerFFTPlanCache::PlansSP>> KisConvolutionWorkerFFTPlanCache::s_cache;
+
+
 template<class _IteratorFactory_>
 class KisConvolutionWorkerFFT : public KisConvolutionWorker<_IteratorFactory_>
 {
@@ -82,8 +161,17 @@ public:
         const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
         const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
 
-        m_fftWidth = areaSize.width() + 4 * halfKernelWidth;
-        m_fftHeight = areaSize.height() + 2 * halfKernelHeight;
+        /**
+         * Huge areas are processed tile by tile to keep the memory
+         * consumption bounded. Every tile reads its own margins from
+         * the source device, so the result doesn't depend on the tiling.
+         */
+        const QSize tileSize(
+            calculateTileSize(areaSize.width(), 4 * halfKernelWidth),
+            calculateTileSize(areaSize.height(), 2 * halfKernelHeight));
+
+        m_fftWidth = tileSize.width() + 4 * halfKernelWidth;
+        m_fftHeight = tileSize.height() + 2 * halfKernelHeight;
 
         /**
          * FIXME: check whether this "optimization" is needed to
@@ -95,10 +183,14 @@ public:
         m_fftLength = m_fftHeight * (m_fftWidth / 2 + 1);
         m_extraMem = (m_fftWidth % 2) ? 1 : 2;
 
+        KisConvolutionWorkerFFTPlanCache::PlansSP plans =
+            KisConvolutionWorkerFFTPlanCache::plans(m_fftWidth, m_fftHeight);
+
         // create and fill kernel
         m_kernelFFT = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
         memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
         fftFillKernelMatrix(kernel, m_kernelFFT);
+        fftw_execute_dft_r2c(plans->forward, (double*)m_kernelFFT, m_kernelFFT);
 
         // find out which channels need convolving
         QList<KoChannelInfo*> convChannelList = this->convolvableChannelList(src);
@@ -114,56 +206,58 @@ public:
         FFTInfo info (fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
         int cacheRowStride = m_fftWidth + m_extraMem;
 
-        fillCacheFromDevice(src,
-                            QRect(srcPos.x() - halfKernelWidth,
-                                  srcPos.y() - halfKernelHeight,
-                                  m_fftWidth,
-                                  m_fftHeight),
-                            cacheRowStride,
-                            info, dataRect);
+        const QRect areaRect(srcPos, areaSize);
+        const QPoint dstOffset = dstPos - srcPos;
 
-        addToProgress(10);
-        if (isInterrupted()) return;
+        const int numTiles =
+            ((areaSize.width() + tileSize.width() - 1) / tileSize.width()) *
+            ((areaSize.height() + tileSize.height() - 1) / tileSize.height());
+        const float progressPerTile = 100.0 / numTiles;
 
-        // calculate number off fft operations required for progress reporting
-        const float progressPerFFT = (100 - 30) / (double)(convChannelList.count() * 2 + 1);
+        /**
+         * When the device is filtered in-place, the tiles would read
+         * the margins already overwritten by their neighbours. Copying
+         * of the device is cheap, because the tiles data is shared in
+         * copy-on-write manner.
+         */
+        KisPaintDeviceSP readDevice = src;
+        if (numTiles > 1 && src == this->m_painter->device()) {
+            readDevice = new KisPaintDevice(*src);
+        }
 
-        // perform FFT
-        fftw_plan fftwPlanForward, fftwPlanBackward;
+        for (int y = areaRect.y(); y <= areaRect.bottom(); y += tileSize.height()) {
+            for (int x = areaRect.x(); x <= areaRect.right(); x += tileSize.width()) {
+                const QRect tileRect = QRect(QPoint(x, y), tileSize) & areaRect;
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftwPlanForward = fftw_plan_dft_r2c_2d(m_fftHeight, m_fftWidth, (double*)m_kernelFFT, m_kernelFFT, FFTW_ESTIMATE);
-        fftwPlanBackward = fftw_plan_dft_c2r_2d(m_fftHeight, m_fftWidth, m_kernelFFT, (double*)m_kernelFFT, FFTW_ESTIMATE);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+                fillCacheFromDevice(readDevice,
+                                    QRect(tileRect.x() - halfKernelWidth,
+                                          tileRect.y() - halfKernelHeight,
+                                          m_fftWidth,
+                                          m_fftHeight),
+                                    cacheRowStride,
+                                    info, dataRect);
 
-        fftw_execute(fftwPlanForward);
-        addToProgress(progressPerFFT);
-        if (isInterrupted()) return;
+                if (isInterrupted()) return;
 
-        for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k)
-        {
-            fftw_execute_dft_r2c(fftwPlanForward, (double*)(*k), *k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-
-            fftMultiply(*k, m_kernelFFT);
-
-            fftw_execute_dft_c2r(fftwPlanBackward, *k, (double*)*k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-        }
+                // the channels are independent, so transform them in parallel
+                if (m_channelFFT.size() > 1) {
+                    QtConcurrent::blockingMap(m_channelFFT, ChannelProcessor(this, plans.data()));
+                } else {
+                    Q_FOREACH (fftw_complex *channel, m_channelFFT) {
+                        processChannel(channel, plans.data());
+                    }
+                }
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftw_destroy_plan(fftwPlanForward);
-        fftw_destroy_plan(fftwPlanBackward);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+                if (isInterrupted()) return;
 
+                writeResultToDevice(tileRect.translated(dstOffset),
+                                    cacheRowStride, halfKernelWidth, halfKernelHeight,
+                                    info, dataRect);
 
-        writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
-                            cacheRowStride, halfKernelWidth, halfKernelHeight,
-                            info, dataRect);
+                addToProgress(progressPerTile);
+            }
+        }
 
-        addToProgress(20);
         cleanUp();
     }
 
@@ -400,6 +494,46 @@ public:
     }
 
 private:
+    /**
+     * Returns the size of the tile (without margins) along one
+     * dimension, so that the FFT buffer doesn't exceed maxFFTSize
+     */
+    static int calculateTileSize(int areaSize, int margins) {
+        const int maxFFTSize = 2048;
+        const int minTileSize = 256;
+
+        if (areaSize + margins <= maxFFTSize) {
+            return areaSize;
+        }
+
+        return qMin(areaSize, qMax(maxFFTSize - margins, minTileSize));
+    }
+
+    struct ChannelProcessor {
+        typedef void result_type;
+
+        ChannelProcessor(KisConvolutionWorkerFFT *worker,
+                         const KisConvolutionWorkerFFTPlanCache::Plans *plans)
+            : m_worker(worker),
+              m_plans(plans)
+        {
+        }
+
+        void operator()(fftw_complex *channel) const {
+            m_worker->processChannel(channel, m_plans);
+        }
+
+    private:
+        KisConvolutionWorkerFFT *m_worker;
+        const KisConvolutionWorkerFFTPlanCache::Plans *m_plans;
+    };
+
+    void processChannel(fftw_complex *channel, const KisConvolutionWorkerFFTPlanCache::Plans *plans) {
+        fftw_execute_dft_r2c(plans->forward, (double*)channel, channel);
+        fftMultiply(channel, m_kernelFFT);
+        fftw_execute_dft_c2r(plans->backward, channel, (double*)channel);
+    }
+
     void fftFillKernelMatrix(const KisConvolutionKernelSP kernel, fftw_complex *m_kernelFFT)
     {
         // find central item
@@ -523,6 +657,7 @@ private:
         // free kernel fft data
         if (m_kernelFFT) {
             fftw_free(m_kernelFFT);
+            m_kernelFFT = 0;
         }
 
         Q_FOREACH (fftw_complex *channel, m_channelFFT) {
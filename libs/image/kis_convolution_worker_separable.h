@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KIS_CONVOLUTION_WORKER_SEPARABLE_H
+#define KIS_CONVOLUTION_WORKER_SEPARABLE_H
+
+#include "kis_convolution_worker.h"
+#include "kis_convolution_kernel.h"
+#include "kis_assert.h"
+
+#include <KoColorSpace.h>
+#include <KoConvolutionOp.h>
+
+#include <QVector>
+#include <string.h>
+
+
+/**
+ * Applies a separable kernel in two 1D passes: the horizontal one
+ * is done right after a row of source pixels is read, the vertical
+ * one is done over a ring buffer of the last kernel-height rows.
+ *
+ * That reduces the complexity from O(kw * kh) down to O(kw + kh)
+ * operations per pixel. The pixel math is done by the color space's
+ * KoConvolutionOp, which is vectorized for the most popular color
+ * spaces.
+ *
+ * The worker can be used only when all the channels of the device are
+ * convolved (see isApplicable()), the results are the same as the ones
+ * of KisConvolutionWorkerSpatial up to the floating point rounding.
+ */
+template <class _IteratorFactory_>
+class KisConvolutionWorkerSeparable : public KisConvolutionWorker<_IteratorFactory_>
+{
+    typedef Eigen::Matrix<qreal, Eigen::Dynamic, 1> KernelVector;
+
+public:
+    KisConvolutionWorkerSeparable(KisPainter *painter, KoUpdater *progress)
+        : KisConvolutionWorker<_IteratorFactory_>(painter, progress)
+    {
+    }
+
+    static bool isApplicable(const KisConvolutionKernelSP kernel, const KisPainter *painter, const KoColorSpace *cs) {
+        const QBitArray channelFlags = painter->channelFlags();
+
+        return cs->convolutionOp() &&
+            (channelFlags.isEmpty() || channelFlags.count(true) == channelFlags.size()) &&
+            kernel->isSeparable();
+    }
+
+    void execute(const KisConvolutionKernelSP kernel, const KisPaintDeviceSP src, QPoint srcPos, QPoint dstPos, QSize areaSize, const QRect& dataRect) override {
+        KernelVector horizontal;
+        KernelVector vertical;
+
+        if (!kernel->separate(&horizontal, &vertical)) {
+            KIS_ASSERT_RECOVER_NOOP(0 && "the kernel is not separable");
+            return;
+        }
+
+        const int kw = kernel->width();
+        const int kh = kernel->height();
+        const int khalfWidth = (kw - 1) / 2;
+        const int khalfHeight = (kh - 1) / 2;
+
+        // Make the area we cover as small as possible
+        if (this->m_painter->selection()) {
+            QRect r = this->m_painter->selection()->selectedRect().intersected(QRect(srcPos, areaSize));
+            dstPos += r.topLeft() - srcPos;
+            srcPos = r.topLeft();
+            areaSize = r.size();
+        }
+
+        if (areaSize.width() == 0 || areaSize.height() == 0)
+            return;
+
+        /**
+         * The spatial worker multiplies a pixel at position (r, c)
+         * by the kernel value at (kh - r - 1, kw - c - 1), so do we
+         */
+        QVector<qreal> horizontalKernel(kw);
+        for (int i = 0; i < kw; i++) {
+            horizontalKernel[i] = horizontal(kw - i - 1);
+        }
+
+        QVector<qreal> verticalKernel(kh);
+        for (int i = 0; i < kh; i++) {
+            verticalKernel[i] = vertical(kh - i - 1);
+        }
+
+        const KoColorSpace *cs = src->colorSpace();
+        const KoConvolutionOp *op = cs->convolutionOp();
+        const int pixelSize = cs->pixelSize();
+        const int channelCount = cs->channelCount();
+
+        const int width = areaSize.width();
+        const int height = areaSize.height();
+        const int srcLineWidth = width + kw - 1;
+        const int rowSize = channelCount * width;
+
+        QVector<quint8> srcLine(srcLineWidth * pixelSize);
+        QVector<qreal> srcPlanes(srcLineWidth * channelCount);
+        QVector<qreal> rowsRing(kh * rowSize);
+        QVector<const qreal*> rows(kh);
+        QVector<qreal> dstPlanes(rowSize);
+        QVector<quint8> dstLine(width * pixelSize);
+
+        const qreal factor = kernel->factor() ? 1.0 / kernel->factor() : 1.0;
+        const qreal offset = kernel->offset();
+
+        bool hasProgressUpdater = this->m_progress;
+        if (hasProgressUpdater) {
+            this->m_progress->setProgress(0);
+            this->m_progress->setRange(0, height);
+        }
+
+        typename _IteratorFactory_::HLineConstIterator srcIt =
+            _IteratorFactory_::createHLineConstIterator(src, srcPos.x() - khalfWidth, srcPos.y() - khalfHeight, srcLineWidth, dataRect);
+        typename _IteratorFactory_::HLineIterator dstIt =
+            _IteratorFactory_::createHLineIterator(this->m_painter->device(), dstPos.x(), dstPos.y(), width, dataRect);
+
+        for (int srcRow = 0; srcRow < height + kh - 1; srcRow++) {
+            // horizontal pass
+            quint8 *srcLinePtr = srcLine.data();
+            do {
+                memcpy(srcLinePtr, srcIt->oldRawData(), pixelSize);
+                srcLinePtr += pixelSize;
+            } while (srcIt->nextPixel());
+            srcIt->nextRow();
+
+            op->splitIntoPlanes(srcLine.constData(), srcPlanes.data(), srcLineWidth, srcLineWidth);
+
+            qreal *ringRow = rowsRing.data() + (srcRow % kh) * rowSize;
+            for (int ch = 0; ch < channelCount; ch++) {
+                op->convolveLine(srcPlanes.constData() + ch * srcLineWidth,
+                                 ringRow + ch * width,
+                                 width,
+                                 horizontalKernel.constData(), kw);
+            }
+
+            if (srcRow < kh - 1) continue;
+
+            // vertical pass
+            const int dstRow = srcRow - kh + 1;
+            for (int i = 0; i < kh; i++) {
+                rows[i] = rowsRing.constData() + ((dstRow + i) % kh) * rowSize;
+            }
+
+            op->convolveAcrossLines(rows.constData(), dstPlanes.data(), rowSize,
+                                    verticalKernel.constData(), kh);
+
+            op->mergePlanes(dstPlanes.constData(), width, dstLine.data(), width, factor, offset);
+
+            const quint8 *dstLinePtr = dstLine.constData();
+            do {
+                memcpy(dstIt->rawData(), dstLinePtr, pixelSize);
+                dstLinePtr += pixelSize;
+            } while (dstIt->nextPixel());
+            dstIt->nextRow();
+
+            if (hasProgressUpdater) {
+                this->m_progress->setValue(dstRow);
+
+                if (this->m_progress->interrupted()) {
+                    return;
+                }
+            }
+        }
+    }
+};
+
+#endif
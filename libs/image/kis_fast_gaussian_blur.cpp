@@ -0,0 +1,346 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_fast_gaussian_blur.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+#include <QBitArray>
+#include <QRect>
+#include <QScopedPointer>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <KoColorSpace.h>
+#include <KoConvolutionOp.h>
+#include <KoUpdater.h>
+
+#include "kis_global.h"
+#include "kis_gaussian_kernel.h"
+#include "kis_paint_device.h"
+#include "kis_transaction.h"
+#include "kis_default_bounds_base.h"
+
+
+namespace {
+
+/**
+ * Gaussian radii starting from which the box approximation is used.
+ * Smaller kernels are fast enough with the separable convolution
+ * and the approximation is more visible on them.
+ */
+const qreal minimalApproximatedRadius = 25.0;
+
+inline int clampIndex(int index, int size) {
+    return qBound(0, index, size - 1);
+}
+
+/**
+ * One box blur pass over a line of values. The values outside
+ * the line are considered to be equal to the border ones.
+ */
+void boxBlurLine(const qreal *src, qreal *dst, int length, int radius)
+{
+    const qreal norm = 1.0 / (2 * radius + 1);
+
+    qreal sum = 0;
+    for (int k = -radius; k <= radius; k++) {
+        sum += src[clampIndex(k, length)];
+    }
+
+    for (int i = 0; i < length; i++) {
+        dst[i] = sum * norm;
+        sum += src[clampIndex(i + radius + 1, length)] - src[clampIndex(i - radius, length)];
+    }
+}
+
+/**
+ * One box blur pass over the columns of a plane. The sums are
+ * accumulated for the whole row at once to keep the memory
+ * access sequential.
+ */
+void boxBlurColumns(const qreal *src, qreal *dst, int width, int height, int radius, qreal *sums)
+{
+    const qreal norm = 1.0 / (2 * radius + 1);
+
+    memset(sums, 0, width * sizeof(qreal));
+
+    for (int k = -radius; k <= radius; k++) {
+        const qreal *row = src + clampIndex(k, height) * width;
+        for (int x = 0; x < width; x++) {
+            sums[x] += row[x];
+        }
+    }
+
+    for (int y = 0; y < height; y++) {
+        qreal *dstRow = dst + y * width;
+        const qreal *addedRow = src + clampIndex(y + radius + 1, height) * width;
+        const qreal *removedRow = src + clampIndex(y - radius, height) * width;
+
+        for (int x = 0; x < width; x++) {
+            dstRow[x] = sums[x] * norm;
+            sums[x] += addedRow[x] - removedRow[x];
+        }
+    }
+}
+
+struct TileProcessor {
+    typedef void result_type;
+
+    TileProcessor(KisPaintDeviceSP _srcDevice,
+                  KisPaintDeviceSP _dstDevice,
+                  const QRect &_dataRect,
+                  const QVector<int> &_xRadii,
+                  const QVector<int> &_yRadii,
+                  KoUpdater *_progressUpdater)
+        : srcDevice(_srcDevice),
+          dstDevice(_dstDevice),
+          dataRect(_dataRect),
+          xRadii(_xRadii),
+          yRadii(_yRadii),
+          progressUpdater(_progressUpdater)
+    {
+        xMargin = 0;
+        Q_FOREACH (int r, xRadii) xMargin += r;
+
+        yMargin = 0;
+        Q_FOREACH (int r, yRadii) yMargin += r;
+    }
+
+    void readPixels(const QRect &rc, quint8 *dst) const {
+        const int pixelSize = srcDevice->pixelSize();
+        const QRect validRect = rc & dataRect;
+
+        if (srcDevice->defaultBounds()->wrapAroundMode() ||
+            validRect.isEmpty() || validRect == rc) {
+
+            srcDevice->readBytes(dst, rc);
+            return;
+        }
+
+        // repeat the border pixels of the data rect
+        QVector<quint8> validPixels(validRect.width() * validRect.height() * pixelSize);
+        srcDevice->readBytes(validPixels.data(), validRect);
+
+        for (int y = rc.top(); y <= rc.bottom(); y++) {
+            const int srcRow = qBound(validRect.top(), y, validRect.bottom()) - validRect.top();
+            const quint8 *srcRowPtr = validPixels.constData() + srcRow * validRect.width() * pixelSize;
+
+            for (int x = rc.left(); x <= rc.right(); x++) {
+                const int srcColumn = qBound(validRect.left(), x, validRect.right()) - validRect.left();
+                memcpy(dst, srcRowPtr + srcColumn * pixelSize, pixelSize);
+                dst += pixelSize;
+            }
+        }
+    }
+
+    void operator()(const QRect &tileRect) const {
+        if (progressUpdater && progressUpdater->interrupted()) return;
+
+        const KoColorSpace *cs = srcDevice->colorSpace();
+        const KoConvolutionOp *op = cs->convolutionOp();
+        const int pixelSize = cs->pixelSize();
+        const int channelCount = cs->channelCount();
+
+        const QRect readRect = tileRect.adjusted(-xMargin, -yMargin, xMargin, yMargin);
+        const int width = readRect.width();
+        const int height = readRect.height();
+        const int planeSize = width * height;
+
+        QVector<quint8> pixels(planeSize * pixelSize);
+        readPixels(readRect, pixels.data());
+
+        QVector<qreal> planes(channelCount * planeSize);
+        op->splitIntoPlanes(pixels.constData(), planes.data(), planeSize, planeSize);
+
+        QVector<qreal> tempPlane(planeSize);
+        QVector<qreal> sums(width);
+
+        for (int ch = 0; ch < channelCount; ch++) {
+            qreal *plane = planes.data() + ch * planeSize;
+            qreal *src = plane;
+            qreal *dst = tempPlane.data();
+
+            Q_FOREACH (int radius, xRadii) {
+                if (!radius) continue;
+
+                for (int y = 0; y < height; y++) {
+                    boxBlurLine(src + y * width, dst + y * width, width, radius);
+                }
+                std::swap(src, dst);
+            }
+
+            Q_FOREACH (int radius, yRadii) {
+                if (!radius) continue;
+
+                boxBlurColumns(src, dst, width, height, radius, sums.data());
+                std::swap(src, dst);
+            }
+
+            if (src != plane) {
+                memcpy(plane, src, planeSize * sizeof(qreal));
+            }
+        }
+
+        QVector<quint8> result(tileRect.width() * tileRect.height() * pixelSize);
+        quint8 *resultPtr = result.data();
+
+        for (int y = 0; y < tileRect.height(); y++) {
+            op->mergePlanes(planes.constData() + (y + yMargin) * width + xMargin, planeSize,
+                            resultPtr, tileRect.width(), 1.0, 0.0);
+            resultPtr += tileRect.width() * pixelSize;
+        }
+
+        dstDevice->writeBytes(result.constData(), tileRect);
+    }
+
+    KisPaintDeviceSP srcDevice;
+    KisPaintDeviceSP dstDevice;
+    QRect dataRect;
+    QVector<int> xRadii;
+    QVector<int> yRadii;
+    KoUpdater *progressUpdater;
+
+    int xMargin;
+    int yMargin;
+};
+
+}
+
+QVector<int> KisFastGaussianBlur::boxRadiiForSigma(qreal sigma)
+{
+    const int numBoxes = 3;
+    QVector<int> radii(numBoxes, 0);
+
+    if (sigma <= 0.0) return radii;
+
+    /**
+     * Three box blurs with widths wl and wu = wl + 2 give the
+     * variance closest to sigma^2, see W. Jarosz, "Fast Image
+     * Convolutions" and P. Kovesi, "Fast Almost-Gaussian Filtering"
+     */
+    const qreal idealWidth = std::sqrt(12.0 * pow2(sigma) / numBoxes + 1.0);
+
+    int lowerWidth = std::floor(idealWidth);
+    if (!(lowerWidth & 0x1)) {
+        lowerWidth--;
+    }
+    const int upperWidth = lowerWidth + 2;
+
+    const qreal idealNumLower =
+        (12.0 * pow2(sigma) - numBoxes * pow2(lowerWidth) - 4.0 * numBoxes * lowerWidth - 3.0 * numBoxes) /
+        (-4.0 * lowerWidth - 4.0);
+    const int numLower = qRound(idealNumLower);
+
+    for (int i = 0; i < numBoxes; i++) {
+        const int boxWidth = i < numLower ? lowerWidth : upperWidth;
+        radii[i] = (boxWidth - 1) / 2;
+    }
+
+    return radii;
+}
+
+int KisFastGaussianBlur::marginFromRadius(qreal radius)
+{
+    if (radius <= 0.0) return 0;
+
+    int margin = 0;
+    Q_FOREACH (int r, boxRadiiForSigma(KisGaussianKernel::sigmaFromRadius(radius))) {
+        margin += r;
+    }
+    return margin;
+}
+
+bool KisFastGaussianBlur::isPreferred(KisPaintDeviceSP device, qreal xRadius, qreal yRadius, const QBitArray &channelFlags)
+{
+    return qMax(xRadius, yRadius) >= minimalApproximatedRadius &&
+        device->colorSpace()->convolutionOp() &&
+        (channelFlags.isEmpty() || channelFlags.count(true) == channelFlags.size());
+}
+
+void KisFastGaussianBlur::apply(KisPaintDeviceSP device, const QRect &rect, qreal xRadius, qreal yRadius, KoUpdater *progressUpdater, bool createTransaction)
+{
+    if (rect.isEmpty()) return;
+
+    if (progressUpdater) {
+        progressUpdater->setProgress(0);
+    }
+
+    const QVector<int> xRadii = xRadius > 0.0 ?
+        boxRadiiForSigma(KisGaussianKernel::sigmaFromRadius(xRadius)) : QVector<int>();
+    const QVector<int> yRadii = yRadius > 0.0 ?
+        boxRadiiForSigma(KisGaussianKernel::sigmaFromRadius(yRadius)) : QVector<int>();
+
+    // copying is cheap, because the tiles are shared in copy-on-write manner
+    KisPaintDeviceSP srcDevice = new KisPaintDevice(*device);
+
+    TileProcessor processor(srcDevice, device, rect | device->exactBounds(),
+                            xRadii, yRadii, progressUpdater);
+
+    /**
+     * The margins are read for every tile, so the tiles should not
+     * be too small in comparison to them
+     */
+    const int minimalTileSize = 512;
+    const int tileWidth = qMax(minimalTileSize, 2 * processor.xMargin);
+    const int tileHeight = qMax(minimalTileSize, 2 * processor.yMargin);
+
+    QVector<QRect> tiles;
+    for (int y = rect.y(); y <= rect.bottom(); y += tileHeight) {
+        for (int x = rect.x(); x <= rect.right(); x += tileWidth) {
+            tiles << (QRect(x, y, tileWidth, tileHeight) & rect);
+        }
+    }
+
+    QScopedPointer<KisTransaction> transaction;
+    if (createTransaction) {
+        transaction.reset(new KisTransaction(device));
+    }
+
+    /**
+     * KoUpdater is not thread-safe, so the tiles are processed in
+     * batches, one tile per thread, and the progress is reported
+     * between them from the calling thread
+     */
+    const bool useMultithreading = tiles.size() > 1 && QThread::idealThreadCount() > 1;
+    const int batchSize = useMultithreading ? QThread::idealThreadCount() : 1;
+
+    for (int i = 0; i < tiles.size(); i += batchSize) {
+        if (progressUpdater && progressUpdater->interrupted()) break;
+
+        QVector<QRect> batch = tiles.mid(i, batchSize);
+
+        if (useMultithreading) {
+            QtConcurrent::blockingMap(batch, processor);
+        } else {
+            Q_FOREACH (const QRect &tile, batch) {
+                processor(tile);
+            }
+        }
+
+        if (progressUpdater) {
+            progressUpdater->setProgress(100 * (i + batch.size()) / tiles.size());
+        }
+    }
+
+    if (progressUpdater) {
+        progressUpdater->setProgress(100);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_FAST_GAUSSIAN_BLUR_H
+#define __KIS_FAST_GAUSSIAN_BLUR_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+#include <QVector>
+
+class QRect;
+class QBitArray;
+class KoUpdater;
+
+
+/**
+ * Approximates Gaussian blur with three consecutive box blurs in
+ * each direction. A box blur is calculated with a running sum, so the
+ * cost per pixel doesn't depend on the radius, which makes it suitable
+ * for huge radii (e.g. drop shadows with big spread).
+ *
+ * The result only approximates the Gaussian, so it is never used
+ * implicitly by KisGaussianKernel::applyGaussian(). The callers should
+ * opt-in explicitly, e.g. the Gaussian blur filter does that when
+ * "fastApproximation" property of its configuration is set.
+ *
+ * The area is split into tiles, which are processed in parallel. Every
+ * tile reads its margins from a copy-on-write copy of the source, so
+ * the device can be filtered in-place.
+ *
+ * The border pixels are handled the same way as BORDER_REPEAT mode of
+ * KisConvolutionPainter does.
+ */
+class KRITAIMAGE_EXPORT KisFastGaussianBlur
+{
+public:
+    /**
+     * Radii of the three box blurs approximating the Gaussian
+     * with \p sigma
+     */
+    static QVector<int> boxRadiiForSigma(qreal sigma);
+
+    /**
+     * The number of pixels the blur reads around the applied rect
+     */
+    static int marginFromRadius(qreal radius);
+
+    /**
+     * \return true if the fast approximation can replace the real
+     * Gaussian kernel. It pays off only for big radii, where the
+     * convolution becomes too slow, and it cannot skip any channels.
+     */
+    static bool isPreferred(KisPaintDeviceSP device,
+                            qreal xRadius, qreal yRadius,
+                            const QBitArray &channelFlags);
+
+    /**
+     * Blurs \p rect of \p device in-place. The progress is reported
+     * from the calling thread only.
+     *
+     * \param createTransaction wrap the change into a KisTransaction,
+     *        the same way KisGaussianKernel::applyGaussian() does
+     */
+    static void apply(KisPaintDeviceSP device,
+                      const QRect& rect,
+                      qreal xRadius, qreal yRadius,
+                      KoUpdater *progressUpdater,
+                      bool createTransaction = false);
+};
+
+#endif /* __KIS_FAST_GAUSSIAN_BLUR_H */
@@ -272,6 +272,16 @@ void KisImageConfig::setSwapDir(const QString &swapDir)
     m_config.writeEntry("swaplocation", swapDir);
 }
 
+bool KisImageConfig::lazyLoadLayers(bool requestDefault) const
+{
+    return !requestDefault ? m_config.readEntry("lazyLoadLayers", false) : false;
+}
+
+void KisImageConfig::setLazyLoadLayers(bool value)
+{
+    m_config.writeEntry("lazyLoadLayers", value);
+}
+
 int KisImageConfig::numberOfOnionSkins() const
 {
     return m_config.readEntry("numberOfOnionSkins", 10);
@@ -78,6 +78,13 @@ public:
     QString swapDir(bool requestDefault = false);
     void setSwapDir(const QString &swapDir);
 
+    /**
+     * When true, the tiles read from .kra files are put into the swap
+     * file in the compressed form and decompressed on the first access
+     */
+    bool lazyLoadLayers(bool requestDefault = false) const;
+    void setLazyLoadLayers(bool value);
+
     int numberOfOnionSkins() const;
     void setNumberOfOnionSkins(int value);
 
@@ -2485,7 +2485,7 @@ void KisPainter::setChannelFlags(QBitArray channelFlags)
     }
 }
 
-QBitArray KisPainter::channelFlags()
+QBitArray KisPainter::channelFlags() const
 {
     return d->paramInfo.channelFlags;
 }
@@ -614,7 +614,7 @@ public:
     void setChannelFlags(QBitArray channelFlags);
 
     /// @return the channel flags
-    QBitArray channelFlags();
+    QBitArray channelFlags() const;
 
     /**
      * Set the paintop preset to use. If @param image is given,
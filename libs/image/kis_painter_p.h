@@ -87,18 +87,12 @@ struct Q_DECL_HIDDEN KisPainter::Private {
 
     void fillPainterPathImpl(const QPainterPath& path, const QRect &requestedRect);
 
-    void applyDevice(const QRect &applyRect,
-                     const KisRenderedDab &dab,
-                     KisRandomAccessorSP dstIt,
-                     const KoColorSpace *srcColorSpace,
-                     KoCompositeOp::ParameterInfo &localParamInfo);
-
-    void applyDeviceWithSelection(const QRect &applyRect,
-                                  const KisRenderedDab &dab,
-                                  KisRandomAccessorSP dstIt,
-                                  KisRandomConstAccessorSP maskIt,
-                                  const KoColorSpace *srcColorSpace,
-                                  KoCompositeOp::ParameterInfo &localParamInfo);
+    void applyDevicesPerTile(const QRect &applyRect,
+                             const QList<KisRenderedDab> &devices,
+                             KisRandomAccessorSP dstIt,
+                             KisRandomConstAccessorSP maskIt,
+                             const KoColorSpace *srcColorSpace,
+                             KoCompositeOp::ParameterInfo &localParamInfo);
 
 };
 
@@ -108,6 +108,62 @@ void KisPerspectiveTransformWorker::setForwardTransform(const QTransform &transf
     init(transform);
 }
 
+namespace {
+
+/**
+ * Samples a row of destination pixels in a single batch, which
+ * lets the color space mix all the bilinear samples at once
+ */
+struct RowSampler
+{
+    RowSampler(KisRandomSubAccessorSP srcAcc, KisRandomAccessorSP dstAcc, int pixelSize)
+        : m_srcAcc(srcAcc),
+          m_dstAcc(dstAcc),
+          m_pixelSize(pixelSize)
+    {
+    }
+
+    void processRow(const QTransform &backwardTransform, const QRectF &srcClipRect,
+                    int y, int xStart, int xEnd)
+    {
+        m_srcPoints.clear();
+        m_dstXs.clear();
+
+        for (int x = xStart; x < xEnd; ++x) {
+            QPointF dstPoint(x, y);
+            QPointF srcPoint = backwardTransform.map(dstPoint);
+
+            if (srcClipRect.contains(srcPoint)) {
+                m_srcPoints.append(srcPoint);
+                m_dstXs.append(x);
+            }
+        }
+
+        if (m_srcPoints.isEmpty()) return;
+
+        m_buffer.resize(m_srcPoints.size() * m_pixelSize);
+        m_srcAcc->sampledOldRawDataBatch(m_srcPoints.constData(), m_srcPoints.size(), m_buffer.data());
+
+        const quint8 *srcPtr = m_buffer.constData();
+        for (int i = 0; i < m_dstXs.size(); i++) {
+            m_dstAcc->moveTo(m_dstXs[i], y);
+            memcpy(m_dstAcc->rawData(), srcPtr, m_pixelSize);
+            srcPtr += m_pixelSize;
+        }
+    }
+
+private:
+    KisRandomSubAccessorSP m_srcAcc;
+    KisRandomAccessorSP m_dstAcc;
+    const int m_pixelSize;
+
+    QVector<QPointF> m_srcPoints;
+    QVector<int> m_dstXs;
+    QVector<quint8> m_buffer;
+};
+
+}
+
 void KisPerspectiveTransformWorker::run()
 {
     KIS_ASSERT_RECOVER_RETURN(m_dev);
@@ -126,20 +182,11 @@ void KisPerspectiveTransformWorker::run()
 
     KisRandomSubAccessorSP srcAcc = cloneDevice->createRandomSubAccessor();
     KisRandomAccessorSP accessor = m_dev->createRandomAccessorNG(0, 0);
+    RowSampler sampler(srcAcc, accessor, m_dev->pixelSize());
 
     Q_FOREACH (const QRect &rect, m_dstRegion.rects()) {
         for (int y = rect.y(); y < rect.y() + rect.height(); ++y) {
-            for (int x = rect.x(); x < rect.x() + rect.width(); ++x) {
-
-                QPointF dstPoint(x, y);
-                QPointF srcPoint = m_backwardTransform.map(dstPoint);
-
-                if (m_srcRect.contains(srcPoint)) {
-                    accessor->moveTo(dstPoint.x(), dstPoint.y());
-                    srcAcc->moveTo(srcPoint.x(), srcPoint.y());
-                    srcAcc->sampledOldRawData(accessor->rawData());
-                }
-            }
+            sampler.processRow(m_backwardTransform, m_srcRect, y, rect.x(), rect.x() + rect.width());
         }
         progressHelper.step();
     }
@@ -161,19 +208,10 @@ void KisPerspectiveTransformWorker::runPartialDst(KisPaintDeviceSP srcDev,
 
     KisRandomSubAccessorSP srcAcc = srcDev->createRandomSubAccessor();
     KisRandomAccessorSP accessor = dstDev->createRandomAccessorNG(dstRect.x(), dstRect.y());
+    RowSampler sampler(srcAcc, accessor, dstDev->pixelSize());
 
     for (int y = dstRect.y(); y < dstRect.y() + dstRect.height(); ++y) {
-        for (int x = dstRect.x(); x < dstRect.x() + dstRect.width(); ++x) {
-
-            QPointF dstPoint(x, y);
-            QPointF srcPoint = m_backwardTransform.map(dstPoint);
-
-            if (srcClipRect.contains(srcPoint)) {
-                accessor->moveTo(dstPoint.x(), dstPoint.y());
-                srcAcc->moveTo(srcPoint.x(), srcPoint.y());
-                srcAcc->sampledOldRawData(accessor->rawData());
-            }
-        }
+        sampler.processRow(m_backwardTransform, srcClipRect, y, dstRect.x(), dstRect.x() + dstRect.width());
         progressHelper.step();
     }
 
@@ -24,6 +24,7 @@
 #include <KoColorSpace.h>
 #include <KoMixColorsOp.h>
 #include <math.h>
+#include <string.h>
 
 #include "kis_paint_device.h"
 
@@ -90,3 +91,70 @@ void KisRandomSubAccessor::sampledRawData(quint8* dst)
     pixels[3] = m_randomAccessor->rawDataConst();
     m_device->colorSpace()->mixColorsOp()->mixColors(pixels, weights, 4, dst);
 }
+
+template <bool useOldData>
+void KisRandomSubAccessor::sampledRawDataBatchImpl(const QPointF *points, int numPoints, quint8 *dst)
+{
+    if (numPoints <= 0) return;
+
+    const int pixelSize = m_device->pixelSize();
+    const int numSamples = 4 * numPoints;
+
+    /**
+     * The random accessor doesn't guarantee that the pointers it
+     * returned stay valid after it has been moved to another tile,
+     * so we copy the source pixels into a local buffer first.
+     */
+    m_batchPixels.resize(numSamples * pixelSize);
+    m_batchPixelPtrs.resize(numSamples);
+    m_batchWeights.resize(numSamples);
+
+    quint8 *pixelPtr = m_batchPixels.data();
+    const quint8 **pixelPtrs = m_batchPixelPtrs.data();
+    qint16 *weights = m_batchWeights.data();
+
+    for (int i = 0; i < numPoints; i++) {
+        const QPointF &pt = points[i];
+
+        int x = (int)floor(pt.x());
+        int y = (int)floor(pt.y());
+        double hsub = pt.x() - x;
+        if (hsub < 0.0) hsub = 1.0 + hsub;
+        double vsub = pt.y() - y;
+        if (vsub < 0.0) vsub = 1.0 + vsub;
+
+        weights[0] = qRound((1.0 - hsub) * (1.0 - vsub) * 255);
+        weights[1] = qRound((1.0 - vsub) * hsub * 255);
+        weights[2] = qRound(vsub * (1.0 - hsub) * 255);
+        weights[3] = qRound(hsub * vsub * 255);
+
+        for (int j = 0; j < 4; j++) {
+            m_randomAccessor->moveTo(x + (j & 1), y + (j >> 1));
+            memcpy(pixelPtr,
+                   useOldData ?
+                       m_randomAccessor->oldRawData() :
+                       m_randomAccessor->rawDataConst(),
+                   pixelSize);
+
+            pixelPtrs[j] = pixelPtr;
+            pixelPtr += pixelSize;
+        }
+
+        pixelPtrs += 4;
+        weights += 4;
+    }
+
+    m_device->colorSpace()->mixColorsOp()->mixColorsBatch(m_batchPixelPtrs.constData(),
+                                                          m_batchWeights.constData(),
+                                                          4, numPoints, dst);
+}
+
+void KisRandomSubAccessor::sampledOldRawDataBatch(const QPointF *points, int numPoints, quint8 *dst)
+{
+    sampledRawDataBatchImpl<true>(points, numPoints, dst);
+}
+
+void KisRandomSubAccessor::sampledRawDataBatch(const QPointF *points, int numPoints, quint8 *dst)
+{
+    sampledRawDataBatchImpl<false>(points, numPoints, dst);
+}
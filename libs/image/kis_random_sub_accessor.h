@@ -27,6 +27,8 @@
 #include <kritaimage_export.h>
 #include "kis_shared.h"
 
+#include <QVector>
+
 /**
  * Gives a random access to the sampled subpixels of an image. Use the
  * moveTo function to select the pixel. And then rawData to access the
@@ -47,16 +49,38 @@ public:
      */
     void sampledRawData(quint8* dst);
 
+    /**
+     * Copy the sampled old values of \p numPoints points into \p dst.
+     * The resulting pixels are written one after another. The points
+     * are mixed in a single batch, which is much faster than calling
+     * moveTo() and sampledOldRawData() for every pixel.
+     */
+    void sampledOldRawDataBatch(const QPointF *points, int numPoints, quint8 *dst);
+
+    /**
+     * Copy the sampled values of \p numPoints points into \p dst.
+     * \see sampledOldRawDataBatch()
+     */
+    void sampledRawDataBatch(const QPointF *points, int numPoints, quint8 *dst);
+
     inline void moveTo(double x, double y) {
         m_currentPoint.setX(x); m_currentPoint.setY(y);
     }
     inline void moveTo(const QPointF& p) {
         m_currentPoint = p;
     }
+private:
+    template <bool useOldData>
+    void sampledRawDataBatchImpl(const QPointF *points, int numPoints, quint8 *dst);
+
 private:
     KisPaintDeviceSP m_device;
     QPointF m_currentPoint;
     KisRandomConstAccessorSP m_randomAccessor;
+
+    QVector<quint8> m_batchPixels;
+    QVector<const quint8*> m_batchPixelPtrs;
+    QVector<qint16> m_batchWeights;
 };
 
 #endif
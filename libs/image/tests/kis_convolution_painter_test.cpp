@@ -471,4 +471,195 @@ void KisConvolutionPainterTest::testErode()
     TestUtil::checkQImage(dev->convertToQImage(0, imageRect), "convolution_painter_test", "dilate", "erode5");
 }
 
+void KisConvolutionPainterTest::testSeparableKernelDetection()
+{
+    qreal offset = 0.0;
+    qreal factor = 1.0;
+
+    QVERIFY(!KisConvolutionKernel::fromMatrix(initSymmFilter(offset, factor), offset, factor)->isSeparable());
+    QVERIFY(!KisConvolutionKernel::fromMatrix(initAsymmFilter(offset, factor), offset, factor)->isSeparable());
+    QVERIFY(!KisConvolutionKernel::fromMatrix(KisGaussianKernel::createDilateMatrix(5), 0, 1)->isSeparable());
+
+    QVERIFY(KisGaussianKernel::createHorizontalKernel(5)->isSeparable());
+    QVERIFY(KisGaussianKernel::createVerticalKernel(5)->isSeparable());
+
+    const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> gaussian =
+        KisGaussianKernel::createVerticalMatrix(7) * KisGaussianKernel::createHorizontalMatrix(5);
+
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(gaussian, 0, gaussian.sum());
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, 1> horizontal;
+    Eigen::Matrix<qreal, Eigen::Dynamic, 1> vertical;
+    QVERIFY(kernel->separate(&horizontal, &vertical));
+    QCOMPARE(int(horizontal.size()), int(kernel->width()));
+    QCOMPARE(int(vertical.size()), int(kernel->height()));
+
+    const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> restored = vertical * horizontal.transpose();
+    QVERIFY((restored - gaussian).cwiseAbs().maxCoeff() < 1e-12);
+}
+
+void KisConvolutionPainterTest::testSeparableConvolution()
+{
+    QImage referenceImage(TestUtil::fetchDataFileLazy("kritaTransparent.png"));
+
+    QList<const KoColorSpace*> colorSpaces;
+    colorSpaces << KoColorSpaceRegistry::instance()->rgb8();
+    colorSpaces << KoColorSpaceRegistry::instance()->rgb16();
+
+    Q_FOREACH (const KoColorSpace *cs, colorSpaces) {
+        KisPaintDeviceSP dev = new KisPaintDevice(cs);
+        dev->convertFromQImage(referenceImage, 0, 0, 0);
+
+        const QRect applyRect = dev->exactBounds();
+
+        const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> gaussian =
+            KisGaussianKernel::createVerticalMatrix(10) * KisGaussianKernel::createHorizontalMatrix(7);
+        KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(gaussian, 0, gaussian.sum());
+
+        KisPaintDeviceSP spatialDev = new KisPaintDevice(cs);
+        KisConvolutionPainter spatialPainter(spatialDev, KisConvolutionPainter::SPATIAL);
+        spatialPainter.applyMatrix(kernel, dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+
+        KisPaintDeviceSP separableDev = new KisPaintDevice(cs);
+        KisConvolutionPainter separablePainter(separableDev, KisConvolutionPainter::SEPARABLE);
+        separablePainter.applyMatrix(kernel, dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+
+        QImage spatialImage = spatialDev->convertToQImage(0, applyRect);
+        QImage separableImage = separableDev->convertToQImage(0, applyRect);
+
+        /**
+         * The order of summation is different, so the results
+         * may differ because of the rounding
+         */
+        QPoint errpoint;
+        if (!TestUtil::compareQImages(errpoint, spatialImage, separableImage, 1, 1)) {
+            spatialImage.save(QString("separable_convolution_%1_spatial.png").arg(cs->id()));
+            separableImage.save(QString("separable_convolution_%1_separable.png").arg(cs->id()));
+            QFAIL(QString("Separable convolution differs from the spatial one, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+        }
+    }
+}
+
+#include "kis_sequential_iterator.h"
+
+void KisConvolutionPainterTest::testFFTWTiled()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    // wide enough to be split into several FFT tiles
+    const QRect applyRect(0, 0, 2600, 64);
+
+    KisSequentialIterator it(dev, applyRect);
+    while (it.nextPixel()) {
+        const int x = it.x();
+        const int y = it.y();
+        KoColor c(QColor((x * 7) % 256, (y * 13) % 256, ((x ^ y) * 3) % 256, 128 + (x + y) % 128), cs);
+        memcpy(it.rawData(), c.data(), cs->pixelSize());
+    }
+
+    // non-separable kernel
+    const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix = KisGaussianKernel::createDilateMatrix(4);
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+
+    KisPaintDeviceSP spatialDev = new KisPaintDevice(cs);
+    KisConvolutionPainter spatialPainter(spatialDev, KisConvolutionPainter::SPATIAL);
+    spatialPainter.applyMatrix(kernel, dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+
+    KisPaintDeviceSP fftwDev = new KisPaintDevice(cs);
+    KisConvolutionPainter fftwPainter(fftwDev, KisConvolutionPainter::FFTW);
+    fftwPainter.applyMatrix(kernel, dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+
+    // in-place filtering must not be affected by the tiling
+    KisConvolutionPainter inPlacePainter(dev, KisConvolutionPainter::FFTW);
+    inPlacePainter.applyMatrix(kernel, dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+
+    QImage spatialImage = spatialDev->convertToQImage(0, applyRect);
+    QImage fftwImage = fftwDev->convertToQImage(0, applyRect);
+    QImage inPlaceImage = dev->convertToQImage(0, applyRect);
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint, fftwImage, inPlaceImage)) {
+        QFAIL(QString("In-place FFTW convolution differs, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+
+    if (!TestUtil::compareQImages(errpoint, spatialImage, fftwImage, 1, 1)) {
+        QFAIL(QString("Tiled FFTW convolution differs from the spatial one, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
+#include "kis_fast_gaussian_blur.h"
+
+void KisConvolutionPainterTest::testFastGaussianBoxRadii()
+{
+    for (qreal radius = 25; radius <= 300; radius += 25) {
+        const qreal sigma = KisGaussianKernel::sigmaFromRadius(radius);
+        const QVector<int> radii = KisFastGaussianBlur::boxRadiiForSigma(sigma);
+
+        QCOMPARE(radii.size(), 3);
+
+        // the variance of a box of width w is (w^2 - 1) / 12
+        qreal variance = 0;
+        Q_FOREACH (int r, radii) {
+            const int width = 2 * r + 1;
+            variance += (width * width - 1) / 12.0;
+        }
+
+        QVERIFY(qAbs(std::sqrt(variance) - sigma) < 0.1 * sigma);
+        QVERIFY(KisFastGaussianBlur::marginFromRadius(radius) <= KisGaussianKernel::kernelSizeFromRadius(radius) / 2 + 1);
+    }
+}
+
+void KisConvolutionPainterTest::testFastGaussian()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    // several tiles of the fast blur
+    const QRect applyRect(0, 0, 1200, 300);
+    dev->fill(applyRect, KoColor(Qt::white, cs));
+    dev->fill(QRect(200, 100, 500, 100), KoColor(Qt::red, cs));
+    dev->fill(QRect(600, 50, 300, 50), KoColor(Qt::blue, cs));
+
+    const qreal radius = 30;
+
+    QBitArray channelFlags(cs->channelCount(), true);
+    QVERIFY(KisFastGaussianBlur::isPreferred(dev, radius, radius, channelFlags));
+    QVERIFY(!KisFastGaussianBlur::isPreferred(dev, 5, 5, channelFlags));
+
+    channelFlags.clearBit(0);
+    QVERIFY(!KisFastGaussianBlur::isPreferred(dev, radius, radius, channelFlags));
+
+    const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> gaussian =
+        KisGaussianKernel::createVerticalMatrix(radius) * KisGaussianKernel::createHorizontalMatrix(radius);
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(gaussian, 0, gaussian.sum());
+
+    KisPaintDeviceSP exactDev = new KisPaintDevice(cs);
+    KisConvolutionPainter painter(exactDev, KisConvolutionPainter::SEPARABLE);
+    painter.applyMatrix(kernel, dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+
+    QImage exactImage = exactDev->convertToQImage(0, applyRect);
+    QPoint errpoint;
+
+    // applyGaussian() never switches to the approximation implicitly
+    KisPaintDeviceSP kernelDev = new KisPaintDevice(*dev);
+    KisGaussianKernel::applyGaussian(kernelDev, applyRect, radius, radius, QBitArray(cs->channelCount(), true), 0);
+
+    QImage kernelImage = kernelDev->convertToQImage(0, applyRect);
+    if (!TestUtil::compareQImages(errpoint, exactImage, kernelImage, 2, 2)) {
+        QFAIL(QString("Gaussian kernel differs from the exact one, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+
+    // filtered in-place
+    KisFastGaussianBlur::apply(dev, applyRect, radius, radius, 0, true);
+
+    QImage fastImage = dev->convertToQImage(0, applyRect);
+
+    if (!TestUtil::compareQImages(errpoint, exactImage, fastImage, 8, 8)) {
+        exactImage.save("fast_gaussian_exact.png");
+        fastImage.save("fast_gaussian_fast.png");
+        QFAIL(QString("Fast Gaussian blur differs too much, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
 QTEST_MAIN(KisConvolutionPainterTest)
@@ -59,6 +59,14 @@ private Q_SLOTS:
 
     void testDilate();
     void testErode();
+
+    void testSeparableKernelDetection();
+    void testSeparableConvolution();
+
+    void testFFTWTiled();
+
+    void testFastGaussianBoxRadii();
+    void testFastGaussian();
 };
 
 #endif
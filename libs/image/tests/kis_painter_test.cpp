@@ -621,6 +621,55 @@ void KisPainterTest::testMassiveBltFixedCornerCases()
     QVERIFY(dst->extent().isEmpty());
 }
 
+void KisPainterTest::testMassiveBltFixedOverlappingDabs()
+{
+    const KoColorSpace* cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+    KisPaintDeviceSP refDst = new KisPaintDevice(cs);
+
+    const QColor colors[] = {Qt::red, Qt::green, Qt::blue};
+
+    QList<KisRenderedDab> devices;
+    QRect devicesRect;
+
+    // a stroke of small dabs with a tiny spacing crossing several tiles
+    for (int i = 0; i < 200; i++) {
+        const QRect rc(3 + i, 50 + i / 2, 20, 20);
+        KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+        dev->setRect(rc);
+        dev->initialize();
+        dev->fill(rc, KoColor(colors[i % 3], cs));
+
+        KisRenderedDab dab;
+        dab.device = dev;
+        dab.offset = dev->bounds().topLeft();
+        dab.opacity = 102.0 / 255.0;
+        dab.averageOpacity = dab.opacity;
+        dab.flow = 1.0;
+
+        devices << dab;
+        devicesRect |= rc;
+    }
+
+    {
+        KisPainter painter(dst);
+        painter.bltFixed(devicesRect, devices);
+        painter.end();
+    }
+
+    {
+        KisPainter painter(refDst);
+        Q_FOREACH (const KisRenderedDab &dab, devices) {
+            painter.setOpacity(qRound(dab.opacity * 255));
+            painter.bltFixed(dab.offset, dab.device, dab.device->bounds());
+        }
+        painter.end();
+    }
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, dst, refDst));
+}
+
 
 #include "kis_lod_transform.h"
 
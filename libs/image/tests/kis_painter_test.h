@@ -61,6 +61,8 @@ private Q_SLOTS:
 
     void testMassiveBltFixedCornerCases();
 
+    void testMassiveBltFixedOverlappingDabs();
+
 
     void testOptimizedCopying();
 };
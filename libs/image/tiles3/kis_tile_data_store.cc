@@ -275,6 +275,26 @@ bool KisTileDataStore::trySwapTileData(KisTileData *td)
     return result;
 }
 
+bool KisTileDataStore::trySwapCompressedTileData(KisTileData *td, const quint8 *data, qint32 size)
+{
+    QReadLocker lock(&m_iteratorLock);
+
+    bool result = false;
+    if (!td->m_swapLock.tryLockForWrite()) return result;
+
+    if (td->data()) {
+        unregisterTileDataImp(td);
+        if (m_swappedStore.trySwapOutCompressedTileData(td, data, size)) {
+            result = true;
+        } else {
+            registerTileDataImp(td);
+        }
+    }
+    td->m_swapLock.unlock();
+
+    return result;
+}
+
 KisTileDataStoreIterator* KisTileDataStore::beginIteration()
 {
     m_iteratorLock.lockForWrite();
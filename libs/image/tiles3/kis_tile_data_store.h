@@ -118,6 +118,15 @@ public:
      */
     bool trySwapTileData(KisTileData *td);
 
+    /**
+     * Put the tile data, which has just been read from a file in the
+     * compressed form, directly into the swap. The data will be
+     * decompressed only when someone accesses it.
+     *
+     * \see KisSwappedDataStore::trySwapOutCompressedTileData()
+     */
+    bool trySwapCompressedTileData(KisTileData *td, const quint8 *data, qint32 size);
+
 
     /**
      * WARN: The following three method are only for usage
@@ -121,19 +121,23 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
     }
 
 
+    QVector<KisTileSP> tiles;
+    tiles.reserve(m_hashTable->numTiles());
+
     KisTileHashTableConstIterator iter(m_hashTable);
     KisTileSP tile;
 
+    while ((tile = iter.tile())) {
+        tiles.append(tile);
+        iter.next();
+    }
+
     KisAbstractTileCompressorSP compressor =
         KisTileCompressorFactory::create(CURRENT_VERSION);
 
-    while ((tile = iter.tile())) {
-        retval = compressor->writeTile(tile, store);
-        if (!retval) {
-            warnFile << "Failed to write tile";
-            break;
-        }
-        iter.next();
+    retval = compressor->writeTiles(tiles, store);
+    if (!retval) {
+        warnFile << "Failed to write tile";
     }
 
     return retval;
@@ -175,12 +179,7 @@ bool KisTiledDataManager::read(QIODevice *stream)
     KisAbstractTileCompressorSP compressor =
         KisTileCompressorFactory::create(tilesVersion);
 
-    bool readSuccess = true;
-    for (quint32 i = 0; i < numTiles; i++) {
-        if (!compressor->readTile(stream, this)) {
-            readSuccess = false;
-        }
-    }
+    bool readSuccess = compressor->readTiles(stream, this, numTiles);
 
     m_mementoManager->commit();
     return readSuccess;
@@ -25,3 +25,27 @@ KisAbstractTileCompressor::KisAbstractTileCompressor()
 KisAbstractTileCompressor::~KisAbstractTileCompressor()
 {
 }
+
+bool KisAbstractTileCompressor::writeTiles(const QVector<KisTileSP> &tiles, KisPaintDeviceWriter &store)
+{
+    Q_FOREACH (KisTileSP tile, tiles) {
+        if (!writeTile(tile, store)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool KisAbstractTileCompressor::readTiles(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles)
+{
+    bool result = true;
+
+    for (quint32 i = 0; i < numTiles; i++) {
+        if (!readTile(stream, dm)) {
+            result = false;
+        }
+    }
+
+    return result;
+}
@@ -19,6 +19,8 @@
 #ifndef __KIS_ABSTRACT_TILE_COMPRESSOR_H
 #define __KIS_ABSTRACT_TILE_COMPRESSOR_H
 
+#include <QVector>
+
 #include "kritaimage_export.h"
 #include "../kis_tile.h"
 #include "../kis_tiled_data_manager.h"
@@ -47,6 +49,15 @@ public:
      */
     virtual bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) = 0;
 
+    /**
+     * Compresses all the \a tiles and writes them into the \a store
+     * in the order they are passed. The default implementation just
+     * calls writeTile() for every tile, but the compressors may
+     * override it to compress several tiles at once.
+     * Used by datamanager in save routines
+     */
+    virtual bool writeTiles(const QVector<KisTileSP> &tiles, KisPaintDeviceWriter &store);
+
     /**
      * Decompresses the \a tile from the \a stream.
      * Used by datamanager in load/save routines
@@ -55,6 +66,14 @@ public:
      */
     virtual bool readTile(QIODevice *stream, KisTiledDataManager *dm) = 0;
 
+    /**
+     * Decompresses \a numTiles tiles from the \a stream. The default
+     * implementation just calls readTile() for every tile, but the
+     * compressors may override it to decompress several tiles at once.
+     * Used by datamanager in load routines
+     */
+    virtual bool readTiles(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles);
+
     /**
      * Compresses a \a tileData and writes it into the \a buffer.
      * The buffer must be at least tileDataBufferSize() bytes long.
@@ -26,7 +26,8 @@
 //#define COMPRESSOR_VERSION 2
 
 KisSwappedDataStore::KisSwappedDataStore()
-    : m_memoryMetric(0)
+    : m_memoryMetric(0),
+      m_swapUsage(0)
 {
     KisImageConfig config(true);
     const quint64 maxSwapSize = config.maxSwapSize() * MiB;
@@ -36,6 +37,8 @@ KisSwappedDataStore::KisSwappedDataStore()
     m_allocator = new KisChunkAllocator(swapSlabSize, maxSwapSize);
     m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize);
 
+    m_maxCompressedSwapUsage = maxSwapSize / 2;
+
     // FIXME: use a factory after the patch is committed
     m_compressor = new KisTileCompressor2();
 }
@@ -73,18 +76,36 @@ bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
     qint32 bytesWritten;
     m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
 
-    KisChunk chunk = m_allocator->getChunk(bytesWritten);
+    return swapOutCompressedData(td, (quint8*) m_buffer.data(), bytesWritten);
+}
+
+bool KisSwappedDataStore::trySwapOutCompressedTileData(KisTileData *td, const quint8 *data, qint32 size)
+{
+    Q_ASSERT(td->data());
+    QMutexLocker locker(&m_lock);
+
+    if (m_swapUsage + size > m_maxCompressedSwapUsage) {
+        return false;
+    }
+
+    return swapOutCompressedData(td, data, size);
+}
+
+bool KisSwappedDataStore::swapOutCompressedData(KisTileData *td, const quint8 *data, qint32 size)
+{
+    KisChunk chunk = m_allocator->getChunk(size);
     quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
     if (!ptr) {
         qWarning() << "swap out of tile failed";
         return false;
     }
-    memcpy(ptr, m_buffer.data(), bytesWritten);
+    memcpy(ptr, data, size);
 
     td->releaseMemory();
     td->setSwapChunk(chunk);
 
     m_memoryMetric += td->pixelSize();
+    m_swapUsage += size;
 
     return true;
 }
@@ -107,12 +128,15 @@ void KisSwappedDataStore::swapInTileData(KisTileData *td)
     m_allocator->freeChunk(chunk);
 
     m_memoryMetric -= td->pixelSize();
+    m_swapUsage -= chunk.size();
 }
 
 void KisSwappedDataStore::forgetTileData(KisTileData *td)
 {
     QMutexLocker locker(&m_lock);
 
+    m_swapUsage -= td->swapChunk().size();
+
     m_allocator->freeChunk(td->swapChunk());
     td->setSwapChunk(KisChunk());
 
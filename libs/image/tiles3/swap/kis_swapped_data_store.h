@@ -50,6 +50,21 @@ public:
      */
     bool trySwapOutTileData(KisTileData *td);
 
+    /**
+     * Put the already compressed \a data of the \a td into the swap
+     * file and free memory occupied by td->data(). The data should be
+     * in the format produced by KisTileCompressor2, which is used for
+     * storing the tiles in .kra files as well.
+     *
+     * The compressed data is allowed to take only a part of the swap,
+     * so that the swapper still has space to work with. Returns false
+     * when this limit is reached.
+     *
+     * LOCKING: the lock on the tile data should be taken
+     *          by the caller before making a call.
+     */
+    bool trySwapOutCompressedTileData(KisTileData *td, const quint8 *data, qint32 size);
+
     /**
      * Restore the data of a \a td basing on information
      * stored in the swap file.
@@ -76,6 +91,9 @@ public:
      */
     void debugStatistics();
 
+private:
+    bool swapOutCompressedData(KisTileData *td, const quint8 *data, qint32 size);
+
 private:
     QByteArray m_buffer;
     KisAbstractTileCompressor *m_compressor;
@@ -86,6 +104,9 @@ private:
     QMutex m_lock;
 
     qint64 m_memoryMetric;
+
+    qint64 m_swapUsage;
+    qint64 m_maxCompressedSwapUsage;
 };
 
 #endif /* __KIS_SWAPPED_DATA_STORE_H */
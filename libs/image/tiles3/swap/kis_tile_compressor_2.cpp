@@ -19,7 +19,12 @@
 #include "kis_tile_compressor_2.h"
 #include "kis_lzf_compression.h"
 #include <QIODevice>
+#include <QBuffer>
+#include <QThread>
+#include <QtConcurrent>
 #include "kis_paint_device_writer.h"
+#include "kis_image_config.h"
+#include "../kis_tile_data_store.h"
 #define TILE_DATA_SIZE(pixelSize) ((pixelSize) * KisTileData::WIDTH * KisTileData::HEIGHT)
 
 const QString KisTileCompressor2::m_compressionName = "LZF";
@@ -60,11 +65,31 @@ bool KisTileCompressor2::writeTile(KisTileSP tile, KisPaintDeviceWriter &store)
     return retval;
 }
 
-bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
+QByteArray KisTileCompressor2::compressTiles(const QVector<KisTileSP> &tiles)
 {
-    const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize(dm));
-    prepareStreamingBuffer(tileDataSize);
+    QByteArray result;
+
+    Q_FOREACH (KisTileSP tile, tiles) {
+        const qint32 tileDataSize = TILE_DATA_SIZE(tile->pixelSize());
+        prepareStreamingBuffer(tileDataSize);
+
+        qint32 bytesWritten;
+
+        tile->lockForRead();
+        compressTileData(tile->tileData(), (quint8*)m_streamingBuffer.data(),
+                         m_streamingBuffer.size(), bytesWritten);
+        tile->unlock();
+
+        result.append(getHeader(tile, bytesWritten).toLatin1());
+        result.append(m_streamingBuffer.constData(), bytesWritten);
+    }
 
+    return result;
+}
+
+bool KisTileCompressor2::readTileHeader(QIODevice *stream, KisTiledDataManager *dm,
+                                        KisTileSP *tile, qint32 *dataSize)
+{
     QByteArray header = stream->readLine(maxHeaderLength());
 
     QList<QByteArray> headerItems = header.trimmed().split(',');
@@ -72,7 +97,7 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
         qint32 x = headerItems.takeFirst().toInt();
         qint32 y = headerItems.takeFirst().toInt();
         QString compressionName = headerItems.takeFirst();
-        qint32 dataSize = headerItems.takeFirst().toInt();
+        *dataSize = headerItems.takeFirst().toInt();
 
         Q_ASSERT(headerItems.isEmpty());
         Q_ASSERT(compressionName == m_compressionName);
@@ -80,8 +105,38 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
         qint32 row = yToRow(dm, y);
         qint32 col = xToCol(dm, x);
 
-        KisTileSP tile = dm->getTile(col, row, true);
+        *tile = dm->getTile(col, row, true);
+        return true;
+    }
+    return false;
+}
+
+QByteArray KisTileCompressor2::readTileData(QIODevice *stream, qint32 dataSize)
+{
+    QBuffer *buffer = qobject_cast<QBuffer*>(stream);
+
+    if (buffer) {
+        const QByteArray &data = buffer->data();
+        const qint64 pos = buffer->pos();
+
+        if (dataSize >= 0 && pos + dataSize <= data.size()) {
+            buffer->seek(pos + dataSize);
+            return QByteArray::fromRawData(data.constData() + pos, dataSize);
+        }
+    }
+
+    return stream->read(dataSize);
+}
+
+bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
+{
+    const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize(dm));
+    prepareStreamingBuffer(tileDataSize);
+
+    KisTileSP tile;
+    qint32 dataSize = 0;
 
+    if (readTileHeader(stream, dm, &tile, &dataSize)) {
         stream->read(m_streamingBuffer.data(), dataSize);
 
         tile->lockForWrite();
@@ -92,6 +147,207 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
     return false;
 }
 
+namespace {
+
+/**
+ * The tiles are (de)compressed in batches, so that every job
+ * has enough work to outweigh the scheduling overhead
+ */
+const int tilesPerBatch = 64;
+
+struct CompressedTile {
+    KisTileSP tile;
+    QByteArray data;
+};
+
+bool decompressBatch(const QVector<CompressedTile> &batch)
+{
+    // every job needs its own work buffers
+    KisTileCompressor2 compressor;
+    bool result = true;
+
+    Q_FOREACH (const CompressedTile &compressedTile, batch) {
+        compressedTile.tile->lockForWrite();
+        result &= compressor.decompressTileData((quint8*)compressedTile.data.constData(),
+                                                compressedTile.data.size(),
+                                                compressedTile.tile->tileData());
+        compressedTile.tile->unlock();
+    }
+
+    return result;
+}
+
+}
+
+bool KisTileCompressor2::writeTiles(const QVector<KisTileSP> &tiles, KisPaintDeviceWriter &store)
+{
+    const int numThreads = QThread::idealThreadCount();
+
+    if (numThreads <= 1 || tiles.size() < 2 * tilesPerBatch) {
+        return KisAbstractTileCompressor::writeTiles(tiles, store);
+    }
+
+    /**
+     * The batches are compressed in the global thread pool, but
+     * written into the store by the calling thread only, strictly
+     * in the order of the tiles, so the file is the same as the one
+     * written by writeTile(). Only a limited number of batches is
+     * kept in flight to not hold too much compressed data in memory.
+     */
+    const int maxJobsInFlight = 2 * numThreads;
+
+    QList<QFuture<QByteArray>> jobs;
+    bool result = true;
+
+    auto writeFirstBatch = [&] () {
+        const QByteArray data = jobs.takeFirst().result();
+
+        if (result && !store.write(data)) {
+            warnFile << "Failed to write the tiles";
+            result = false;
+        }
+    };
+
+    for (int i = 0; i < tiles.size(); i += tilesPerBatch) {
+        if (jobs.size() >= maxJobsInFlight) {
+            writeFirstBatch();
+        }
+
+        const QVector<KisTileSP> batch = tiles.mid(i, tilesPerBatch);
+
+        jobs.append(QtConcurrent::run([batch] () {
+            // every job needs its own work buffers
+            KisTileCompressor2 compressor;
+            return compressor.compressTiles(batch);
+        }));
+    }
+
+    while (!jobs.isEmpty()) {
+        writeFirstBatch();
+    }
+
+    return result;
+}
+
+bool KisTileCompressor2::readTiles(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles)
+{
+    if (KisImageConfig(true).lazyLoadLayers()) {
+        return readTilesLazily(stream, dm, numTiles);
+    }
+
+    const int numThreads = QThread::idealThreadCount();
+
+    if (numThreads <= 1 || numTiles < 2 * tilesPerBatch) {
+        return KisAbstractTileCompressor::readTiles(stream, dm, numTiles);
+    }
+
+    /**
+     * The stream is read in the calling thread only, while the
+     * decompression of the tiles read so far runs in the global
+     * thread pool. The number of batches in flight is limited, so
+     * that the compressed data doesn't pile up in memory when the
+     * reading is faster than the decompression.
+     */
+    const int maxJobsInFlight = 2 * numThreads;
+
+    QList<QFuture<bool>> jobs;
+    QVector<CompressedTile> batch;
+    batch.reserve(tilesPerBatch);
+
+    bool result = true;
+
+    auto startBatch = [&] () {
+        if (jobs.size() >= maxJobsInFlight) {
+            result &= jobs.takeFirst().result();
+        }
+
+        jobs.append(QtConcurrent::run(decompressBatch, batch));
+        batch.clear();
+    };
+
+    for (quint32 i = 0; i < numTiles; i++) {
+        CompressedTile compressedTile;
+        qint32 dataSize = 0;
+
+        if (!readTileHeader(stream, dm, &compressedTile.tile, &dataSize)) {
+            result = false;
+            continue;
+        }
+
+        compressedTile.data = readTileData(stream, dataSize);
+        if (compressedTile.data.size() != dataSize) {
+            result = false;
+            continue;
+        }
+
+        /**
+         * A freshly created tile shares the default tile data. Detach
+         * it here, so that the copy-on-write and the registration in
+         * the memento manager happen in this thread only.
+         */
+        compressedTile.tile->lockForWrite();
+        compressedTile.tile->unlock();
+
+        batch.append(compressedTile);
+
+        if (batch.size() >= tilesPerBatch) {
+            startBatch();
+        }
+    }
+
+    if (!batch.isEmpty()) {
+        startBatch();
+    }
+
+    Q_FOREACH (QFuture<bool> job, jobs) {
+        result &= job.result();
+    }
+
+    return result;
+}
+
+bool KisTileCompressor2::readTilesLazily(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles)
+{
+    KisTileDataStore *store = KisTileDataStore::instance();
+    bool result = true;
+
+    for (quint32 i = 0; i < numTiles; i++) {
+        KisTileSP tile;
+        qint32 dataSize = 0;
+
+        if (!readTileHeader(stream, dm, &tile, &dataSize)) {
+            result = false;
+            continue;
+        }
+
+        const QByteArray data = readTileData(stream, dataSize);
+        if (data.size() != dataSize) {
+            result = false;
+            continue;
+        }
+
+        // detach the tile from the default tile data
+        tile->lockForWrite();
+        tile->unlock();
+
+        /**
+         * The format of the tiles in the file is the same as in the
+         * swap, so the data can be stored there as it is. When the
+         * swap is too full, just decompress the tile right now.
+         */
+        if (!store->trySwapCompressedTileData(tile->tileData(),
+                                              (const quint8*)data.constData(),
+                                              dataSize)) {
+
+            tile->lockForWrite();
+            result &= decompressTileData((quint8*)data.constData(), dataSize, tile->tileData());
+            tile->unlock();
+        }
+    }
+
+    return result;
+}
+
 void KisTileCompressor2::prepareStreamingBuffer(qint32 tileDataSize)
 {
     /**
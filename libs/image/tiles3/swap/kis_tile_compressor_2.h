@@ -30,7 +30,9 @@ public:
     ~KisTileCompressor2() override;
 
     bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) override;
+    bool writeTiles(const QVector<KisTileSP> &tiles, KisPaintDeviceWriter &store) override;
     bool readTile(QIODevice *io, KisTiledDataManager *dm) override;
+    bool readTiles(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles) override;
 
 
     void compressTileData(KisTileData *tileData,quint8 *buffer,
@@ -46,6 +48,34 @@ private:
 
     QString getHeader(KisTileSP tile, qint32 compressedSize);
 
+    /**
+     * Reads the header of the next tile and fetches the tile
+     * from \a dm. The tile data follows the header in the stream
+     */
+    bool readTileHeader(QIODevice *stream, KisTiledDataManager *dm,
+                        KisTileSP *tile, qint32 *dataSize);
+
+    /**
+     * Reads \a dataSize bytes of the tile data. When the \a stream
+     * is a buffer, e.g. a memory-mapped entry of the store, the data
+     * is not copied: the returned array points into the buffer and
+     * is valid while the buffer is alive.
+     */
+    static QByteArray readTileData(QIODevice *stream, qint32 dataSize);
+
+    /**
+     * Compresses \a tiles and returns their headers and data
+     * in the same format writeTile() writes them
+     */
+    QByteArray compressTiles(const QVector<KisTileSP> &tiles);
+
+    /**
+     * Reads the tiles without decompressing them. The compressed
+     * data is moved into the swap file and is decompressed on the
+     * first access to the tile.
+     */
+    bool readTilesLazily(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles);
+
     void prepareWorkBuffers(qint32 tileDataSize);
     void prepareStreamingBuffer(qint32 tileDataSize);
 
@@ -27,6 +27,7 @@
 #include "tiles_test_utils.h"
 
 #include "tiles3/kis_tile_data_store.h"
+#include "tiles3/swap/kis_tile_compressor_2.h"
 
 
 #define COLUMN2COLOR(col) (col%255)
@@ -131,5 +132,96 @@ void KisSwappedDataStoreTest::testRandomAccess()
         delete tileDataList[i];
 }
 
+void KisSwappedDataStoreTest::testCompressedRoundTrip()
+{
+    const qint32 pixelSize = 1;
+    const quint8 defaultPixel = 128;
+    const qint32 NUM_TILES = 1000;
+
+    KisImageConfig config(false);
+    config.setMaxSwapSize(4);
+    config.setSwapSlabSize(1);
+    config.setSwapWindowSize(1);
+
+    KisSwappedDataStore store;
+    KisTileCompressor2 compressor;
+
+    QList<KisTileData*> tileDataList;
+    for(qint32 i = 0; i < NUM_TILES; i++)
+        tileDataList.append(new KisTileData(pixelSize, &defaultPixel, KisTileDataStore::instance()));
+
+    QByteArray buffer;
+
+    for(qint32 i = 0; i < NUM_TILES; i++) {
+        KisTileData *td = tileDataList[i];
+
+        // the compressed data comes from another tile, like from a file
+        KisTileData source(pixelSize, &defaultPixel, KisTileDataStore::instance());
+        memset(source.data(), COLUMN2COLOR(i), TILESIZE);
+
+        buffer.resize(compressor.tileDataBufferSize(&source));
+        qint32 bytesWritten;
+        compressor.compressTileData(&source, (quint8*)buffer.data(), buffer.size(), bytesWritten);
+
+        QVERIFY(store.trySwapOutCompressedTileData(td, (quint8*)buffer.data(), bytesWritten));
+        QVERIFY(!td->data());
+    }
+
+    for(qint32 i = 0; i < NUM_TILES; i++) {
+        KisTileData *td = tileDataList[i];
+
+        store.swapInTileData(td);
+        QVERIFY(memoryIsFilled(COLUMN2COLOR(i), td->data(), TILESIZE));
+    }
+
+    for(qint32 i = 0; i < NUM_TILES; i++)
+        delete tileDataList[i];
+}
+
+void KisSwappedDataStoreTest::testCompressedSwapLimit()
+{
+    const qint32 pixelSize = 1;
+    const quint8 defaultPixel = 128;
+
+    KisImageConfig config(false);
+    config.setMaxSwapSize(1);
+    config.setSwapSlabSize(1);
+    config.setSwapWindowSize(1);
+
+    KisSwappedDataStore store;
+
+    // a raw tile of the maximum size, as if it didn't compress at all
+    QByteArray buffer(TILESIZE + 1, 0);
+
+    QList<KisTileData*> tileDataList;
+    bool limitReached = false;
+
+    for(qint32 i = 0; i < 1024 && !limitReached; i++) {
+        KisTileData *td = new KisTileData(pixelSize, &defaultPixel, KisTileDataStore::instance());
+        tileDataList.append(td);
+
+        if (!store.trySwapOutCompressedTileData(td, (quint8*)buffer.data(), buffer.size())) {
+            // the tile must be kept untouched
+            QVERIFY(td->data());
+            limitReached = true;
+        }
+    }
+
+    QVERIFY(limitReached);
+
+    // the regular swapping should still have some space to work with
+    KisTileData *td = tileDataList.last();
+    QVERIFY(store.trySwapOutTileData(td));
+    store.swapInTileData(td);
+    QVERIFY(memoryIsFilled(defaultPixel, td->data(), TILESIZE));
+
+    for(qint32 i = 0; i < tileDataList.size(); i++) {
+        if (!tileDataList[i]->data()) {
+            store.swapInTileData(tileDataList[i]);
+        }
+        delete tileDataList[i];
+    }
+}
+
 QTEST_MAIN(KisSwappedDataStoreTest)
 
@@ -33,6 +33,8 @@ private:
 private Q_SLOTS:
     void testRoundTrip();
     void testRandomAccess();
+    void testCompressedRoundTrip();
+    void testCompressedSwapLimit();
 
 };
 
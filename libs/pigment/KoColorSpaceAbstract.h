@@ -31,10 +31,82 @@
 #include "KoFallBackColorTransformation.h"
 #include "KoLabDarkenColorTransformation.h"
 #include "KoMixColorsOpImpl.h"
+#include "KoOptimizedMixColorsOpFactory.h"
+#include "KoOptimizedConvolutionOpFactory.h"
+#include "KoBgrColorSpaceTraits.h"
+#include "KoRgbColorSpaceTraits.h"
 
 #include "KoConvolutionOpImpl.h"
 #include "KoInvertColorTransformation.h"
 
+namespace _Private {
+
+template<class _CSTrait>
+struct OptimizedMixColorsOpSelector
+{
+    static KoMixColorsOp* create() {
+        return new KoMixColorsOpImpl<_CSTrait>();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoBgrU8Traits>
+{
+    static KoMixColorsOp* create() {
+        return KoOptimizedMixColorsOpFactory::createMixColorsOp32();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoBgrU16Traits>
+{
+    static KoMixColorsOp* create() {
+        return KoOptimizedMixColorsOpFactory::createMixColorsOp64();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoRgbF32Traits>
+{
+    static KoMixColorsOp* create() {
+        return KoOptimizedMixColorsOpFactory::createMixColorsOp128();
+    }
+};
+
+template<class _CSTrait>
+struct OptimizedConvolutionOpSelector
+{
+    static KoConvolutionOp* create() {
+        return new KoConvolutionOpImpl<_CSTrait>();
+    }
+};
+
+template<>
+struct OptimizedConvolutionOpSelector<KoBgrU8Traits>
+{
+    static KoConvolutionOp* create() {
+        return KoOptimizedConvolutionOpFactory::createConvolutionOp32();
+    }
+};
+
+template<>
+struct OptimizedConvolutionOpSelector<KoBgrU16Traits>
+{
+    static KoConvolutionOp* create() {
+        return KoOptimizedConvolutionOpFactory::createConvolutionOp64();
+    }
+};
+
+template<>
+struct OptimizedConvolutionOpSelector<KoRgbF32Traits>
+{
+    static KoConvolutionOp* create() {
+        return KoOptimizedConvolutionOpFactory::createConvolutionOp128();
+    }
+};
+
+}
+
 /**
  * This in an implementation of KoColorSpace which can be used as a base for colorspaces with as many
  * different channels of the same type.
@@ -50,7 +122,7 @@ class KoColorSpaceAbstract : public KoColorSpace
 {
 public:
     KoColorSpaceAbstract(const QString &id, const QString &name) :
-        KoColorSpace(id, name, new KoMixColorsOpImpl< _CSTrait>(), new KoConvolutionOpImpl< _CSTrait>()) {
+        KoColorSpace(id, name, _Private::OptimizedMixColorsOpSelector<_CSTrait>::create(), _Private::OptimizedConvolutionOpSelector<_CSTrait>::create()) {
     }
 
     quint32 colorChannelCount() const override {
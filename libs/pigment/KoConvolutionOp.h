@@ -48,6 +48,56 @@ public:
      *
      */
     virtual void convolveColors(const quint8* const* colors, const qreal* kernelValues, quint8 *dst, qreal factor, qreal offset, qint32 nColors, const QBitArray & channelFlags) const = 0;
+
+    /**
+     * The functions below are used for convolution with separable
+     * kernels. In such a case the 2D convolution is split into a
+     * horizontal and a vertical pass, which are done over planar
+     * buffers of qreal values:
+     *
+     * 1) splitIntoPlanes() converts a row of pixels into planes
+     * 2) convolveLine() does the horizontal pass over every plane
+     * 3) convolveAcrossLines() does the vertical pass
+     * 4) mergePlanes() converts the result back into pixels
+     *
+     * The math is exactly the same as the one used by
+     * KisConvolutionWorkerSpatial, so the two are interchangeable.
+     *
+     * All these functions are thread-safe.
+     */
+
+    /**
+     * Splits \p nPixels pixels into channel planes. Plane \c i starts
+     * at \p dst + i * \p planeStride. The values are stored in the
+     * native range of the channel type, color channels are
+     * premultiplied by the alpha channel.
+     */
+    virtual void splitIntoPlanes(const quint8 *src, qreal *dst, qint32 planeStride, qint32 nPixels) const = 0;
+
+    /**
+     * Convolves a contiguous line of values:
+     *
+     * dst[i] = sum(kernel[k] * src[i + k]), i = 0 ... nValues - 1
+     *
+     * \p src must contain nValues + kernelSize - 1 values.
+     */
+    virtual void convolveLine(const qreal *src, qreal *dst, qint32 nValues, const qreal *kernel, qint32 kernelSize) const = 0;
+
+    /**
+     * Convolves values across \p kernelSize lines:
+     *
+     * dst[i] = sum(kernel[k] * lines[k][i]), i = 0 ... nValues - 1
+     */
+    virtual void convolveAcrossLines(const qreal * const *lines, qreal *dst, qint32 nValues, const qreal *kernel, qint32 kernelSize) const = 0;
+
+    /**
+     * Merges the planes created by splitIntoPlanes() back into
+     * pixels. Every channel is multiplied by \p factor, color channels
+     * are divided by the resulting alpha value. Then \p offset (as a
+     * fraction of the channel range) is added and the values are
+     * clamped into the channel range.
+     */
+    virtual void mergePlanes(const qreal *src, qint32 planeStride, quint8 *dst, qint32 nPixels, qreal factor, qreal offset) const = 0;
 };
 
 #endif
@@ -26,6 +26,8 @@
 #include "KoConvolutionOp.h"
 #include "KoColorSpaceTraits.h"
 
+#include <limits>
+
 template<class _CSTrait>
 class KoConvolutionOpImpl : public KoConvolutionOp
 {
@@ -148,6 +150,95 @@ public:
         }
 
     }
+
+    void splitIntoPlanes(const quint8 *src, qreal *dst, qint32 planeStride, qint32 nPixels) const override {
+        for (qint32 i = 0; i < nPixels; i++) {
+            const channels_type *color = _CSTrait::nativeArray(src);
+            const qreal alpha = _CSTrait::alpha_pos >= 0 ? qreal(color[_CSTrait::alpha_pos]) : 1.0;
+
+            for (int ch = 0; ch < (int)_CSTrait::channels_nb; ch++) {
+                dst[ch * planeStride + i] =
+                    ch == _CSTrait::alpha_pos ? alpha : qreal(color[ch]) * alpha;
+            }
+
+            src += _CSTrait::pixelSize;
+        }
+    }
+
+    void convolveLine(const qreal *src, qreal *dst, qint32 nValues, const qreal *kernel, qint32 kernelSize) const override {
+        for (qint32 i = 0; i < nValues; i++) {
+            qreal sum = 0;
+            for (qint32 k = 0; k < kernelSize; k++) {
+                sum += kernel[k] * src[i + k];
+            }
+            dst[i] = sum;
+        }
+    }
+
+    void convolveAcrossLines(const qreal * const *lines, qreal *dst, qint32 nValues, const qreal *kernel, qint32 kernelSize) const override {
+        for (qint32 i = 0; i < nValues; i++) {
+            qreal sum = 0;
+            for (qint32 k = 0; k < kernelSize; k++) {
+                sum += kernel[k] * lines[k][i];
+            }
+            dst[i] = sum;
+        }
+    }
+
+    void mergePlanes(const qreal *src, qint32 planeStride, quint8 *dst, qint32 nPixels, qreal factor, qreal offset) const override {
+        const qreal minValue = KoColorSpaceMathsTraits<channels_type>::min;
+        const qreal maxValue = KoColorSpaceMathsTraits<channels_type>::max;
+        const qreal absoluteOffset = (maxValue - minValue) * offset;
+
+        for (qint32 i = 0; i < nPixels; i++) {
+            channels_type *dstColor = _CSTrait::nativeArray(dst);
+
+            if (_CSTrait::alpha_pos >= 0) {
+                qreal alpha = src[_CSTrait::alpha_pos * planeStride + i] * factor + absoluteOffset;
+                limitValue(&alpha, minValue, maxValue);
+                dstColor[_CSTrait::alpha_pos] = fromQreal(alpha);
+
+                if (alpha != 0.0) {
+                    const qreal alphaInv = 1.0 / alpha;
+
+                    for (int ch = 0; ch < (int)_CSTrait::channels_nb; ch++) {
+                        if (ch == _CSTrait::alpha_pos) continue;
+
+                        qreal value = (src[ch * planeStride + i] * factor) * alphaInv + absoluteOffset;
+                        limitValue(&value, minValue, maxValue);
+                        dstColor[ch] = fromQreal(value);
+                    }
+                } else {
+                    for (int ch = 0; ch < (int)_CSTrait::channels_nb; ch++) {
+                        if (ch == _CSTrait::alpha_pos) continue;
+                        dstColor[ch] = fromQreal(0.0);
+                    }
+                }
+            } else {
+                for (int ch = 0; ch < (int)_CSTrait::channels_nb; ch++) {
+                    qreal value = src[ch * planeStride + i] * factor + absoluteOffset;
+                    limitValue(&value, minValue, maxValue);
+                    dstColor[ch] = fromQreal(value);
+                }
+            }
+
+            dst += _CSTrait::pixelSize;
+        }
+    }
+
+private:
+    static inline void limitValue(qreal *value, qreal lowBound, qreal highBound) {
+        if (*value > highBound) {
+            *value = highBound;
+        } else if (!(*value >= lowBound)) {  // value < lowBound or value == NaN
+            *value = lowBound;
+        }
+    }
+
+    static inline channels_type fromQreal(qreal value) {
+        return std::numeric_limits<channels_type>::is_integer ?
+            channels_type(qRound64(value)) : channels_type(value);
+    }
 };
 
 #endif
@@ -76,6 +76,25 @@ public:
      */
     virtual void mixColors(const quint8 * const*colors, quint32 nColors, quint8 *dst) const = 0;
     virtual void mixColors(const quint8 *colors, quint32 nColors, quint8 *dst) const = 0;
+
+    /**
+     * Mix \p nGroups independent groups of colors in a single call. Every
+     * group consists of \p nColors pixels and is mixed exactly as
+     * mixColors(colors, weights, nColors, dst) would do it. The batched
+     * version lets the implementation process several groups at once,
+     * which is much faster for small groups (e.g. bilinear sampling).
+     *
+     * @param colors an array of nGroups * nColors pointers to the source
+     *               pixels, pointers of group \c i start at colors[i * nColors]
+     * @param weights an array of nGroups * nColors weights in the same
+     *                order as \p colors (the sum of weights of every group
+     *                should be equal to 255)
+     * @param nColors the number of pixels in every group
+     * @param nGroups the number of groups
+     * @param dst the destination buffer, contains nGroups pixels stored
+     *            one after another
+     */
+    virtual void mixColorsBatch(const quint8 * const*colors, const qint16 *weights, quint32 nColors, quint32 nGroups, quint8 *dst) const = 0;
 };
 
 #endif
@@ -46,6 +46,15 @@ public:
         mixColorsImpl(PointerToArray(colors, _CSTrait::pixelSize), NoWeightsSurrogate(nColors), nColors, dst);
     }
 
+    void mixColorsBatch(const quint8 * const* colors, const qint16 *weights, quint32 nColors, quint32 nGroups, quint8 *dst) const override {
+        for (quint32 i = 0; i < nGroups; i++) {
+            mixColorsImpl(ArrayOfPointers(colors), WeightsWrapper(weights), nColors, dst);
+            colors += nColors;
+            weights += nColors;
+            dst += _CSTrait::pixelSize;
+        }
+    }
+
 private:
     struct ArrayOfPointers {
         ArrayOfPointers(const quint8 * const* colors)
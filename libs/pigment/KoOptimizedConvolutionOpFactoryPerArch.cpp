@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#if !defined _MSC_VER
+#pragma GCC diagnostic ignored "-Wundef"
+#endif
+
+#include "KoOptimizedConvolutionOpFactoryPerArch.h"
+#include "KoOptimizedConvolutionOpImpl.h"
+
+#include "KoBgrColorSpaceTraits.h"
+#include "KoRgbColorSpaceTraits.h"
+
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wlocal-type-template-args"
+#endif
+
+template<>
+template<>
+KoOptimizedConvolutionOpFactoryPerArch<KoBgrU8Traits>::ReturnType
+KoOptimizedConvolutionOpFactoryPerArch<KoBgrU8Traits>::create<Vc::CurrentImplementation::current()>(ParamType)
+{
+    return new KoOptimizedConvolutionOpImpl<Vc::CurrentImplementation::current(), KoBgrU8Traits>();
+}
+
+template<>
+template<>
+KoOptimizedConvolutionOpFactoryPerArch<KoBgrU16Traits>::ReturnType
+KoOptimizedConvolutionOpFactoryPerArch<KoBgrU16Traits>::create<Vc::CurrentImplementation::current()>(ParamType)
+{
+    return new KoOptimizedConvolutionOpImpl<Vc::CurrentImplementation::current(), KoBgrU16Traits>();
+}
+
+template<>
+template<>
+KoOptimizedConvolutionOpFactoryPerArch<KoRgbF32Traits>::ReturnType
+KoOptimizedConvolutionOpFactoryPerArch<KoRgbF32Traits>::create<Vc::CurrentImplementation::current()>(ParamType)
+{
+    return new KoOptimizedConvolutionOpImpl<Vc::CurrentImplementation::current(), KoRgbF32Traits>();
+}
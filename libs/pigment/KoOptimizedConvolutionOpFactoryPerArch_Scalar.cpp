@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoOptimizedConvolutionOpFactoryPerArch.h"
+
+#include "KoBgrColorSpaceTraits.h"
+#include "KoRgbColorSpaceTraits.h"
+#include "KoConvolutionOpImpl.h"
+
+
+template<>
+template<>
+KoOptimizedConvolutionOpFactoryPerArch<KoBgrU8Traits>::ReturnType
+KoOptimizedConvolutionOpFactoryPerArch<KoBgrU8Traits>::create<Vc::ScalarImpl>(ParamType)
+{
+    return new KoConvolutionOpImpl<KoBgrU8Traits>();
+}
+
+template<>
+template<>
+KoOptimizedConvolutionOpFactoryPerArch<KoBgrU16Traits>::ReturnType
+KoOptimizedConvolutionOpFactoryPerArch<KoBgrU16Traits>::create<Vc::ScalarImpl>(ParamType)
+{
+    return new KoConvolutionOpImpl<KoBgrU16Traits>();
+}
+
+template<>
+template<>
+KoOptimizedConvolutionOpFactoryPerArch<KoRgbF32Traits>::ReturnType
+KoOptimizedConvolutionOpFactoryPerArch<KoRgbF32Traits>::create<Vc::ScalarImpl>(ParamType)
+{
+    return new KoConvolutionOpImpl<KoRgbF32Traits>();
+}
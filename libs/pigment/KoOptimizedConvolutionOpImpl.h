@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCONVOLUTIONOPIMPL_H
+#define KOOPTIMIZEDCONVOLUTIONOPIMPL_H
+
+#include <KoCompositeOp.h>
+#include "KoColorSpaceMaths.h"
+#include "KoStreamedMath.h"
+#include "KoConvolutionOpImpl.h"
+
+
+/**
+ * A version of KoConvolutionOpImpl with vectorized 1D convolution
+ * passes, which are used for separable kernels. The lanes of the
+ * vector process neighbouring values of the line, and every lane
+ * sums up the kernel values in the same order as the scalar version
+ * does, so the results are exactly the same.
+ */
+template<Vc::Implementation _impl, class _CSTrait>
+class KoOptimizedConvolutionOpImpl : public KoConvolutionOpImpl<_CSTrait>
+{
+    typedef Vc::double_v vector_type;
+    static constexpr int vectorSize = vector_type::size();
+
+public:
+    void convolveLine(const qreal *src, qreal *dst, qint32 nValues, const qreal *kernel, qint32 kernelSize) const override {
+        const qint32 vectorBlocks = nValues / vectorSize;
+
+        for (qint32 block = 0; block < vectorBlocks; block++) {
+            vector_type sum(Vc::Zero);
+
+            for (qint32 k = 0; k < kernelSize; k++) {
+                sum += kernel[k] * vector_type(src + k, Vc::Unaligned);
+            }
+
+            sum.store(dst, Vc::Unaligned);
+
+            src += vectorSize;
+            dst += vectorSize;
+        }
+
+        KoConvolutionOpImpl<_CSTrait>::convolveLine(src, dst, nValues - vectorBlocks * vectorSize, kernel, kernelSize);
+    }
+
+    void convolveAcrossLines(const qreal * const *lines, qreal *dst, qint32 nValues, const qreal *kernel, qint32 kernelSize) const override {
+        const qint32 vectorBlocks = nValues / vectorSize;
+
+        for (qint32 block = 0; block < vectorBlocks; block++) {
+            const qint32 offset = block * vectorSize;
+            vector_type sum(Vc::Zero);
+
+            for (qint32 k = 0; k < kernelSize; k++) {
+                sum += kernel[k] * vector_type(lines[k] + offset, Vc::Unaligned);
+            }
+
+            sum.store(dst + offset, Vc::Unaligned);
+        }
+
+        const qint32 restOffset = vectorBlocks * vectorSize;
+        for (qint32 i = restOffset; i < nValues; i++) {
+            qreal sum = 0;
+            for (qint32 k = 0; k < kernelSize; k++) {
+                sum += kernel[k] * lines[k][i];
+            }
+            dst[i] = sum;
+        }
+    }
+};
+
+#endif // KOOPTIMIZEDCONVOLUTIONOPIMPL_H
@@ -0,0 +1,45 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDMIXCOLORSOPFACTORY_H
+#define KOOPTIMIZEDMIXCOLORSOPFACTORY_H
+
+#include "kritapigment_export.h"
+
+class KoMixColorsOp;
+
+/**
+ * Creates vectorized versions of KoMixColorsOp for RGBA color spaces.
+ * The creation is moved into a separate object module for the same
+ * reasons as it is done in KoOptimizedCompositeOpFactory.
+ */
+class KRITAPIGMENT_EXPORT KoOptimizedMixColorsOpFactory
+{
+public:
+    /// RGBA, 8-bit per channel (KoBgrU8Traits)
+    static KoMixColorsOp* createMixColorsOp32();
+
+    /// RGBA, 16-bit per channel (KoBgrU16Traits)
+    static KoMixColorsOp* createMixColorsOp64();
+
+    /// RGBA, 32-bit float per channel (KoRgbF32Traits)
+    static KoMixColorsOp* createMixColorsOp128();
+};
+
+#endif /* KOOPTIMIZEDMIXCOLORSOPFACTORY_H */
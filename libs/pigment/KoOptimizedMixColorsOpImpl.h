@@ -0,0 +1,388 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDMIXCOLORSOPIMPL_H
+#define KOOPTIMIZEDMIXCOLORSOPIMPL_H
+
+#include <KoCompositeOp.h>
+#include "KoColorSpaceMaths.h"
+#include "KoStreamedMath.h"
+#include "KoMixColorsOp.h"
+
+#include <string.h>
+#include <type_traits>
+
+
+/**
+ * Defines the type of the SIMD accumulator used for mixing
+ * the colors with channels of type \p channels_type.
+ *
+ * The accumulators are chosen in a way to produce exactly the same
+ * results as the scalar KoMixColorsOpImpl does:
+ *
+ * 1) 8-bit channels: color * alpha * weight always fits into a 32-bit
+ *    integer, so we can use integer vectors (exactly as the scalar
+ *    version does with qint32)
+ *
+ * 2) 16-bit channels: the product doesn't fit 32 bits, but it is still
+ *    representable by a double without any loss of precision, so
+ *    double-vectors work as a replacement for qint64
+ *
+ * 3) 32-bit float channels: the scalar version uses double, so do we.
+ *    The products are exact, but the sums are rounded, so they must be
+ *    added in the same order as the scalar version does, see
+ *    accumulateVectorInOrder()
+ */
+template<typename channels_type, Vc::Implementation _impl>
+struct KoMixColorsAccumulatorTraits;
+
+template<Vc::Implementation _impl>
+struct KoMixColorsAccumulatorTraits<quint8, _impl>
+{
+    typedef Vc::SimdArray<int, Vc::float_v::size()> vector_type;
+};
+
+template<Vc::Implementation _impl>
+struct KoMixColorsAccumulatorTraits<quint16, _impl>
+{
+    typedef Vc::double_v vector_type;
+};
+
+template<Vc::Implementation _impl>
+struct KoMixColorsAccumulatorTraits<float, _impl>
+{
+    typedef Vc::double_v vector_type;
+};
+
+
+/**
+ * A vectorized version of KoMixColorsOpImpl. It is used for the most
+ * popular RGBA color spaces (8-bit, 16-bit and 32-bit float).
+ *
+ * There are two vectorization strategies used:
+ *
+ * 1) When mixing a single group of colors (mixColors()), the vector
+ *    lanes process different source pixels of the group. For integer
+ *    channels the lanes are summed up horizontally in the end, for
+ *    floating point ones they are added to scalar totals pixel by pixel.
+ *
+ * 2) When mixing a batch of groups (mixColorsBatch()), every lane
+ *    processes its own group. That is much more efficient for small
+ *    groups, like the ones used for bilinear interpolation.
+ */
+template<Vc::Implementation _impl, class _CSTrait>
+class KoOptimizedMixColorsOpImpl : public KoMixColorsOp
+{
+    typedef typename _CSTrait::channels_type channels_type;
+    typedef typename KoColorSpaceMathsTraits<channels_type>::compositetype compositetype;
+    typedef typename KoMixColorsAccumulatorTraits<channels_type, _impl>::vector_type vector_type;
+    typedef typename vector_type::EntryType entry_type;
+
+    static const int channels_nb = _CSTrait::channels_nb;
+    static const int alpha_pos = _CSTrait::alpha_pos;
+    static constexpr int vectorSize = vector_type::size();
+
+public:
+    void mixColors(const quint8 * const* colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(ArrayOfPointers(colors), WeightsWrapper(weights), nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(PointerToArray(colors, _CSTrait::pixelSize), WeightsWrapper(weights), nColors, dst);
+    }
+
+    void mixColors(const quint8 * const* colors, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(ArrayOfPointers(colors), NoWeightsSurrogate(nColors), nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(PointerToArray(colors, _CSTrait::pixelSize), NoWeightsSurrogate(nColors), nColors, dst);
+    }
+
+    void mixColorsBatch(const quint8 * const* colors, const qint16 *weights, quint32 nColors, quint32 nGroups, quint8 *dst) const override {
+        entry_type channelsBuffer[channels_nb][vectorSize];
+        entry_type weightsBuffer[vectorSize];
+
+        vector_type totals[channels_nb];
+        compositetype scalarTotals[channels_nb];
+
+        while (nGroups) {
+            const int groupsInBlock = qMin(nGroups, quint32(vectorSize));
+
+            for (int ch = 0; ch < channels_nb; ch++) {
+                totals[ch].setZero();
+            }
+
+            for (quint32 k = 0; k < nColors; k++) {
+                for (int lane = 0; lane < vectorSize; lane++) {
+                    if (lane < groupsInBlock) {
+                        const channels_type *color =
+                            _CSTrait::nativeArray(colors[lane * nColors + k]);
+
+                        for (int ch = 0; ch < channels_nb; ch++) {
+                            channelsBuffer[ch][lane] = color[ch];
+                        }
+                        weightsBuffer[lane] = weights[lane * nColors + k];
+                    } else {
+                        for (int ch = 0; ch < channels_nb; ch++) {
+                            channelsBuffer[ch][lane] = 0;
+                        }
+                        weightsBuffer[lane] = 0;
+                    }
+                }
+
+                accumulateVector(channelsBuffer, weightsBuffer, totals);
+            }
+
+            for (int lane = 0; lane < groupsInBlock; lane++) {
+                for (int ch = 0; ch < channels_nb; ch++) {
+                    scalarTotals[ch] = compositetype(totals[ch][lane]);
+                }
+                writeMixedColor(scalarTotals, 255, dst);
+                dst += _CSTrait::pixelSize;
+            }
+
+            colors += groupsInBlock * nColors;
+            weights += groupsInBlock * nColors;
+            nGroups -= groupsInBlock;
+        }
+    }
+
+private:
+    struct ArrayOfPointers {
+        ArrayOfPointers(const quint8 * const* colors)
+            : m_colors(colors)
+        {
+        }
+
+        const quint8* getPixel() const {
+            return *m_colors;
+        }
+
+        void nextPixel() {
+            m_colors++;
+        }
+
+    private:
+        const quint8 * const * m_colors;
+    };
+
+    struct PointerToArray {
+        PointerToArray(const quint8 *colors, int pixelSize)
+            : m_colors(colors),
+              m_pixelSize(pixelSize)
+        {
+        }
+
+        const quint8* getPixel() const {
+            return m_colors;
+        }
+
+        void nextPixel() {
+            m_colors += m_pixelSize;
+        }
+
+    private:
+        const quint8 *m_colors;
+        const int m_pixelSize;
+    };
+
+    struct WeightsWrapper
+    {
+        WeightsWrapper(const qint16 *weights)
+            : m_weights(weights)
+        {
+        }
+
+        inline void nextPixel() {
+            m_weights++;
+        }
+
+        inline qint16 weight() const {
+            return *m_weights;
+        }
+
+        inline int normalizeFactor() const {
+            return 255;
+        }
+
+    private:
+        const qint16 *m_weights;
+    };
+
+    struct NoWeightsSurrogate
+    {
+        NoWeightsSurrogate(int numPixels)
+            : m_numPixles(numPixels)
+        {
+        }
+
+        inline void nextPixel() {
+        }
+
+        inline qint16 weight() const {
+            return 1;
+        }
+
+        inline int normalizeFactor() const {
+            return m_numPixles;
+        }
+
+    private:
+        const int m_numPixles;
+    };
+
+    /**
+     * Accumulates one vector of pixels. The pixels are stored in
+     * \p channelsBuffer in planar form: channel by channel. The alpha
+     * accumulator is stored in totals[alpha_pos].
+     */
+    static ALWAYS_INLINE void accumulateVector(const entry_type channelsBuffer[][vectorSize], const entry_type *weights, vector_type *totals) {
+        const vector_type alphaTimesWeight =
+            vector_type(channelsBuffer[alpha_pos], Vc::Unaligned) *
+            vector_type(weights, Vc::Unaligned);
+
+        for (int ch = 0; ch < channels_nb; ch++) {
+            if (ch != alpha_pos) {
+                totals[ch] += vector_type(channelsBuffer[ch], Vc::Unaligned) * alphaTimesWeight;
+            }
+        }
+
+        totals[alpha_pos] += alphaTimesWeight;
+    }
+
+    /**
+     * Same as accumulateVector(), but adds the lanes to scalar \p totals
+     * one by one. Floating point addition is not associative, so summing
+     * the lanes separately would round differently from the scalar
+     * KoMixColorsOpImpl, which adds the pixels in order.
+     */
+    static ALWAYS_INLINE void accumulateVectorInOrder(const entry_type channelsBuffer[][vectorSize], const entry_type *weights, int numLanes, compositetype *totals) {
+        const vector_type alphaTimesWeight =
+            vector_type(channelsBuffer[alpha_pos], Vc::Unaligned) *
+            vector_type(weights, Vc::Unaligned);
+
+        for (int ch = 0; ch < channels_nb; ch++) {
+            if (ch != alpha_pos) {
+                const vector_type products = vector_type(channelsBuffer[ch], Vc::Unaligned) * alphaTimesWeight;
+
+                for (int lane = 0; lane < numLanes; lane++) {
+                    totals[ch] += products[lane];
+                }
+            }
+        }
+
+        for (int lane = 0; lane < numLanes; lane++) {
+            totals[alpha_pos] += alphaTimesWeight[lane];
+        }
+    }
+
+    /**
+     * Does the final normalization of the accumulated values and writes
+     * the result into \p dst. Exactly repeats the math of
+     * KoMixColorsOpImpl.
+     */
+    static void writeMixedColor(compositetype *totals, const int sumOfWeights, quint8 *dst) {
+        compositetype totalAlpha = totals[alpha_pos];
+
+        if (totalAlpha > KoColorSpaceMathsTraits<channels_type>::unitValue * sumOfWeights) {
+            totalAlpha = KoColorSpaceMathsTraits<channels_type>::unitValue * sumOfWeights;
+        }
+
+        channels_type* dstColor = _CSTrait::nativeArray(dst);
+
+        if (totalAlpha > 0) {
+
+            for (int i = 0; i < channels_nb; i++) {
+                if (i != alpha_pos) {
+
+                    compositetype v = totals[i] / totalAlpha;
+
+                    if (v > KoColorSpaceMathsTraits<channels_type>::max) {
+                        v = KoColorSpaceMathsTraits<channels_type>::max;
+                    }
+                    if (v < KoColorSpaceMathsTraits<channels_type>::min) {
+                        v = KoColorSpaceMathsTraits<channels_type>::min;
+                    }
+                    dstColor[ i ] = v;
+                }
+            }
+
+            dstColor[ alpha_pos ] = totalAlpha / sumOfWeights;
+        } else {
+            memset(dst, 0, sizeof(channels_type) * channels_nb);
+        }
+    }
+
+    template<class AbstractSource, class WeightsWrapper>
+    void mixColorsImpl(AbstractSource source, WeightsWrapper weightsWrapper, quint32 nColors, quint8 *dst) const {
+        entry_type channelsBuffer[channels_nb][vectorSize];
+        entry_type weightsBuffer[vectorSize];
+
+        const bool sumLanesInOrder = std::is_floating_point<channels_type>::value;
+
+        vector_type totals[channels_nb];
+        compositetype scalarTotals[channels_nb];
+
+        for (int ch = 0; ch < channels_nb; ch++) {
+            totals[ch].setZero();
+            scalarTotals[ch] = 0;
+        }
+
+        while (nColors) {
+            const int colorsInBlock = qMin(nColors, quint32(vectorSize));
+
+            for (int lane = 0; lane < vectorSize; lane++) {
+                if (lane < colorsInBlock) {
+                    const channels_type *color = _CSTrait::nativeArray(source.getPixel());
+
+                    for (int ch = 0; ch < channels_nb; ch++) {
+                        channelsBuffer[ch][lane] = color[ch];
+                    }
+                    weightsBuffer[lane] = weightsWrapper.weight();
+
+                    source.nextPixel();
+                    weightsWrapper.nextPixel();
+                } else {
+                    for (int ch = 0; ch < channels_nb; ch++) {
+                        channelsBuffer[ch][lane] = 0;
+                    }
+                    weightsBuffer[lane] = 0;
+                }
+            }
+
+            if (sumLanesInOrder) {
+                accumulateVectorInOrder(channelsBuffer, weightsBuffer, colorsInBlock, scalarTotals);
+            } else {
+                accumulateVector(channelsBuffer, weightsBuffer, totals);
+            }
+            nColors -= colorsInBlock;
+        }
+
+        if (!sumLanesInOrder) {
+            for (int ch = 0; ch < channels_nb; ch++) {
+                scalarTotals[ch] = compositetype(totals[ch].sum());
+            }
+        }
+
+        writeMixedColor(scalarTotals, weightsWrapper.normalizeFactor(), dst);
+    }
+};
+
+#endif // KOOPTIMIZEDMIXCOLORSOPIMPL_H
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoMixColorsOpBenchmark.h"
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoMixColorsOp.h>
+
+#include <QTest>
+#include <QVector>
+#include <QColor>
+
+const int NUM_GROUPS = 4096;
+const int NUM_ITERATIONS = 64;
+
+static const KoColorSpace* colorSpaceForDepth(const QString &depthId)
+{
+    return KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), depthId, "");
+}
+
+static void prepareData(const KoColorSpace *cs, int numColors,
+                        QVector<quint8> *pixels,
+                        QVector<const quint8*> *pixelPtrs,
+                        QVector<qint16> *weights)
+{
+    const int pixelSize = cs->pixelSize();
+    const int numPixels = NUM_GROUPS * numColors;
+
+    pixels->resize(numPixels * pixelSize);
+    pixelPtrs->resize(numPixels);
+    weights->resize(numPixels);
+
+    qsrand(1);
+
+    for (int i = 0; i < numPixels; i++) {
+        QColor color(qrand() % 256, qrand() % 256, qrand() % 256, qrand() % 256);
+        cs->fromQColor(color, pixels->data() + i * pixelSize);
+        (*pixelPtrs)[i] = pixels->constData() + i * pixelSize;
+        (*weights)[i] = 255 / numColors;
+    }
+
+    for (int i = 0; i < NUM_GROUPS; i++) {
+        (*weights)[i * numColors] += 255 % numColors;
+    }
+}
+
+static void addDataRows()
+{
+    QTest::addColumn<QString>("depthId");
+    QTest::addColumn<int>("numColors");
+
+    QList<KoID> depths;
+    depths << Integer8BitsColorDepthID << Integer16BitsColorDepthID << Float32BitsColorDepthID;
+
+    Q_FOREACH (const KoID &depth, depths) {
+        QTest::newRow(QString("%1, bilinear (4 colors)").arg(depth.id()).toLatin1()) << depth.id() << 4;
+        QTest::newRow(QString("%1, bicubic (16 colors)").arg(depth.id()).toLatin1()) << depth.id() << 16;
+        QTest::newRow(QString("%1, smudge (64 colors)").arg(depth.id()).toLatin1()) << depth.id() << 64;
+    }
+}
+
+void KoMixColorsOpBenchmark::benchmarkMixColors_data()
+{
+    addDataRows();
+}
+
+void KoMixColorsOpBenchmark::benchmarkMixColors()
+{
+    QFETCH(QString, depthId);
+    QFETCH(int, numColors);
+
+    const KoColorSpace *cs = colorSpaceForDepth(depthId);
+    QVERIFY(cs);
+
+    QVector<quint8> pixels;
+    QVector<const quint8*> pixelPtrs;
+    QVector<qint16> weights;
+    prepareData(cs, numColors, &pixels, &pixelPtrs, &weights);
+
+    QVector<quint8> dst(NUM_GROUPS * cs->pixelSize());
+    KoMixColorsOp *op = cs->mixColorsOp();
+
+    QBENCHMARK {
+        for (int j = 0; j < NUM_ITERATIONS; j++) {
+            for (int i = 0; i < NUM_GROUPS; i++) {
+                op->mixColors(pixelPtrs.constData() + i * numColors,
+                              weights.constData() + i * numColors,
+                              numColors,
+                              dst.data() + i * cs->pixelSize());
+            }
+        }
+    }
+}
+
+void KoMixColorsOpBenchmark::benchmarkMixColorsBatch_data()
+{
+    addDataRows();
+}
+
+void KoMixColorsOpBenchmark::benchmarkMixColorsBatch()
+{
+    QFETCH(QString, depthId);
+    QFETCH(int, numColors);
+
+    const KoColorSpace *cs = colorSpaceForDepth(depthId);
+    QVERIFY(cs);
+
+    QVector<quint8> pixels;
+    QVector<const quint8*> pixelPtrs;
+    QVector<qint16> weights;
+    prepareData(cs, numColors, &pixels, &pixelPtrs, &weights);
+
+    QVector<quint8> dst(NUM_GROUPS * cs->pixelSize());
+    KoMixColorsOp *op = cs->mixColorsOp();
+
+    QBENCHMARK {
+        for (int j = 0; j < NUM_ITERATIONS; j++) {
+            op->mixColorsBatch(pixelPtrs.constData(), weights.constData(),
+                               numColors, NUM_GROUPS, dst.data());
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(KoMixColorsOpBenchmark)
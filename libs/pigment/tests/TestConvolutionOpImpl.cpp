@@ -24,6 +24,9 @@
 #include "../KoColorSpaceAbstract.h"
 #include "../KoColorSpaceTraits.h"
 #include "../DebugPigment.h"
+#include "../KoOptimizedConvolutionOpFactory.h"
+
+#include <QScopedPointer>
 
 void TestConvolutionOpImpl::testConvolutionOpImpl()
 {
@@ -217,5 +220,101 @@ void TestConvolutionOpImpl::testOneFullyTransparent()
     }
 }
 
+void TestConvolutionOpImpl::testSeparablePlanes()
+{
+    KoConvolutionOpImpl<KoBgrU16Traits> op;
+
+    const int numPixels = 4;
+    quint16 src[numPixels * 4] = {
+        100, 200, 300, 0xFFFF,
+        50, 150, 0, 0x00FF,
+        100, 300, 50, 0x0000,
+        1000, 2000, 3000, 0x8000
+    };
+
+    const int planeStride = numPixels + 2;
+    qreal planes[4 * planeStride];
+    op.splitIntoPlanes(reinterpret_cast<quint8*>(src), planes, planeStride, numPixels);
+
+    // colors are premultiplied, alpha is stored as is
+    QCOMPARE(planes[0], 100.0 * 0xFFFF);
+    QCOMPARE(planes[planeStride + 1], 150.0 * 0x00FF);
+    QCOMPARE(planes[2 * planeStride + 2], 0.0);
+    QCOMPARE(planes[3 * planeStride + 3], qreal(0x8000));
+
+    // identity kernel must give the original pixels back
+    const qreal identityKernel[] = {0.0, 1.0, 0.0};
+    qreal convolved[4 * numPixels];
+    qreal extendedPlanes[4 * planeStride];
+
+    for (int ch = 0; ch < 4; ch++) {
+        extendedPlanes[ch * planeStride] = 0.0;
+        memcpy(extendedPlanes + ch * planeStride + 1, planes + ch * planeStride, numPixels * sizeof(qreal));
+        extendedPlanes[ch * planeStride + numPixels + 1] = 0.0;
+
+        op.convolveLine(extendedPlanes + ch * planeStride, convolved + ch * numPixels, numPixels, identityKernel, 3);
+    }
+
+    quint16 dst[numPixels * 4];
+    op.mergePlanes(convolved, numPixels, reinterpret_cast<quint8*>(dst), numPixels, 1.0, 0.0);
+
+    for (int i = 0; i < numPixels * 4; i++) {
+        // fully transparent pixels lose their color
+        const quint16 expected = i >= 8 && i < 11 ? 0 : src[i];
+        QCOMPARE(dst[i], expected);
+    }
+
+    // the factor is applied to all the channels
+    op.mergePlanes(convolved, numPixels, reinterpret_cast<quint8*>(dst), numPixels, 0.5, 0.0);
+    QCOMPARE(dst[12], quint16(1000));
+    QCOMPARE(dst[13], quint16(2000));
+    QCOMPARE(dst[14], quint16(3000));
+    QCOMPARE(dst[15], quint16(0x4000));
+
+    // the offset is added after unpremultiplying the colors
+    op.mergePlanes(convolved, numPixels, reinterpret_cast<quint8*>(dst), numPixels, 1.0, 100.0 / 0xFFFF);
+    QCOMPARE(dst[12], quint16(1097));
+    QCOMPARE(dst[13], quint16(2094));
+    QCOMPARE(dst[14], quint16(3091));
+    QCOMPARE(dst[15], quint16(0x8000 + 100));
+}
+
+void TestConvolutionOpImpl::testOptimizedSeparableLines()
+{
+    KoConvolutionOpImpl<KoBgrU16Traits> referenceOp;
+    QScopedPointer<KoConvolutionOp> op(KoOptimizedConvolutionOpFactory::createConvolutionOp64());
+
+    const int kernelSize = 7;
+    const int numLines = kernelSize;
+    const qreal kernel[kernelSize] = {0.05, -0.1, 0.25, 0.6, 0.25, -0.1, 0.05};
+
+    // odd number of values to check the tail processing
+    const int numValues = 37;
+    const int srcSize = numValues + kernelSize - 1;
+
+    QVector<qreal> src(srcSize * numLines);
+    for (int i = 0; i < src.size(); i++) {
+        src[i] = qreal((i * 7919) % 65536) * (i % 3 ? 1.0 : 0.37);
+    }
+
+    QVector<qreal> referenceDst(numValues);
+    QVector<qreal> dst(numValues);
+
+    for (int line = 0; line < numLines; line++) {
+        referenceOp.convolveLine(src.constData() + line * srcSize, referenceDst.data(), numValues, kernel, kernelSize);
+        op->convolveLine(src.constData() + line * srcSize, dst.data(), numValues, kernel, kernelSize);
+        QCOMPARE(dst, referenceDst);
+    }
+
+    const qreal *lines[numLines];
+    for (int line = 0; line < numLines; line++) {
+        lines[line] = src.constData() + line * srcSize;
+    }
+
+    referenceOp.convolveAcrossLines(lines, referenceDst.data(), numValues, kernel, kernelSize);
+    op->convolveAcrossLines(lines, dst.data(), numValues, kernel, kernelSize);
+    QCOMPARE(dst, referenceDst);
+}
+
 
 QTEST_GUILESS_MAIN(TestConvolutionOpImpl)
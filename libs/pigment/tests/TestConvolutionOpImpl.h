@@ -29,6 +29,8 @@ private Q_SLOTS:
     void testConvolutionOpImpl();
     void testOneSemiTransparent();
     void testOneFullyTransparent();
+    void testSeparablePlanes();
+    void testOptimizedSeparableLines();
 };
 
 #endif
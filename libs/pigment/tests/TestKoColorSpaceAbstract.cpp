@@ -2,10 +2,13 @@
 
 #include "KoColorSpaceAbstract.h"
 #include "KoColorSpaceTraits.h"
+#include "KoOptimizedMixColorsOpFactory.h"
 
 #include <cfloat>
+#include <type_traits>
 
 #include <QTest>
+#include <QScopedPointer>
 
 template <class T>
 T mixOpExpectedAlpha(T alpha1, T alpha2, const qint16 *weights)
@@ -385,5 +388,75 @@ void TestKoColorSpaceAbstract::testMixColorsOpU8NoAlphaLinear()
     QCOMPARE(outputPixel[COLOR_CHANNEL_2], mixOpNoAlphaExpectedColor(pixel1[COLOR_CHANNEL_2], pixel2[COLOR_CHANNEL_2], weights));
 }
 
+template <class Traits>
+void checkOptimizedMixColorsOp(KoMixColorsOp *optimizedOp)
+{
+    typedef typename Traits::channels_type channels_type;
+
+    QScopedPointer<KoMixColorsOp> op(optimizedOp);
+    KoMixColorsOpImpl<Traits> referenceOp;
+
+    const int numGroups = 37;
+    const int numColors = 4;
+    const int numPixels = numGroups * numColors;
+
+    QVector<channels_type> pixels(numPixels * Traits::channels_nb);
+    QVector<const quint8*> pixelPtrs(numPixels);
+    QVector<qint16> weights(numPixels);
+
+    qsrand(1);
+
+    for (int i = 0; i < numPixels; i++) {
+        for (int ch = 0; ch < (int)Traits::channels_nb; ch++) {
+            // floating point channels get values with all the mantissa
+            // bits set, so that the sums are rounded on every step
+            const qreal value = std::is_floating_point<channels_type>::value ?
+                qreal(qrand()) / RAND_MAX : qreal(qrand() % 256) / 255.0;
+            pixels[i * Traits::channels_nb + ch] =
+                value * KoColorSpaceMathsTraits<channels_type>::unitValue;
+        }
+        pixelPtrs[i] = reinterpret_cast<const quint8*>(&pixels[i * Traits::channels_nb]);
+    }
+
+    for (int i = 0; i < numGroups; i++) {
+        int restWeight = 255;
+        for (int j = 0; j < numColors - 1; j++) {
+            weights[i * numColors + j] = qrand() % (restWeight + 1);
+            restWeight -= weights[i * numColors + j];
+        }
+        weights[i * numColors + numColors - 1] = restWeight;
+    }
+
+    QVector<quint8> expected(numGroups * Traits::pixelSize);
+    QVector<quint8> result(numGroups * Traits::pixelSize);
+
+    // weighted mixing, group by group
+    for (int i = 0; i < numGroups; i++) {
+        referenceOp.mixColors(pixelPtrs.constData() + i * numColors, weights.constData() + i * numColors,
+                              numColors, expected.data() + i * Traits::pixelSize);
+        op->mixColors(pixelPtrs.constData() + i * numColors, weights.constData() + i * numColors,
+                      numColors, result.data() + i * Traits::pixelSize);
+    }
+    QCOMPARE(result, expected);
+
+    // batched mixing
+    result.fill(0);
+    op->mixColorsBatch(pixelPtrs.constData(), weights.constData(), numColors, numGroups, result.data());
+    QCOMPARE(result, expected);
+
+    // uniform mixing of all the pixels at once
+    referenceOp.mixColors(reinterpret_cast<const quint8*>(pixels.constData()), numPixels, expected.data());
+    op->mixColors(reinterpret_cast<const quint8*>(pixels.constData()), numPixels, result.data());
+    QCOMPARE(QByteArray((const char*)result.constData(), Traits::pixelSize),
+             QByteArray((const char*)expected.constData(), Traits::pixelSize));
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOp()
+{
+    checkOptimizedMixColorsOp<KoBgrU8Traits>(KoOptimizedMixColorsOpFactory::createMixColorsOp32());
+    checkOptimizedMixColorsOp<KoBgrU16Traits>(KoOptimizedMixColorsOpFactory::createMixColorsOp64());
+    checkOptimizedMixColorsOp<KoRgbF32Traits>(KoOptimizedMixColorsOpFactory::createMixColorsOp128());
+}
+
 
 QTEST_GUILESS_MAIN(TestKoColorSpaceAbstract)
@@ -23,79 +23,70 @@
 #include "kis_debug.h"
 #include <QtEndian>
 
-// from gimp's psd-save.c
-static quint32 pack_pb_line (const QByteArray &src,
-                             QByteArray &dst)
+#include <string.h>
+
+// based on gimp's psd-save.c, the runs are scanned a word at a time
+// and the literals are copied with memcpy
+static quint32 pack_pb_line(const char *src, quint32 length, char *dst)
 {
-    quint32 length = src.size();
-    quint32 remaining = length;
-    quint8  i, j;
-    quint32 dest_ptr = 0;
-    const char *start = src.constData();
-
-    length = 0;
-    while (remaining > 0)
+    const quint8 *start = reinterpret_cast<const quint8*>(src);
+    const quint8 *end = start + length;
+    char *out = dst;
+
+    while (start < end)
     {
+        const quint32 remaining = end - start;
+        const quint32 maxLength = qMin(remaining, quint32(128));
+
         /* Look for characters matching the first */
-        i = 0;
-        while ((i < 128) &&
-               (remaining - i > 0) &&
-               (start[0] == start[i]) )
+        quint32 i = 1;
+
+        if (maxLength > 8) {
+            const quint64 pattern = quint64(start[0]) * Q_UINT64_C(0x0101010101010101);
+            while (i + 8 <= maxLength) {
+                quint64 word;
+                memcpy(&word, start + i, sizeof(word));
+                if (word != pattern) break;
+                i += 8;
+            }
+        }
+
+        while (i < maxLength && start[i] == start[0])
             i++;
 
         if (i > 1)              /* Match found */
         {
-
-            dst[dest_ptr++] = -(i - 1);
-            dst[dest_ptr++] = *start;
-
+            *out++ = char(1 - qint32(i));
+            *out++ = char(start[0]);
             start += i;
-            remaining -= i;
-            length += 2;
         }
         else       /* Look for characters different from the previous */
         {
-            i = 0;
-            while ((i < 128)             &&
-                   (remaining - (i + 1) > 0) &&
-                   (start[i] != start[(i + 1)] ||
-                    remaining - (i + 2) <= 0  || start[i] != start[(i+2)]))
+            /* Stop the literal before a run of three equal characters */
+            i = 1;
+            while (i < maxLength &&
+                   !(i + 2 < remaining &&
+                     start[i] == start[i + 1] &&
+                     start[i] == start[i + 2]))
                 i++;
 
-            /* If there's only 1 remaining, the previous WHILE stmt doesn't
-             catch it */
-
-            if (remaining == 1)
-            {
-                i = 1;
-            }
-
-            if (i > 0)               /* Some distinct ones found */
-            {
-                dst[dest_ptr++] = i - 1;
-                for (j = 0; j < i; j++)
-                {
-                    dst[dest_ptr++] = start[j];
-                }
-                start += i;
-                remaining -= i;
-                length += i + 1;
-            }
-
+            *out++ = char(i - 1);
+            memcpy(out, start, i);
+            out += i;
+            start += i;
         }
     }
-    return length;
+    return out - dst;
 }
 
 
-// from gimp's psd-util.c
-quint32 decode_packbits(const char *src, char* dst, quint16 packed_len, quint32 unpacked_len)
+// from gimp's psd-util.c, the runs are expanded with memset/memcpy
+quint32 decode_packbits(const char *src, char* dst, quint32 packed_len, quint32 unpacked_len)
 {
     /*
      *  Decode a PackBits chunk.
      */
     qint32    n;
-    char      dat;
     qint32    unpack_left = unpacked_len;
     qint32    pack_left = packed_len;
     qint32    error_code = 0;
@@ -103,7 +94,7 @@ quint32 decode_packbits(const char *src, char* dst, quint16 packed_len, quint32
 
     while (unpack_left > 0 && pack_left > 0)
     {
-        n = *src;
+        n = quint8(*src);
         src++;
         pack_left--;
 
@@ -125,16 +116,13 @@ quint32 decode_packbits(const char *src, char* dst, quint16 packed_len, quint32
             {
                 dbgFile << "Overrun in packbits replicate of" << n - unpack_left << "chars";
                 error_code = 2;
+                n = unpack_left;
             }
-            dat = *src;
-            for (; n > 0; --n)
-            {
-                if (! unpack_left)
-                    break;
-                *dst = dat;
-                dst++;
-                unpack_left--;
-            }
+
+            memset(dst, *src, n);
+            dst += n;
+            unpack_left -= n;
+
             if (unpack_left)
             {
                 src++;
@@ -144,25 +132,27 @@ quint32 decode_packbits(const char *src, char* dst, quint16 packed_len, quint32
         else              /* copy next n+1 gchars literally */
         {
             n++;
-            for (; n > 0; --n)
+
+            const qint32 count = qMin(n, qMin(pack_left, unpack_left));
+
+            memcpy(dst, src, count);
+            dst += count;
+            src += count;
+            unpack_left -= count;
+            pack_left -= count;
+
+            if (count < n)
             {
                 if (! pack_left)
                 {
                     dbgFile << "Input buffer exhausted in copy";
                     error_code = 3;
-                    break;
                 }
-                if (! unpack_left)
+                else
                 {
                     dbgFile << "Output buffer exhausted in copy";
                     error_code = 4;
-                    break;
                 }
-                *dst = *src;
-                dst++;
-                unpack_left--;
-                src++;
-                pack_left--;
             }
         }
     }
@@ -170,11 +160,7 @@ quint32 decode_packbits(const char *src, char* dst, quint16 packed_len, quint32
     if (unpack_left > 0)
     {
         /* Pad with zeros to end of output buffer */
-        for (n = 0; n < pack_left; ++n)
-        {
-            *dst = 0;
-            dst++;
-        }
+        memset(dst, 0, unpack_left);
     }
 
     if (unpack_left)
@@ -238,6 +224,22 @@ QByteArray Compression::uncompress(quint32 unpacked_len, QByteArray bytes, Compr
     return QByteArray();
 }
 
+void Compression::decodePackBits(const char *src, quint32 packedLength, char *dst, quint32 unpackedLength)
+{
+    decode_packbits(src, dst, packedLength, unpackedLength);
+}
+
+quint32 Compression::packBitsMaxSize(quint32 unpackedLength)
+{
+    // every literal run of 128 bytes needs one header byte
+    return unpackedLength + unpackedLength / 128 + 1;
+}
+
+quint32 Compression::encodePackBits(const char *src, quint32 unpackedLength, char *dst)
+{
+    return pack_pb_line(src, unpackedLength, dst);
+}
+
 QByteArray Compression::compress(QByteArray bytes, Compression::CompressionType compressionType)
 {
     if (bytes.size() < 1) return QByteArray();
@@ -247,10 +249,8 @@ QByteArray Compression::compress(QByteArray bytes, Compression::CompressionType
         return bytes;
     case RLE:
     {
-        QByteArray dst;
-        int packed_len = pack_pb_line(bytes, dst);
-        Q_ASSERT(packed_len == dst.size());
-        Q_UNUSED(packed_len);
+        QByteArray dst(packBitsMaxSize(bytes.size()), Qt::Uninitialized);
+        dst.resize(pack_pb_line(bytes.constData(), bytes.size(), dst.data()));
         return dst;
     }
     case ZIP:
@@ -35,6 +35,22 @@ public:
 
     static QByteArray uncompress(quint32 unpacked_len, QByteArray bytes, CompressionType compressionType);
     static QByteArray compress(QByteArray bytes, CompressionType compressionType);
+
+    /**
+     * Decodes a PackBits-compressed row from \p src directly into \p dst,
+     * which must be at least \p unpackedLength bytes long. If the packed
+     * data ends prematurely, the rest of the row is filled with zeros.
+     */
+    static void decodePackBits(const char *src, quint32 packedLength, char *dst, quint32 unpackedLength);
+
+    /**
+     * Encodes a row of \p unpackedLength bytes with PackBits into \p dst,
+     * which must be at least packBitsMaxSize(unpackedLength) bytes long.
+     *
+     * \return the size of the packed data
+     */
+    static quint32 encodePackBits(const char *src, quint32 unpackedLength, char *dst);
+    static quint32 packBitsMaxSize(quint32 unpackedLength);
 };
 
 #endif // PSD_COMPRESSION_H
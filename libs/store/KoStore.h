@@ -280,7 +280,8 @@ public:
 
     /**
      * Allow to enable or disable compression of the files. Only supported by the
-     * ZIP backend.
+     * ZIP backend. The setting applies to the files opened after the call.
+     * Files in already compressed formats, like PNG, are never compressed again.
      */
     virtual void setCompressionEnabled(bool e);
 
@@ -23,6 +23,8 @@
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QFile>
+#include <QStringList>
 #include <QTemporaryFile>
 
 #include <kzip.h>
@@ -115,6 +117,8 @@ void KoZipStore::init(const QByteArray& appIdentification)
     Q_D(KoStore);
 
     m_currentDir = 0;
+    m_compressionEnabled = true;
+    m_mappedEntry = 0;
     d->good = m_pZip->open(d->mode == Write ? QIODevice::WriteOnly : QIODevice::ReadOnly);
 
     if (!d->good)
@@ -139,11 +143,22 @@ void KoZipStore::init(const QByteArray& appIdentification)
 
 void KoZipStore::setCompressionEnabled(bool e)
 {
-    if (e) {
-        m_pZip->setCompression(KZip::DeflateCompression);
-    } else {
-        m_pZip->setCompression(KZip::NoCompression);
+    m_compressionEnabled = e;
+}
+
+bool KoZipStore::isPrecompressedEntry(const QString &name)
+{
+    static const QStringList precompressedSuffixes = {
+        "png", "jpg", "jpeg", "gif", "webp", "kra", "ora", "zip"
+    };
+
+    const int dotPos = name.lastIndexOf('.');
+    if (dotPos < 0 || dotPos < name.lastIndexOf('/')) {
+        return false;
     }
+
+    const QString suffix = name.mid(dotPos + 1).toLower();
+    return precompressedSuffixes.contains(suffix);
 }
 
 bool KoZipStore::doFinalize()
@@ -160,6 +175,10 @@ bool KoZipStore::openWrite(const QString& name)
 {
     Q_D(KoStore);
     d->stream = 0; // Don't use!
+
+    const bool compress = m_compressionEnabled && !isPrecompressedEntry(name);
+    m_pZip->setCompression(compress ? KZip::DeflateCompression : KZip::NoCompression);
+
     return m_pZip->prepareWriting(name, "", "" /*m_pZip->rootDir()->user(), m_pZip->rootDir()->group()*/, 0);
 }
 
@@ -176,9 +195,57 @@ bool KoZipStore::openRead(const QString& name)
     }
     // Must cast to KZipFileEntry, not only KArchiveFile, because device() isn't virtual!
     const KZipFileEntry * f = static_cast<const KZipFileEntry *>(entry);
+    closeRead();
     delete d->stream;
-    d->stream = f->createDevice();
+    d->stream = 0;
     d->size = f->size();
+
+    /**
+     * The entries stored without compression are mapped into memory
+     * directly from the archive file. The readers get the data without
+     * any intermediate copying and seeking in the file, and the pages
+     * are shared with the system file cache. Deflated entries are
+     * decompressed by KZip as a stream.
+     */
+    QFile *file = qobject_cast<QFile*>(m_pZip->device());
+
+    if (file && f->encoding() == 0 && f->size() > 0 &&
+        f->compressedSize() == f->size()) {
+
+        m_mappedEntry = file->map(f->position(), f->compressedSize());
+
+        if (m_mappedEntry) {
+            QBuffer *buffer = new QBuffer();
+            buffer->setData(QByteArray::fromRawData(reinterpret_cast<const char*>(m_mappedEntry),
+                                                    f->compressedSize()));
+            buffer->open(QIODevice::ReadOnly);
+            d->stream = buffer;
+        }
+    }
+
+    if (!d->stream) {
+        d->stream = f->createDevice();
+    }
+
+    return true;
+}
+
+bool KoZipStore::closeRead()
+{
+    Q_D(KoStore);
+
+    if (m_mappedEntry) {
+        // the buffer should not outlive the mapped data
+        delete d->stream;
+        d->stream = 0;
+
+        QFile *file = qobject_cast<QFile*>(m_pZip->device());
+        if (file) {
+            file->unmap(m_mappedEntry);
+        }
+        m_mappedEntry = 0;
+    }
+
     return true;
 }
 
@@ -46,15 +46,21 @@ public:
 
     QStringList directoryList() const override;
 
+    /**
+     * \return true if the entry \p name contains data in an already
+     * compressed format, which is stored in the archive as-is even when
+     * the compression is enabled. Deflating such data costs a lot of CPU
+     * time without reducing the size of the archive.
+     */
+    static bool isPrecompressedEntry(const QString &name);
+
 protected:
     void init(const QByteArray& appIdentification);
     bool doFinalize() override;
     bool openWrite(const QString& name) override;
     bool openRead(const QString& name) override;
     bool closeWrite() override;
-    bool closeRead() override {
-        return true;
-    }
+    bool closeRead() override;
     bool enterRelativeDirectory(const QString& dirName) override;
     bool enterAbsoluteDirectory(const QString& path) override;
     bool fileExists(const QString& absPath) const override;
@@ -67,6 +73,12 @@ private:
     // In "Read" mode this pointer is pointing to the  current directory in the archive to speed up the verification process
     const KArchiveDirectory* m_currentDir;
 
+    // Whether the entries opened for writing should be deflated
+    bool m_compressionEnabled;
+
+    // The memory-mapped data of the entry opened for reading, if any
+    uchar *m_mappedEntry;
+
     Q_DECLARE_PRIVATE(KoStore)
 };
 
@@ -0,0 +1,146 @@
+/* This file is part of the KDE project
+ * Copyright (c) 2026 Krita Developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoZipStore.h"
+
+#include <KoStore.h>
+
+#include <kzip.h>
+
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QTest>
+
+void TestKoZipStore::testEntryCompression_data()
+{
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<bool>("compressionEnabled");
+    QTest::addColumn<bool>("deflated");
+
+    QTest::newRow("xml") << "maindoc.xml" << true << true;
+    QTest::newRow("xml-disabled") << "maindoc.xml" << false << false;
+    QTest::newRow("png") << "preview.png" << true << false;
+    QTest::newRow("png-upper-case") << "Thumbnails/thumbnail.PNG" << true << false;
+    QTest::newRow("layer") << "image/layers/layer2" << true << true;
+    QTest::newRow("layer-disabled") << "image/layers/layer2" << false << false;
+    QTest::newRow("dot-in-directory") << "image.png/layers/layer2" << true << true;
+}
+
+void TestKoZipStore::testEntryCompression()
+{
+    QFETCH(QString, name);
+    QFETCH(bool, compressionEnabled);
+    QFETCH(bool, deflated);
+
+    const QByteArray data(4096, 'x');
+
+    QBuffer buffer;
+
+    {
+        QScopedPointer<KoStore> store(KoStore::createStore(&buffer, KoStore::Write,
+                                                           "application/x-krita", KoStore::Zip));
+        QVERIFY(!store->bad());
+
+        store->setCompressionEnabled(compressionEnabled);
+
+        QVERIFY(store->open(name));
+        QCOMPARE(store->write(data), qint64(data.size()));
+        QVERIFY(store->close());
+
+        // the next entries are not affected by the setting
+        store->setCompressionEnabled(true);
+        QVERIFY(store->open("documentinfo.xml"));
+        QCOMPARE(store->write(data), qint64(data.size()));
+        QVERIFY(store->close());
+
+        QVERIFY(store->finalize());
+    }
+
+    KZip zip(&buffer);
+    QVERIFY(zip.open(QIODevice::ReadOnly));
+
+    const KZipFileEntry *entry =
+        dynamic_cast<const KZipFileEntry*>(zip.directory()->entry(name));
+    QVERIFY(entry);
+
+    QCOMPARE(entry->encoding() == 8, deflated);
+    QCOMPARE(entry->data(), data);
+
+    const KZipFileEntry *xmlEntry =
+        dynamic_cast<const KZipFileEntry*>(zip.directory()->entry("documentinfo.xml"));
+    QVERIFY(xmlEntry);
+    QCOMPARE(xmlEntry->encoding(), 8);
+}
+
+void TestKoZipStore::testReadEntries()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.path() + "/test.kra";
+
+    QByteArray storedData;
+    for (int i = 0; i < 1000; i++) {
+        storedData += QByteArray::number(i) + ",LZF," + QByteArray::number(i * 7) + "\n";
+    }
+    const QByteArray deflatedData = "<doc>" + QByteArray(10000, 'x') + "</doc>";
+
+    {
+        QScopedPointer<KoStore> store(KoStore::createStore(fileName, KoStore::Write,
+                                                           "application/x-krita", KoStore::Zip));
+        QVERIFY(!store->bad());
+
+        store->setCompressionEnabled(false);
+        QVERIFY(store->open("image/layers/layer1"));
+        QCOMPARE(store->write(storedData), qint64(storedData.size()));
+        QVERIFY(store->close());
+
+        store->setCompressionEnabled(true);
+        QVERIFY(store->open("maindoc.xml"));
+        QCOMPARE(store->write(deflatedData), qint64(deflatedData.size()));
+        QVERIFY(store->close());
+
+        QVERIFY(store->finalize());
+    }
+
+    QScopedPointer<KoStore> store(KoStore::createStore(fileName, KoStore::Read,
+                                                       "", KoStore::Zip));
+    QVERIFY(!store->bad());
+
+    // the stored entry is read through the device line by line, like tiles
+    QVERIFY(store->open("image/layers/layer1"));
+    QCOMPARE(store->size(), qint64(storedData.size()));
+    QIODevice *device = store->device();
+    QVERIFY(device);
+    QCOMPARE(device->readLine(), QByteArray("0,LZF,0\n"));
+    QCOMPARE(device->read(8), QByteArray("1,LZF,7\n"));
+    QVERIFY(device->seek(0));
+    QCOMPARE(device->readAll(), storedData);
+    QVERIFY(store->close());
+
+    QVERIFY(store->open("maindoc.xml"));
+    QCOMPARE(store->read(store->size()), deflatedData);
+    QVERIFY(store->close());
+
+    // reopening works after the mapping has been released
+    QVERIFY(store->open("image/layers/layer1"));
+    QCOMPARE(store->read(store->size()), storedData);
+    QVERIFY(store->close());
+}
+
+QTEST_GUILESS_MAIN(TestKoZipStore)
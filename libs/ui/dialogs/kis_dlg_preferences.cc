@@ -829,6 +829,7 @@ void PerformanceTab::load(bool requestDefault)
 
     sliderSwapSize->setValue(cfg.maxSwapSize(requestDefault) / 1024);
     lblSwapFileLocation->setText(cfg.swapDir(requestDefault));
+    chkLazyLoadLayers->setChecked(cfg.lazyLoadLayers(requestDefault));
 
     m_lastUsedThreadsLimit = cfg.maxNumberOfThreads(requestDefault);
     m_lastUsedClonesLimit = cfg.frameRenderingClones(requestDefault);
@@ -875,6 +876,7 @@ void PerformanceTab::save()
     cfg.setMaxSwapSize(sliderSwapSize->value() * 1024);
 
     cfg.setSwapDir(lblSwapFileLocation->text());
+    cfg.setLazyLoadLayers(chkLazyLoadLayers->isChecked());
 
     cfg.setMaxNumberOfThreads(sliderThreadsLimit->value());
     cfg.setFrameRenderingClones(sliderFrameClonesLimit->value());
@@ -31,12 +31,16 @@
 #include <KoStoreDevice.h>
 
 #include <limits.h>
+#include <limits>
 #include <stdio.h>
 #include <zlib.h>
 
 #include <QBuffer>
 #include <QFile>
 #include <QApplication>
+#include <QThread>
+#include <QtConcurrent>
+#include <QtEndian>
 
 #include <klocalizedstring.h>
 #include <QUrl>
@@ -265,6 +269,192 @@ void decode_meta_data(png_textp text, KisMetaData::Store* store, QString type, i
         dbgFile << "Decoding failed";
     }
 }
+
+/**
+ * The number of rows converted, filtered or compressed by a single
+ * job of the thread pool
+ */
+const int rowsPerJob = 64;
+
+/**
+ * The size of the deflate window. Every compressed chunk is primed with
+ * this many bytes of the previous chunk, so that splitting the stream
+ * costs almost nothing in the compression ratio.
+ */
+const int deflateWindowSize = 32768;
+
+struct RowChunk {
+    int firstRow = 0;
+    int numRows = 0;
+    QByteArray filteredData;
+    QByteArray compressedData;
+    uLong adler = 1;
+    bool success = true;
+};
+
+inline quint8 paethPredictor(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = qAbs(p - a);
+    const int pb = qAbs(p - b);
+    const int pc = qAbs(p - c);
+
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+template <int filterType>
+inline quint8 filteredByte(const quint8 *row, const quint8 *prevRow, int i, int bpp)
+{
+    const int a = i >= bpp ? row[i - bpp] : 0;
+    const int b = prevRow ? prevRow[i] : 0;
+    const int c = i >= bpp && prevRow ? prevRow[i - bpp] : 0;
+
+    switch (filterType) {
+    case PNG_FILTER_VALUE_SUB:
+        return row[i] - a;
+    case PNG_FILTER_VALUE_UP:
+        return row[i] - b;
+    case PNG_FILTER_VALUE_AVG:
+        return row[i] - ((a + b) >> 1);
+    case PNG_FILTER_VALUE_PAETH:
+        return row[i] - paethPredictor(a, b, c);
+    default:
+        return row[i];
+    }
+}
+
+/**
+ * Returns the sum of absolute values of the filtered bytes (treated as
+ * signed), stopping as soon as it exceeds \p limit
+ */
+template <int filterType>
+quint64 filteredRowCost(const quint8 *row, const quint8 *prevRow, int rowBytes, int bpp, quint64 limit)
+{
+    quint64 sum = 0;
+    for (int i = 0; i < rowBytes && sum < limit; i++) {
+        sum += qAbs(int(qint8(filteredByte<filterType>(row, prevRow, i, bpp))));
+    }
+    return sum;
+}
+
+template <int filterType>
+void filterRow(const quint8 *row, const quint8 *prevRow, int rowBytes, int bpp, quint8 *dst)
+{
+    for (int i = 0; i < rowBytes; i++) {
+        dst[i] = filteredByte<filterType>(row, prevRow, i, bpp);
+    }
+}
+
+/**
+ * Filters a single row the way libpng does by default: all the five
+ * filters are tried and the one with the smallest sum of absolute
+ * differences is chosen. Palette images are not filtered. \p dst
+ * receives the filter type byte followed by \p rowBytes filtered bytes.
+ */
+void filterPNGRow(const quint8 *row, const quint8 *prevRow, int rowBytes, int bpp, bool adaptive, quint8 *dst)
+{
+    int bestFilter = PNG_FILTER_VALUE_NONE;
+
+    if (adaptive) {
+        quint64 bestCost = filteredRowCost<PNG_FILTER_VALUE_NONE>(row, prevRow, rowBytes, bpp, std::numeric_limits<quint64>::max());
+
+        auto tryFilter = [&] (int filter, quint64 cost) {
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestFilter = filter;
+            }
+        };
+
+        tryFilter(PNG_FILTER_VALUE_SUB, filteredRowCost<PNG_FILTER_VALUE_SUB>(row, prevRow, rowBytes, bpp, bestCost));
+        tryFilter(PNG_FILTER_VALUE_UP, filteredRowCost<PNG_FILTER_VALUE_UP>(row, prevRow, rowBytes, bpp, bestCost));
+        tryFilter(PNG_FILTER_VALUE_AVG, filteredRowCost<PNG_FILTER_VALUE_AVG>(row, prevRow, rowBytes, bpp, bestCost));
+        tryFilter(PNG_FILTER_VALUE_PAETH, filteredRowCost<PNG_FILTER_VALUE_PAETH>(row, prevRow, rowBytes, bpp, bestCost));
+    }
+
+    *dst++ = bestFilter;
+
+    switch (bestFilter) {
+    case PNG_FILTER_VALUE_SUB:
+        filterRow<PNG_FILTER_VALUE_SUB>(row, prevRow, rowBytes, bpp, dst);
+        break;
+    case PNG_FILTER_VALUE_UP:
+        filterRow<PNG_FILTER_VALUE_UP>(row, prevRow, rowBytes, bpp, dst);
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        filterRow<PNG_FILTER_VALUE_AVG>(row, prevRow, rowBytes, bpp, dst);
+        break;
+    case PNG_FILTER_VALUE_PAETH:
+        filterRow<PNG_FILTER_VALUE_PAETH>(row, prevRow, rowBytes, bpp, dst);
+        break;
+    default:
+        memcpy(dst, row, rowBytes);
+    }
+}
+
+/**
+ * Compresses a chunk of filtered rows into a raw deflate stream. All the
+ * chunks but the last one end with a sync flush, so their outputs are
+ * byte-aligned and can be concatenated into a single zlib stream.
+ */
+bool deflateChunk(const QByteArray &data, const QByteArray &dictionary, int level, int strategy, bool isLastChunk, QByteArray *result)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, strategy) != Z_OK) {
+        return false;
+    }
+
+    if (!dictionary.isEmpty()) {
+        deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dictionary.constData()), dictionary.size());
+    }
+
+    result->resize(deflateBound(&stream, data.size()) + 16);
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(result->data());
+    stream.avail_out = result->size();
+
+    const int flush = isLastChunk ? Z_FINISH : Z_SYNC_FLUSH;
+    int ret = Z_OK;
+
+    forever {
+        ret = deflate(&stream, flush);
+
+        if ((ret != Z_OK && ret != Z_STREAM_END) ||
+            (isLastChunk ? ret == Z_STREAM_END : stream.avail_out > 0)) {
+
+            break;
+        }
+
+        // the output buffer is full, make some more space
+        const int bytesWritten = stream.total_out;
+        result->resize(result->size() * 2);
+        stream.next_out = reinterpret_cast<Bytef*>(result->data()) + bytesWritten;
+        stream.avail_out = result->size() - bytesWritten;
+    }
+
+    result->resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return isLastChunk ? ret == Z_STREAM_END : ret == Z_OK;
+}
+
+void writePNGChunk(png_structp png_ptr, const char *name, const QVector<QByteArray> &pieces)
+{
+    png_uint_32 length = 0;
+    Q_FOREACH (const QByteArray &piece, pieces) {
+        length += piece.size();
+    }
+
+    png_write_chunk_start(png_ptr, (png_bytep)name, length);
+    Q_FOREACH (const QByteArray &piece, pieces) {
+        png_write_chunk_data(png_ptr, (png_bytep)piece.constData(), piece.size());
+    }
+    png_write_chunk_end(png_ptr);
+}
+
 }
 
 KisPNGConverter::KisPNGConverter(KisDocument *doc, bool batchMode)
@@ -952,12 +1142,13 @@ KisImageBuilder_Result KisPNGConverter::buildFile(QIODevice* iodevice, const QRe
 
     /* set the zlib compression level */
     png_set_compression_level(png_ptr, options.compression);
+    options.compressionStrategy = qBound(Z_DEFAULT_STRATEGY, options.compressionStrategy, Z_RLE);
 
     png_set_write_fn(png_ptr, (void*)iodevice, _write_fn, _flush_fn);
 
     /* set other zlib parameters */
     png_set_compression_mem_level(png_ptr, 8);
-    png_set_compression_strategy(png_ptr, Z_DEFAULT_STRATEGY);
+    png_set_compression_strategy(png_ptr, options.compressionStrategy);
     png_set_compression_window_bits(png_ptr, 15);
     png_set_compression_method(png_ptr, 8);
     png_set_compression_buffer_size(png_ptr, 8192);
@@ -1185,12 +1376,6 @@ KisImageBuilder_Result KisPNGConverter::buildFile(QIODevice* iodevice, const QRe
     png_write_info(png_ptr, info_ptr);
     png_write_flush(png_ptr);
 
-    // swap byteorder on little endian machines.
-#ifndef WORDS_BIGENDIAN
-    if (color_nb_bits > 8)
-        png_set_swap(png_ptr);
-#endif
-
     // Write the PNG
     //     png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, 0);
 
@@ -1216,81 +1401,218 @@ KisImageBuilder_Result KisPNGConverter::buildFile(QIODevice* iodevice, const QRe
         png_byte** rows = 0;
     };
 
+    switch (color_type) {
+    case PNG_COLOR_TYPE_GRAY:
+    case PNG_COLOR_TYPE_GRAY_ALPHA:
+    case PNG_COLOR_TYPE_RGB:
+    case PNG_COLOR_TYPE_RGB_ALPHA:
+    case PNG_COLOR_TYPE_PALETTE:
+        break;
+    default:
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return KisImageBuilder_RESULT_UNSUPPORTED;
+    }
+
+    const bool useMultithreading = QThread::idealThreadCount() > 1 && imageRect.height() > rowsPerJob;
+
+    QVector<RowChunk> chunks;
+    for (int row = 0; row < imageRect.height(); row += rowsPerJob) {
+        RowChunk chunk;
+        chunk.firstRow = row;
+        chunk.numRows = qMin(rowsPerJob, imageRect.height() - row);
+        chunks.append(chunk);
+    }
 
     // Fill the data structure
     RowPointersStruct rowPointers(imageRect.size(), device->pixelSize());
 
-    int row = 0;
-    for (int y = imageRect.y(); y < imageRect.y() + imageRect.height(); y++, row++) {
-        KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(imageRect.x(), y, imageRect.width());
-
-        switch (color_type) {
-        case PNG_COLOR_TYPE_GRAY:
-        case PNG_COLOR_TYPE_GRAY_ALPHA:
-            if (color_nb_bits == 16) {
-                quint16 *dst = reinterpret_cast<quint16 *>(rowPointers.rows[row]);
-                do {
-                    const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
-                    *(dst++) = d[0];
-                    if (options.alpha) *(dst++) = d[1];
-                } while (it->nextPixel());
-            } else {
+    /**
+     * The 16-bit samples are written in the network byte order right
+     * away, so we don't need libpng to swap them and the rows can be
+     * filtered by our own code as well
+     */
+    auto convertRows = [&] (const RowChunk &chunk) {
+        KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(imageRect.x(), imageRect.y() + chunk.firstRow, imageRect.width());
+
+        for (int row = chunk.firstRow; row < chunk.firstRow + chunk.numRows; row++, it->nextRow()) {
+            switch (color_type) {
+            case PNG_COLOR_TYPE_GRAY:
+            case PNG_COLOR_TYPE_GRAY_ALPHA:
+                if (color_nb_bits == 16) {
+                    quint16 *dst = reinterpret_cast<quint16 *>(rowPointers.rows[row]);
+                    do {
+                        const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
+                        *(dst++) = qToBigEndian(d[0]);
+                        if (options.alpha) *(dst++) = qToBigEndian(d[1]);
+                    } while (it->nextPixel());
+                } else {
+                    quint8 *dst = rowPointers.rows[row];
+                    do {
+                        const quint8 *d = it->oldRawData();
+                        *(dst++) = d[0];
+                        if (options.alpha) *(dst++) = d[1];
+                    } while (it->nextPixel());
+                }
+                break;
+            case PNG_COLOR_TYPE_RGB:
+            case PNG_COLOR_TYPE_RGB_ALPHA:
+                if (color_nb_bits == 16) {
+                    quint16 *dst = reinterpret_cast<quint16 *>(rowPointers.rows[row]);
+                    do {
+                        const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
+                        *(dst++) = qToBigEndian(d[2]);
+                        *(dst++) = qToBigEndian(d[1]);
+                        *(dst++) = qToBigEndian(d[0]);
+                        if (options.alpha) *(dst++) = qToBigEndian(d[3]);
+                    } while (it->nextPixel());
+                } else {
+                    quint8 *dst = rowPointers.rows[row];
+                    do {
+                        const quint8 *d = it->oldRawData();
+                        *(dst++) = d[2];
+                        *(dst++) = d[1];
+                        *(dst++) = d[0];
+                        if (options.alpha) *(dst++) = d[3];
+                    } while (it->nextPixel());
+                }
+                break;
+            case PNG_COLOR_TYPE_PALETTE: {
                 quint8 *dst = rowPointers.rows[row];
+                KisPNGWriteStream writestream(dst, color_nb_bits);
                 do {
                     const quint8 *d = it->oldRawData();
-                    *(dst++) = d[0];
-                    if (options.alpha) *(dst++) = d[1];
+                    int i;
+                    for (i = 0; i < num_palette; i++) {
+                        if (palette[i].red == d[2] &&
+                                palette[i].green == d[1] &&
+                                palette[i].blue == d[0]) {
+                            break;
+                        }
+                    }
+                    writestream.setNextValue(i);
                 } while (it->nextPixel());
             }
-            break;
-        case PNG_COLOR_TYPE_RGB:
-        case PNG_COLOR_TYPE_RGB_ALPHA:
-            if (color_nb_bits == 16) {
-                quint16 *dst = reinterpret_cast<quint16 *>(rowPointers.rows[row]);
-                do {
-                    const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
-                    *(dst++) = d[2];
-                    *(dst++) = d[1];
-                    *(dst++) = d[0];
-                    if (options.alpha) *(dst++) = d[3];
-                } while (it->nextPixel());
-            } else {
-                quint8 *dst = rowPointers.rows[row];
-                do {
-                    const quint8 *d = it->oldRawData();
-                    *(dst++) = d[2];
-                    *(dst++) = d[1];
-                    *(dst++) = d[0];
-                    if (options.alpha) *(dst++) = d[3];
-                } while (it->nextPixel());
+                break;
             }
-            break;
-        case PNG_COLOR_TYPE_PALETTE: {
-            quint8 *dst = rowPointers.rows[row];
-            KisPNGWriteStream writestream(dst, color_nb_bits);
-            do {
-                const quint8 *d = it->oldRawData();
-                int i;
-                for (i = 0; i < num_palette; i++) {
-                    if (palette[i].red == d[2] &&
-                            palette[i].green == d[1] &&
-                            palette[i].blue == d[0]) {
-                        break;
-                    }
-                }
-                writestream.setNextValue(i);
-            } while (it->nextPixel());
         }
-            break;
-        default:
-            return KisImageBuilder_RESULT_UNSUPPORTED;
+    };
+
+    if (useMultithreading) {
+        QtConcurrent::blockingMap(chunks, convertRows);
+    } else {
+        Q_FOREACH (const RowChunk &chunk, chunks) {
+            convertRows(chunk);
+        }
+    }
+
+    /**
+     * libpng filters and compresses the rows on the calling thread only.
+     * For big images we can do that ourselves: every chunk of rows is
+     * compressed by a separate job into a raw deflate stream, primed
+     * with the tail of the previous chunk and sync-flushed at the end.
+     * The streams are then concatenated into IDAT chunks, wrapped into
+     * the zlib header and the combined Adler-32 checksum.
+     *
+     * The resulting file doesn't depend on the number of threads, so
+     * the chunked path is taken whenever there is more than one chunk,
+     * even on a single core.
+     */
+    const bool useParallelDeflate =
+        options.parallelCompression &&
+        chunks.size() > 1 &&
+        interlacetype == PNG_INTERLACE_NONE;
+
+    if (!useParallelDeflate) {
+        png_write_image(png_ptr, rowPointers.rows);
+
+        // Writing is over
+        png_write_end(png_ptr, info_ptr);
+
+        // Free memory
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return KisImageBuilder_RESULT_OK;
+    }
+
+    const int rowBytes = png_get_rowbytes(png_ptr, info_ptr);
+    const int bpp = qMax(1, png_get_channels(png_ptr, info_ptr) * color_nb_bits / 8);
+    const bool adaptiveFilter = color_type != PNG_COLOR_TYPE_PALETTE;
+
+    QtConcurrent::blockingMap(chunks, [&] (RowChunk &chunk) {
+        chunk.filteredData.resize(chunk.numRows * (rowBytes + 1));
+        quint8 *dst = reinterpret_cast<quint8*>(chunk.filteredData.data());
+
+        for (int row = chunk.firstRow; row < chunk.firstRow + chunk.numRows; row++) {
+            const quint8 *prevRow = row > 0 ? rowPointers.rows[row - 1] : 0;
+            filterPNGRow(rowPointers.rows[row], prevRow, rowBytes, bpp, adaptiveFilter, dst);
+            dst += rowBytes + 1;
+        }
+
+        chunk.adler = adler32(1L, reinterpret_cast<const Bytef*>(chunk.filteredData.constData()), chunk.filteredData.size());
+    });
+
+    const int level = qBound(Z_NO_COMPRESSION, options.compression, Z_BEST_COMPRESSION);
+    const RowChunk *firstChunk = chunks.constData();
+    const RowChunk *lastChunk = firstChunk + chunks.size() - 1;
+
+    QtConcurrent::blockingMap(chunks, [&] (RowChunk &chunk) {
+        QByteArray dictionary;
+
+        if (&chunk != firstChunk) {
+            const QByteArray &prevData = (&chunk - 1)->filteredData;
+            const int dictionarySize = qMin(prevData.size(), deflateWindowSize);
+            dictionary = QByteArray::fromRawData(prevData.constData() + prevData.size() - dictionarySize, dictionarySize);
         }
+
+        chunk.success = deflateChunk(chunk.filteredData, dictionary, level,
+                                     options.compressionStrategy, &chunk == lastChunk,
+                                     &chunk.compressedData);
+    });
+
+    uLong adler = 1L;
+    Q_FOREACH (const RowChunk &chunk, chunks) {
+        if (!chunk.success) {
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return KisImageBuilder_RESULT_FAILURE;
+        }
+        adler = adler32_combine(adler, chunk.adler, chunk.filteredData.size());
     }
 
-    png_write_image(png_ptr, rowPointers.rows);
+    // the same header zlib itself would write for these settings
+    const int levelFlags =
+        options.compressionStrategy >= Z_HUFFMAN_ONLY || level < 2 ? 0 :
+        level < 6 ? 1 :
+        level == 6 ? 2 : 3;
+
+    quint16 zlibHeader = (Z_DEFLATED + (7 << 4)) << 8 | levelFlags << 6;
+    zlibHeader += 31 - zlibHeader % 31;
+
+    QByteArray header(2, 0);
+    qToBigEndian(zlibHeader, reinterpret_cast<uchar*>(header.data()));
 
-    // Writing is over
-    png_write_end(png_ptr, info_ptr);
+    QByteArray checksum(4, 0);
+    qToBigEndian(quint32(adler), reinterpret_cast<uchar*>(checksum.data()));
+
+    for (int i = 0; i < chunks.size(); i++) {
+        QVector<QByteArray> pieces;
+
+        if (i == 0) {
+            pieces << header;
+        }
+        pieces << chunks[i].compressedData;
+        if (i == chunks.size() - 1) {
+            pieces << checksum;
+        }
+
+        writePNGChunk(png_ptr, "IDAT", pieces);
+    }
+
+    /**
+     * We cannot call png_write_end() here: libpng doesn't know that
+     * the image data has been written and would fail. All the other
+     * chunks have already been written by png_write_info(), so just
+     * finish the file.
+     */
+    writePNGChunk(png_ptr, "IEND", QVector<QByteArray>());
 
     // Free memory
     png_destroy_write_struct(&png_ptr, &info_ptr);
@@ -45,6 +45,8 @@ class Store;
 struct KisPNGOptions {
     KisPNGOptions()
         : compression(0)
+        , compressionStrategy(0)
+        , parallelCompression(false)
         , interlace(false)
         , alpha(true)
         , exif(true)
@@ -59,6 +61,10 @@ struct KisPNGOptions {
     {}
 
     int compression;
+    /// zlib strategy: Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY or Z_RLE
+    int compressionStrategy;
+    /// filter and compress chunks of rows on several threads (non-interlaced images only)
+    bool parallelCompression;
     bool interlace;
     bool alpha;
     bool exif;
@@ -152,4 +152,14 @@ void FreehandStrokeBenchmark::testColorsmudgeDefaultTip()
     benchmarkBrush("testing_200px_colorsmudge_default.kpp");
 }
 
+void FreehandStrokeBenchmark::testTangentNormalDefaultTip()
+{
+    benchmarkBrush("testing_tangentnormal_default.kpp");
+}
+
+void FreehandStrokeBenchmark::testHairyDefaultTip()
+{
+    benchmarkBrush("testing_hairy_default.kpp");
+}
+
 QTEST_MAIN(FreehandStrokeBenchmark)
@@ -38,6 +38,10 @@ private Q_SLOTS:
     void testStampTip();
 
     void testColorsmudgeDefaultTip();
+
+    void testTangentNormalDefaultTip();
+
+    void testHairyDefaultTip();
 };
 
 #endif // FREEHANDSTROKEBENCHMARK_H
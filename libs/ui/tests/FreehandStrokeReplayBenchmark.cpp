@@ -0,0 +1,325 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "FreehandStrokeReplayBenchmark.h"
+
+#include <QTest>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtMath>
+
+#include <algorithm>
+#include <numeric>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoResourcePaths.h>
+
+#include "stroke_testing_utils.h"
+#include "strokes/freehand_stroke.h"
+#include "strokes/KisFreehandStrokeInfo.h"
+#include "kis_resources_snapshot.h"
+#include "kis_distance_information.h"
+#include "kis_image.h"
+#include "KisRunnableStrokeJobData.h"
+#include "KisStrokeTrace.h"
+#include <brushengine/kis_paint_information.h>
+
+
+namespace {
+
+qreal percentile(QVector<qreal> values, qreal fraction)
+{
+    if (values.isEmpty()) return 0.0;
+
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, qCeil(fraction * values.size()) - 1, values.size() - 1);
+    return values[index];
+}
+
+qreal mean(const QVector<qreal> &values)
+{
+    if (values.isEmpty()) return 0.0;
+
+    return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+}
+
+}
+
+class FreehandStrokeReplayTester : public utils::StrokeTester
+{
+public:
+    FreehandStrokeReplayTester(const QString &presetFilename,
+                               const KoColorSpace *colorSpace,
+                               const KisStrokeTrace &trace)
+        : StrokeTester("freehand_replay", QSize(2000, 1500), presetFilename),
+          m_colorSpace(colorSpace),
+          m_trace(trace)
+    {
+        setNumIterations(m_trace.strokes().size());
+
+        // the samples are written by the marker jobs, so the
+        // vector should never be reallocated during the stroke
+        m_samples.resize(m_trace.numSamples());
+    }
+
+    /**
+     * Every stroke job is followed by a marker job, which saves the
+     * moment the job has been completed. The job time is counted from
+     * the moment the job could start, i.e. when it has been added or
+     * when the previous job has completed, whichever is later.
+     *
+     * The latency of a sample is the time from adding its job to the
+     * first projection update covering the sample's position after the
+     * job has been completed. The samples that never got updated (e.g.
+     * the clone brush without a source) are not counted.
+     */
+    struct Sample {
+        QPointF pos;
+        qint64 submitTime = -1; // nsec
+        qint64 completionTime = -1; // nsec
+    };
+
+    struct Update {
+        QRect rect;
+        qint64 time; // nsec
+    };
+
+    int numDabs() const {
+        return m_numDabs;
+    }
+
+    QVector<qreal> jobTimes() const {
+        QVector<qreal> result;
+
+        qint64 previousCompletionTime = 0;
+
+        for (int i = 0; i < m_numSamples; i++) {
+            const Sample &sample = m_samples[i];
+            const qint64 startTime = qMax(sample.submitTime, previousCompletionTime);
+            result.append(qreal(sample.completionTime - startTime) / 1000000.0);
+            previousCompletionTime = sample.completionTime;
+        }
+
+        return result;
+    }
+
+    QVector<qreal> latencies() const {
+        QVector<qreal> result;
+
+        for (int i = 0; i < m_numSamples; i++) {
+            const Sample &sample = m_samples[i];
+            const QPoint pt = sample.pos.toPoint();
+
+            Q_FOREACH (const Update &update, m_updates) {
+                if (update.time >= sample.completionTime && update.rect.contains(pt)) {
+                    result.append(qreal(update.time - sample.submitTime) / 1000000.0);
+                    break;
+                }
+            }
+        }
+
+        return result;
+    }
+
+protected:
+    void initImage(KisImageWSP image, KisNodeSP activeNode, int iteration) override {
+        Q_UNUSED(activeNode);
+
+        if (iteration > 0) return;
+
+        if (m_colorSpace != image->colorSpace()) {
+            image->convertImageColorSpace(m_colorSpace,
+                                          KoColorConversionTransformation::internalRenderingIntent(),
+                                          KoColorConversionTransformation::internalConversionFlags());
+            image->waitForDone();
+        }
+
+        m_timer.start();
+
+        m_updatesConnection =
+            QObject::connect(image.data(), &KisImage::sigImageUpdated,
+                             [this] (const QRect &rc) {
+                                 QMutexLocker l(&m_mutex);
+                                 m_updates.append({rc, m_timer.nsecsElapsed()});
+                             });
+    }
+
+    KisStrokeStrategy* createStroke(KisResourcesSnapshotSP resources,
+                                    KisImageWSP image) override {
+        Q_UNUSED(image);
+
+        m_strokeInfo = new KisFreehandStrokeInfo();
+
+        QScopedPointer<FreehandStrokeStrategy> stroke(
+            new FreehandStrokeStrategy(resources, m_strokeInfo, kundo2_noi18n("Freehand Stroke")));
+
+        return stroke.take();
+    }
+
+    void addPaintingJobs(KisImageWSP image, KisResourcesSnapshotSP resources, int iteration) override {
+        Q_UNUSED(resources);
+
+        const KisStrokeTrace::Stroke &stroke = m_trace.strokes()[iteration];
+
+        const qint64 strokeStartTime = m_timer.nsecsElapsed();
+        const qreal traceStartTime = stroke.first().currentTime();
+
+        for (int i = 0; i < stroke.size(); i++) {
+            const qint64 sampleTime =
+                strokeStartTime + qint64((stroke[i].currentTime() - traceStartTime) * 1000000.0);
+
+            const qint64 timeLeft = sampleTime - m_timer.nsecsElapsed();
+            if (timeLeft > 0) {
+                QThread::usleep(timeLeft / 1000);
+            }
+
+            if (i == 0 && stroke.size() > 1) continue;
+
+            Sample *sample = m_samples.data() + m_numSamples++;
+            sample->pos = stroke[i].pos();
+            sample->submitTime = m_timer.nsecsElapsed();
+
+            image->addJob(strokeId(),
+                          i == 0 ?
+                              new FreehandStrokeStrategy::Data(0, stroke[i]) :
+                              new FreehandStrokeStrategy::Data(0, stroke[i - 1], stroke[i]));
+
+            image->addJob(strokeId(),
+                          new KisRunnableStrokeJobData(
+                              [this, sample] () {
+                                  sample->completionTime = m_timer.nsecsElapsed();
+                              },
+                              KisStrokeJobData::UNIQUELY_CONCURRENT));
+        }
+
+        image->addJob(strokeId(), new FreehandStrokeStrategy::UpdateData(true));
+
+        KisFreehandStrokeInfo *strokeInfo = m_strokeInfo;
+        image->addJob(strokeId(),
+                      new KisRunnableStrokeJobData(
+                          [this, strokeInfo] () {
+                              m_numDabs += strokeInfo->dragDistance->currentDabSeqNo();
+                          },
+                          KisStrokeJobData::SEQUENTIAL));
+    }
+
+    void beforeCheckingResult(KisImageWSP image, KisNodeSP activeNode) override {
+        Q_UNUSED(image);
+        Q_UNUSED(activeNode);
+        QObject::disconnect(m_updatesConnection);
+    }
+
+private:
+    const KoColorSpace *m_colorSpace;
+    const KisStrokeTrace &m_trace;
+
+    KisFreehandStrokeInfo *m_strokeInfo = 0;
+    QElapsedTimer m_timer;
+
+    QVector<Sample> m_samples;
+    int m_numSamples = 0;
+
+    QMutex m_mutex;
+    QVector<Update> m_updates;
+    QMetaObject::Connection m_updatesConnection;
+
+    int m_numDabs = 0;
+};
+
+void FreehandStrokeReplayBenchmark::initTestCase()
+{
+    KoResourcePaths::addResourceType("kis_brushes", "data", QString(SYSTEM_RESOURCES_DATA_DIR) + "brushes/");
+    KoResourcePaths::addResourceType("ko_patterns", "data", QString(SYSTEM_RESOURCES_DATA_DIR) + "patterns/");
+}
+
+void FreehandStrokeReplayBenchmark::testReplay_data()
+{
+    QTest::addColumn<QString>("presetFileName");
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<QString>("traceFileName");
+
+    const QDir presetsDir(DEFAULT_PRESETS_DIR);
+    const QDir tracesDir(QString(FILES_DATA_DIR) + "stroke_traces");
+
+    const QStringList presets = presetsDir.entryList(QStringList() << "*.kpp", QDir::Files, QDir::Name);
+    const QStringList traces = tracesDir.entryList(QStringList() << "*.xml", QDir::Files, QDir::Name);
+
+    const QStringList colorDepths =
+        QStringList() << Integer8BitsColorDepthID.id()
+                      << Integer16BitsColorDepthID.id()
+                      << Float32BitsColorDepthID.id();
+
+    Q_FOREACH (const QString &trace, traces) {
+        Q_FOREACH (const QString &preset, presets) {
+            Q_FOREACH (const QString &depth, colorDepths) {
+                const QString rowName = QString("%1-%2-%3").arg(QFileInfo(trace).baseName())
+                                                           .arg(QFileInfo(preset).baseName())
+                                                           .arg(depth);
+
+                // StrokeTester looks for the presets relative to the data directory
+                QTest::newRow(rowName.toLatin1())
+                    << QDir(FILES_DATA_DIR).relativeFilePath(presetsDir.absoluteFilePath(preset))
+                    << depth
+                    << tracesDir.absoluteFilePath(trace);
+            }
+        }
+    }
+}
+
+void FreehandStrokeReplayBenchmark::testReplay()
+{
+    QFETCH(QString, presetFileName);
+    QFETCH(QString, colorDepthId);
+    QFETCH(QString, traceFileName);
+
+    KisStrokeTrace trace;
+    QVERIFY(trace.load(traceFileName));
+
+    if (trace.isEmpty()) {
+        QSKIP("The trace has no strokes");
+    }
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+    QVERIFY(cs);
+
+    FreehandStrokeReplayTester tester(presetFileName, cs, trace);
+    tester.benchmark();
+
+    const QVector<qreal> jobTimes = tester.jobTimes();
+    const QVector<qreal> latencies = tester.latencies();
+
+    const qreal busyTime = std::accumulate(jobTimes.begin(), jobTimes.end(), 0.0);
+    const qreal dabsPerSecond = busyTime > 0 ? tester.numDabs() / busyTime * 1000.0 : 0.0;
+
+    qDebug() << qPrintable(
+        QString("Dabs: %1 Dabs/sec: %2 Job: avg %3 p99 %4 (ms) Latency: avg %5 p99 %6 (ms)")
+            .arg(tester.numDabs())
+            .arg(dabsPerSecond, 0, 'f', 0)
+            .arg(mean(jobTimes), 0, 'f', 2)
+            .arg(percentile(jobTimes, 0.99), 0, 'f', 2)
+            .arg(mean(latencies), 0, 'f', 2)
+            .arg(percentile(latencies, 0.99), 0, 'f', 2));
+}
+
+QTEST_MAIN(FreehandStrokeReplayBenchmark)
@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FREEHANDSTROKEREPLAYBENCHMARK_H
+#define FREEHANDSTROKEREPLAYBENCHMARK_H
+
+#include <QtTest>
+
+/**
+ * Replays the recorded tablet traces from data/stroke_traces with
+ * every preset from plugins/paintops/defaultpresets on 8-bit, 16-bit
+ * and float canvases. The input is fed with the timing of the
+ * recording, so the reported latency is close to what the user sees.
+ */
+class FreehandStrokeReplayBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void testReplay_data();
+    void testReplay();
+};
+
+#endif // FREEHANDSTROKEREPLAYBENCHMARK_H
@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisStrokeTraceTest.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "KisStrokeTrace.h"
+
+
+namespace {
+
+KisStrokeTrace createTrace(int numStrokes, int numSamples, qreal offset)
+{
+    KisStrokeTrace trace;
+
+    for (int i = 0; i < numStrokes; i++) {
+        trace.beginStroke();
+
+        for (int j = 0; j < numSamples; j++) {
+            trace.addSample(KisPaintInformation(QPointF(offset + i * 100 + j, offset - j), 0.1 * (j % 10)));
+        }
+    }
+
+    return trace;
+}
+
+void compareTraces(const KisStrokeTrace &trace, const QVector<KisStrokeTrace::Stroke> &strokes)
+{
+    QCOMPARE(trace.strokes().size(), strokes.size());
+
+    for (int i = 0; i < strokes.size(); i++) {
+        QCOMPARE(trace.strokes()[i].size(), strokes[i].size());
+
+        for (int j = 0; j < strokes[i].size(); j++) {
+            QCOMPARE(trace.strokes()[i][j].pos(), strokes[i][j].pos());
+            QCOMPARE(trace.strokes()[i][j].pressure(), strokes[i][j].pressure());
+        }
+    }
+}
+
+}
+
+void KisStrokeTraceTest::testSaveLoad()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + "/trace.xml";
+
+    KisStrokeTrace trace = createTrace(3, 17, 0);
+    QVERIFY(trace.save(fileName));
+
+    KisStrokeTrace loadedTrace;
+    QVERIFY(loadedTrace.load(fileName));
+    compareTraces(loadedTrace, trace.strokes());
+}
+
+void KisStrokeTraceTest::testAppend()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + "/trace.xml";
+
+    KisStrokeTrace trace1 = createTrace(1, 17, 0);
+    KisStrokeTrace trace2 = createTrace(2, 5, 1000);
+    KisStrokeTrace trace3 = createTrace(1, 9, 2000);
+
+    // the first append creates the file
+    QVERIFY(trace1.append(fileName));
+    QVERIFY(trace2.append(fileName));
+
+    QVector<KisStrokeTrace::Stroke> expectedStrokes =
+        trace1.strokes() + trace2.strokes();
+
+    KisStrokeTrace loadedTrace;
+    QVERIFY(loadedTrace.load(fileName));
+    compareTraces(loadedTrace, expectedStrokes);
+
+    // appending to a saved trace continues it
+    QVERIFY(loadedTrace.save(fileName));
+    QVERIFY(trace3.append(fileName));
+
+    expectedStrokes += trace3.strokes();
+
+    QVERIFY(loadedTrace.load(fileName));
+    compareTraces(loadedTrace, expectedStrokes);
+}
+
+void KisStrokeTraceTest::testAppendToCorruptedFile()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + "/trace.xml";
+
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("<!DOCTYPE strokeTrace>\n<strokeTrace version=\"1\">\n<stroke>");
+    }
+
+    const qint64 size = QFileInfo(fileName).size();
+
+    KisStrokeTrace trace = createTrace(1, 5, 0);
+    QVERIFY(!trace.append(fileName));
+
+    // the existing data is not touched
+    QCOMPARE(QFileInfo(fileName).size(), size);
+}
+
+QTEST_MAIN(KisStrokeTraceTest)
@@ -0,0 +1,196 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisStrokeTrace.h"
+
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+#include <QTextStream>
+
+#include "kis_debug.h"
+
+
+void KisStrokeTrace::beginStroke()
+{
+    m_strokes.append(Stroke());
+}
+
+void KisStrokeTrace::addSample(const KisPaintInformation &pi)
+{
+    if (m_strokes.isEmpty()) {
+        beginStroke();
+    }
+
+    m_strokes.last().append(pi);
+}
+
+const QVector<KisStrokeTrace::Stroke>& KisStrokeTrace::strokes() const
+{
+    return m_strokes;
+}
+
+int KisStrokeTrace::numSamples() const
+{
+    int result = 0;
+
+    Q_FOREACH (const Stroke &stroke, m_strokes) {
+        result += stroke.size();
+    }
+
+    return result;
+}
+
+bool KisStrokeTrace::isEmpty() const
+{
+    return m_strokes.isEmpty();
+}
+
+void KisStrokeTrace::clear()
+{
+    m_strokes.clear();
+}
+
+namespace {
+
+const QByteArray traceHeader = "<!DOCTYPE strokeTrace>\n<strokeTrace version=\"1\">\n";
+const QByteArray traceFooter = "</strokeTrace>\n";
+
+QByteArray strokesToXML(const QVector<KisStrokeTrace::Stroke> &strokes)
+{
+    QDomDocument doc;
+    QByteArray result;
+
+    Q_FOREACH (const KisStrokeTrace::Stroke &stroke, strokes) {
+        QDomElement strokeElement = doc.createElement("stroke");
+
+        Q_FOREACH (const KisPaintInformation &pi, stroke) {
+            QDomElement sampleElement = doc.createElement("sample");
+            pi.toXML(doc, sampleElement);
+            strokeElement.appendChild(sampleElement);
+        }
+
+        QString text;
+        QTextStream stream(&text);
+        strokeElement.save(stream, 1);
+        stream.flush();
+
+        result += text.toUtf8();
+    }
+
+    return result;
+}
+
+}
+
+bool KisStrokeTrace::save(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        warnKrita << "Failed to open the stroke trace for writing:" << fileName;
+        return false;
+    }
+
+    file.write(traceHeader);
+    file.write(strokesToXML(m_strokes));
+    file.write(traceFooter);
+
+    return true;
+}
+
+bool KisStrokeTrace::append(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadWrite)) {
+        warnKrita << "Failed to open the stroke trace for writing:" << fileName;
+        return false;
+    }
+
+    if (file.size() == 0) {
+        file.write(traceHeader);
+    } else {
+        /**
+         * The new strokes are written over the closing tag of the
+         * root element, which is then written again after them
+         */
+        const qint64 footerPos = file.size() - traceFooter.size();
+
+        if (footerPos < traceHeader.size() ||
+            !file.seek(footerPos) ||
+            file.read(traceFooter.size()) != traceFooter ||
+            !file.seek(footerPos)) {
+
+            warnKrita << "Failed to append to the stroke trace, the file is corrupted:" << fileName;
+            return false;
+        }
+    }
+
+    file.write(strokesToXML(m_strokes));
+    file.write(traceFooter);
+
+    return true;
+}
+
+bool KisStrokeTrace::load(const QString &fileName)
+{
+    clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        warnKrita << "Failed to open the stroke trace:" << fileName;
+        return false;
+    }
+
+    QDomDocument doc;
+    if (!doc.setContent(&file)) {
+        warnKrita << "Failed to parse the stroke trace:" << fileName;
+        return false;
+    }
+
+    const QDomElement root = doc.documentElement();
+    if (root.tagName() != "strokeTrace") {
+        warnKrita << "Not a stroke trace:" << fileName;
+        return false;
+    }
+
+    for (QDomElement strokeElement = root.firstChildElement("stroke");
+         !strokeElement.isNull();
+         strokeElement = strokeElement.nextSiblingElement("stroke")) {
+
+        beginStroke();
+
+        for (QDomElement sampleElement = strokeElement.firstChildElement("sample");
+             !sampleElement.isNull();
+             sampleElement = sampleElement.nextSiblingElement("sample")) {
+
+            addSample(KisPaintInformation::fromXML(sampleElement));
+        }
+
+        if (m_strokes.last().isEmpty()) {
+            m_strokes.removeLast();
+        }
+    }
+
+    return true;
+}
+
+QString KisStrokeTrace::recordingDirectory()
+{
+    const QString path = QString::fromLocal8Bit(qgetenv("KRITA_STROKE_TRACE_DIR"));
+    return !path.isEmpty() && QDir(path).exists() ? path : QString();
+}
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISSTROKETRACE_H
+#define KISSTROKETRACE_H
+
+#include "kritaui_export.h"
+
+#include <QString>
+#include <QVector>
+
+#include <brushengine/kis_paint_information.h>
+
+
+/**
+ * A recording of the tablet input of a painting session: a list of
+ * strokes, each being a sequence of KisPaintInformation objects
+ * exactly as the freehand tool has passed them to the stroke. The
+ * time of every sample is stored in the paint information itself
+ * and counts from the beginning of its stroke.
+ *
+ * The traces are saved in XML and are used for replaying real-world
+ * input in the benchmarks. To record one, set KRITA_STROKE_TRACE_DIR
+ * to an existing directory before starting Krita. Every freehand
+ * tool session will write a trace file there.
+ */
+class KRITAUI_EXPORT KisStrokeTrace
+{
+public:
+    typedef QVector<KisPaintInformation> Stroke;
+
+public:
+    void beginStroke();
+    void addSample(const KisPaintInformation &pi);
+
+    const QVector<Stroke>& strokes() const;
+    int numSamples() const;
+
+    bool isEmpty() const;
+    void clear();
+
+    bool save(const QString &fileName) const;
+    bool load(const QString &fileName);
+
+    /**
+     * Appends the strokes of the trace to the end of \p fileName,
+     * creating the file if it doesn't exist yet. Only the new strokes
+     * are written, so a session can be recorded stroke by stroke
+     * without rewriting the whole file every time.
+     */
+    bool append(const QString &fileName) const;
+
+    /**
+     * \return the directory for the recorded traces, or an empty
+     *         string if recording is disabled
+     */
+    static QString recordingDirectory();
+
+private:
+    QVector<Stroke> m_strokes;
+};
+
+#endif // KISSTROKETRACE_H
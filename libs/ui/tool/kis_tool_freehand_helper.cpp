@@ -20,6 +20,9 @@
 
 #include <QTimer>
 #include <QQueue>
+#include <QScopedPointer>
+#include <QDateTime>
+#include <QDir>
 
 #include <klocalizedstring.h>
 
@@ -37,6 +40,7 @@
 #include "kis_update_time_monitor.h"
 #include "kis_stabilized_events_sampler.h"
 #include "KisStabilizerDelayedPaintHelper.h"
+#include "KisStrokeTrace.h"
 #include "kis_config.h"
 
 #include "kis_random_source.h"
@@ -114,6 +118,10 @@ struct KisToolFreehandHelper::Private
     int canvasRotation;
     bool canvasMirroredH;
 
+    // recording of the input events, enabled with KRITA_STROKE_TRACE_DIR
+    QScopedPointer<KisStrokeTrace> strokeTrace;
+    QString strokeTraceFileName;
+
     qreal effectiveSmoothnessDistance() const;
 };
 
@@ -147,6 +155,16 @@ KisToolFreehandHelper::KisToolFreehandHelper(KisPaintingInformationBuilder *info
                 [this]() {
                     emit requestExplicitUpdateOutline();
                 });
+
+    const QString traceDirectory = KisStrokeTrace::recordingDirectory();
+    if (!traceDirectory.isEmpty()) {
+        m_d->strokeTrace.reset(new KisStrokeTrace());
+        m_d->strokeTraceFileName =
+            QDir(traceDirectory).filePath(
+                QString("stroke_trace_%1_%2.xml")
+                    .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"))
+                    .arg(quintptr(this), 0, 16));
+    }
 }
 
 KisToolFreehandHelper::~KisToolFreehandHelper()
@@ -253,6 +271,11 @@ void KisToolFreehandHelper::initPaint(KoPointerEvent *event,
         m_d->infoBuilder->startStroke(event, elapsedStrokeTime(), resourceManager);
     qreal startAngle = KisAlgebra2D::directionBetweenPoints(prevPoint, pixelCoords, 0.0);
 
+    if (m_d->strokeTrace) {
+        m_d->strokeTrace->beginStroke();
+        m_d->strokeTrace->addSample(pi);
+    }
+
     initPaintImpl(startAngle,
                   pi,
                   resourceManager,
@@ -443,6 +466,10 @@ void KisToolFreehandHelper::paintEvent(KoPointerEvent *event)
     info.setCanvasRotation( m_d->canvasRotation );
     info.setCanvasHorizontalMirrorState( m_d->canvasMirroredH );
 
+    if (m_d->strokeTrace) {
+        m_d->strokeTrace->addSample(info);
+    }
+
     KisUpdateTimeMonitor::instance()->reportMouseMove(info.pos());
 
     paint(info);
@@ -645,6 +672,12 @@ void KisToolFreehandHelper::endPaint()
 
     m_d->strokesFacade->endStroke(m_d->strokeId);
     m_d->strokeId.clear();
+
+    if (m_d->strokeTrace) {
+        // only the new strokes are written, nothing is lost on a crash
+        m_d->strokeTrace->append(m_d->strokeTraceFileName);
+        m_d->strokeTrace->clear();
+    }
 }
 
 void KisToolFreehandHelper::cancelPaint()
@@ -27,6 +27,7 @@
 #include <kis_convolution_kernel.h>
 #include <kis_convolution_painter.h>
 #include <kis_gaussian_kernel.h>
+#include <kis_fast_gaussian_blur.h>
 
 #include "ui_wdg_gaussian_blur.h"
 
@@ -60,6 +61,7 @@ KisFilterConfigurationSP KisGaussianBlurFilter::factoryConfiguration() const
     config->setProperty("horizRadius", 5);
     config->setProperty("vertRadius", 5);
     config->setProperty("lockAspect", true);
+    config->setProperty("fastApproximation", false);
 
     return config;
 }
@@ -90,6 +92,15 @@ void KisGaussianBlurFilter::processImpl(KisPaintDeviceSP device,
         channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
     }
 
+    if (config->getBool("fastApproximation", false) &&
+        KisFastGaussianBlur::isPreferred(device, horizontalRadius, verticalRadius, channelFlags)) {
+
+        KisFastGaussianBlur::apply(device, rect,
+                                   horizontalRadius, verticalRadius,
+                                   progressUpdater);
+        return;
+    }
+
     KisGaussianKernel::applyGaussian(device, rect,
                                      horizontalRadius, verticalRadius,
                                      channelFlags, progressUpdater);
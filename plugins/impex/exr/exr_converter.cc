@@ -34,6 +34,7 @@
 #include <QMessageBox>
 #include <QDomDocument>
 #include <QThread>
+#include <QtConcurrent>
 
 #include <QFileInfo>
 
@@ -145,16 +146,6 @@ struct EXRConverter::Private {
 
     QString errorMessage;
 
-    template <class WrapperType>
-    void unmultiplyAlpha(typename WrapperType::pixel_type *pixel);
-
-    template<typename _T_>
-    void decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
-
-    template<typename _T_>
-    void decodeData1(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
-
-
     QDomDocument loadExtraLayersInfo(const Imf::Header &header);
     bool checkExtraLayersInfoConsistent(const QDomDocument &doc, std::set<std::string> exrLayerNames);
     void makeLayerNamesUnique(QList<ExrPaintLayerSaveInfo>& informationObjects);
@@ -292,12 +283,17 @@ struct GrayPixelWrapper
     pixel_type &pixel;
 };
 
+/**
+ * \return true if the alpha of the pixel had to be modified
+ */
 template <class WrapperType>
-void EXRConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pixel)
+bool unmultiplyAlpha(typename WrapperType::pixel_type *pixel)
 {
     typedef typename WrapperType::pixel_type pixel_type;
     typedef typename WrapperType::channel_type channel_type;
 
+    bool alphaWasModified = false;
+
     WrapperType srcPixel(*pixel);
 
     if (!srcPixel.checkMultipliedColorsConsistent()) {
@@ -328,6 +324,8 @@ void EXRConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pi
     } else if (srcPixel.alpha() > 0.0) {
         srcPixel.setUnmultiplied(srcPixel.pixel, srcPixel.alpha());
     }
+
+    return alphaWasModified;
 }
 
 template <typename T, typename Pixel, int size, int alphaPos>
@@ -348,114 +346,205 @@ void multiplyAlpha(Pixel *pixel)
     }
 }
 
-template<typename _T_>
-void EXRConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
+/**
+ * The scanlines are read and written in blocks, so that the library
+ * could (de)compress several line buffers in its worker threads at
+ * once, but a whole layer is never kept in memory. Inside a block,
+ * the pixels of all the layers are converted in stripes in parallel.
+ * The blocks and the stripes are aligned to the tiles of the paint
+ * devices, so two threads never write into the same tile.
+ */
+const int exrStripeHeight = 64;
+const int exrBlockHeight = 4 * exrStripeHeight;
+
+inline int alignedBlockEnd(int y, int blockHeight, int end)
 {
-    typedef Rgba<_T_> Rgba;
-
-    QVector<Rgba> pixels(width * height);
-
-    bool hasAlpha = info.channelMap.contains("A");
-
-    Imf::FrameBuffer frameBuffer;
-    Rgba* frameBufferData = (pixels.data()) - xstart - ystart * width;
-    frameBuffer.insert(info.channelMap["R"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->r,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->g,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    frameBuffer.insert(info.channelMap["B"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->b,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    if (hasAlpha) {
-        frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->a,
-                           sizeof(Rgba) * 1,
-                           sizeof(Rgba) * width));
-    }
+    const int offset = ((y % blockHeight) + blockHeight) % blockHeight;
+    return qMin(end, y - offset + blockHeight);
+}
 
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(ystart, height + ystart - 1);
-    Rgba *rgba = pixels.data();
+template <class Coder, class Func>
+void processBlockInStripes(const QVector<Coder*> &coders, int ystart, int numLines, Func func)
+{
+    struct Stripe {
+        Coder *coder;
+        int y;
+        int numLines;
+    };
 
-    QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    while (it.nextPixel()) {
-        if (hasAlpha) {
-            unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
+    QVector<Stripe> stripes;
+    const int end = ystart + numLines;
+
+    Q_FOREACH (Coder *coder, coders) {
+        for (int y = ystart; y < end;) {
+            const int stripeEnd = alignedBlockEnd(y, exrStripeHeight, end);
+            const Stripe stripe = {coder, y, stripeEnd - y};
+            stripes.append(stripe);
+            y = stripeEnd;
         }
+    }
 
-        typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it.rawData());
+    auto processStripe = [func] (Stripe &stripe) {
+        func(stripe.coder, stripe.y, stripe.numLines);
+    };
 
-        dst->red = rgba->r;
-        dst->green = rgba->g;
-        dst->blue = rgba->b;
-        if (hasAlpha) {
-            dst->alpha = rgba->a;
-        } else {
-            dst->alpha = 1.0;
+    if (QThread::idealThreadCount() > 1 && stripes.size() > 1) {
+        QtConcurrent::blockingMap(stripes, processStripe);
+    } else {
+        for (int i = 0; i < stripes.size(); i++) {
+            processStripe(stripes[i]);
         }
-
-        ++rgba;
     }
 }
 
-template<typename _T_>
-void EXRConverter::Private::decodeData1(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
+class Decoder
+{
+public:
+    virtual ~Decoder() {}
+    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int ystart) = 0;
+    virtual void decodeData(int ystart, int numLines) = 0;
+    virtual bool alphaWasModified() const = 0;
+};
+
+/**
+ * The EXR pixel structures have the same layout as the pixels of
+ * Krita's float color spaces, so the unmultiplied lines are copied
+ * into the device as they are
+ */
+template<class WrapperType>
+class DecoderImpl : public Decoder
 {
-    typedef typename GrayPixelWrapper<_T_>::channel_type channel_type;
-    typedef typename GrayPixelWrapper<_T_>::pixel_type pixel_type;
+public:
+    typedef typename WrapperType::channel_type channel_type;
+    typedef typename WrapperType::pixel_type pixel_type;
 
-    KIS_ASSERT_RECOVER_RETURN(
-                layer->paintDevice()->colorSpace()->colorModelId() == GrayAColorModelID);
+    DecoderImpl(KisPaintLayerSP layer, const QStringList &channels, Imf::PixelType pixelType, int xstart, int width)
+        : m_layer(layer),
+          m_channels(channels),
+          m_pixelType(pixelType),
+          m_pixels(width * exrBlockHeight),
+          m_xstart(xstart),
+          m_width(width),
+          m_blockStart(0)
+    {
+    }
 
-    QVector<pixel_type> pixels(width * height);
+    void prepareFrameBuffer(Imf::FrameBuffer*, int ystart) override;
+    void decodeData(int ystart, int numLines) override;
 
-    Q_ASSERT(info.channelMap.contains("G"));
-    dbgFile << "G -> " << info.channelMap["G"];
+    bool alphaWasModified() const override {
+        return m_alphaWasModified.load();
+    }
 
-    bool hasAlpha = info.channelMap.contains("A");
-    dbgFile << "Has Alpha:" << hasAlpha;
+private:
+    static const int pixelChannels = sizeof(pixel_type) / sizeof(channel_type);
 
+    KisPaintLayerSP m_layer;
+    QStringList m_channels;
+    Imf::PixelType m_pixelType;
+    QVector<pixel_type> m_pixels;
+    int m_xstart;
+    int m_width;
+    int m_blockStart;
+    QAtomicInt m_alphaWasModified;
+};
 
-    Imf::FrameBuffer frameBuffer;
-    pixel_type* frameBufferData = (pixels.data()) - xstart - ystart * width;
-    frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->gray,
-                       sizeof(pixel_type) * 1,
-                       sizeof(pixel_type) * width));
+template<class WrapperType>
+void DecoderImpl<WrapperType>::prepareFrameBuffer(Imf::FrameBuffer* frameBuffer, int ystart)
+{
+    m_blockStart = ystart;
+
+    pixel_type* frameBufferData = (m_pixels.data()) - m_xstart - ystart * m_width;
+    for (int k = 0; k < m_channels.size(); ++k) {
+        frameBuffer->insert(m_channels[k].toLatin1().constData(),
+                            Imf::Slice(m_pixelType, (char *) (reinterpret_cast<channel_type*>(frameBufferData) + k),
+                                       sizeof(pixel_type) * 1,
+                                       sizeof(pixel_type) * m_width));
+    }
+}
+
+template<class WrapperType>
+void DecoderImpl<WrapperType>::decodeData(int ystart, int numLines)
+{
+    pixel_type *pixels = m_pixels.data() + (ystart - m_blockStart) * m_width;
+    const int numPixels = numLines * m_width;
+
+    // alpha is the last channel in both RGBA and GrayA pixels
+    const bool hasAlpha = m_channels.size() == pixelChannels;
 
     if (hasAlpha) {
-        frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->alpha,
-                           sizeof(pixel_type) * 1,
-                           sizeof(pixel_type) * width));
+        bool alphaWasModified = false;
+
+        for (int i = 0; i < numPixels; ++i) {
+            alphaWasModified |= unmultiplyAlpha<WrapperType>(pixels + i);
+        }
+
+        if (alphaWasModified) {
+            m_alphaWasModified.fetchAndStoreOrdered(1);
+        }
+    } else {
+        for (int i = 0; i < numPixels; ++i) {
+            reinterpret_cast<channel_type*>(pixels + i)[pixelChannels - 1] = channel_type(1.0);
+        }
     }
 
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(ystart, height + ystart - 1);
+    m_layer->paintDevice()->writeBytes(reinterpret_cast<const quint8*>(pixels),
+                                       QRect(m_xstart, ystart, m_width, numLines));
+}
 
-    pixel_type *srcPtr = pixels.data();
+Decoder* decoder(const ExrPaintLayerInfo& info, KisPaintLayerSP layer, int xstart, int width)
+{
+    const bool hasAlpha = info.channelMap.contains("A");
+    QStringList channels;
 
-    QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    do {
+    switch (info.channelMap.size()) {
+    case 1:
+    case 2: {
+        KIS_ASSERT_RECOVER_RETURN_VALUE(
+                    layer->paintDevice()->colorSpace()->colorModelId() == GrayAColorModelID, 0);
+
+        Q_ASSERT(info.channelMap.contains("G"));
+        dbgFile << "G -> " << info.channelMap["G"];
+        dbgFile << "Has Alpha:" << hasAlpha;
 
+        channels << info.channelMap["G"];
         if (hasAlpha) {
-            unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
+            channels << info.channelMap["A"];
         }
 
-        pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it.rawData());
-
-        dstPtr->gray = srcPtr->gray;
-        dstPtr->alpha = hasAlpha ? srcPtr->alpha : channel_type(1.0);
+        switch (info.imageType) {
+        case IT_FLOAT16:
+            return new DecoderImpl<GrayPixelWrapper<half> >(layer, channels, Imf::HALF, xstart, width);
+        case IT_FLOAT32:
+            return new DecoderImpl<GrayPixelWrapper<float> >(layer, channels, Imf::FLOAT, xstart, width);
+        case IT_UNKNOWN:
+        case IT_UNSUPPORTED:
+            qFatal("Impossible error");
+        }
+        break;
+    }
+    case 3:
+    case 4: {
+        channels << info.channelMap["R"] << info.channelMap["G"] << info.channelMap["B"];
+        if (hasAlpha) {
+            channels << info.channelMap["A"];
+        }
 
-        ++srcPtr;
-    } while (it.nextPixel());
+        switch (info.imageType) {
+        case IT_FLOAT16:
+            return new DecoderImpl<RgbPixelWrapper<half> >(layer, channels, Imf::HALF, xstart, width);
+        case IT_FLOAT32:
+            return new DecoderImpl<RgbPixelWrapper<float> >(layer, channels, Imf::FLOAT, xstart, width);
+        case IT_UNKNOWN:
+        case IT_UNSUPPORTED:
+            qFatal("Impossible error");
+        }
+        break;
+    }
+    default:
+        qFatal("Invalid number of channels: %i", info.channelMap.size());
+    }
+    return 0;
 }
 
 bool recCheckGroup(const ExrGroupLayerInfo& group, QStringList list, int idx1, int idx2)
@@ -795,7 +884,11 @@ KisImageBuilder_Result EXRConverter::decode(const QString &filename)
         d->image->addNode(info.groupLayer, groupLayerParent);
     }
 
-    // Load the layers
+    // Create the layers and their decoders
+    QVector<Decoder*> decoders;
+    QList<KisPaintLayerSP> decodedLayers;
+    QList<KisGroupLayerSP> decodedLayerParents;
+
     for (int i = informationObjects.size() - 1; i >= 0; --i) {
         ExrPaintLayerInfo& info = informationObjects[i];
         if (info.colorSpace) {
@@ -805,43 +898,17 @@ KisImageBuilder_Result EXRConverter::decode(const QString &filename)
             layer->setCompositeOpId(COMPOSITE_OVER);
 
             if (!layer) {
+                qDeleteAll(decoders);
                 return KisImageBuilder_RESULT_FAILURE;
             }
 
-            switch (info.channelMap.size()) {
-            case 1:
-            case 2:
-                // Decode the data
-                switch (info.imageType) {
-                case IT_FLOAT16:
-                    d->decodeData1<half>(file, info, layer, width, dx, dy, height, Imf::HALF);
-                    break;
-                case IT_FLOAT32:
-                    d->decodeData1<float>(file, info, layer, width, dx, dy, height, Imf::FLOAT);
-                    break;
-                case IT_UNKNOWN:
-                case IT_UNSUPPORTED:
-                    qFatal("Impossible error");
-                }
-                break;
-            case 3:
-            case 4:
-                // Decode the data
-                switch (info.imageType) {
-                case IT_FLOAT16:
-                    d->decodeData4<half>(file, info, layer, width, dx, dy, height, Imf::HALF);
-                    break;
-                case IT_FLOAT32:
-                    d->decodeData4<float>(file, info, layer, width, dx, dy, height, Imf::FLOAT);
-                    break;
-                case IT_UNKNOWN:
-                case IT_UNSUPPORTED:
-                    qFatal("Impossible error");
-                }
-                break;
-            default:
-                qFatal("Invalid number of channels: %i", info.channelMap.size());
+            Decoder *layerDecoder = decoder(info, layer, dx, width);
+            if (!layerDecoder) {
+                qDeleteAll(decoders);
+                return KisImageBuilder_RESULT_FAILURE;
             }
+            decoders.append(layerDecoder);
+
             // Check if should set the channels
             if (!info.remappedChannels.isEmpty()) {
                 QList<KisMetaData::Value> values;
@@ -853,13 +920,45 @@ KisImageBuilder_Result EXRConverter::decode(const QString &filename)
                 }
                 layer->metaData()->addEntry(KisMetaData::Entry(KisMetaData::SchemaRegistry::instance()->create("http://krita.org/exrchannels/1.0/" , "exrchannels"), "channelsmap", values));
             }
-            // Add the layer
-            KisGroupLayerSP groupLayerParent = (info.parent) ? info.parent->groupLayer : d->image->rootLayer();
-            d->image->addNode(layer, groupLayerParent);
+
+            decodedLayers.append(layer);
+            decodedLayerParents.append((info.parent) ? info.parent->groupLayer : d->image->rootLayer());
         } else {
             dbgFile << "No decoding " << info.name << " with " << info.channelMap.size() << " channels, and lack of a color space";
         }
     }
+
+    // Decode the data of all the layers in a single pass over the file
+    if (!decoders.isEmpty()) {
+        for (int y = dy; y < dy + height;) {
+            const int blockEnd = alignedBlockEnd(y, exrBlockHeight, dy + height);
+
+            Imf::FrameBuffer frameBuffer;
+            Q_FOREACH (Decoder *decoder, decoders) {
+                decoder->prepareFrameBuffer(&frameBuffer, y);
+            }
+            file.setFrameBuffer(frameBuffer);
+            file.readPixels(y, blockEnd - 1);
+
+            processBlockInStripes(decoders, y, blockEnd - y,
+                                  [] (Decoder *decoder, int y, int numLines) {
+                                      decoder->decodeData(y, numLines);
+                                  });
+
+            y = blockEnd;
+        }
+    }
+
+    Q_FOREACH (Decoder *decoder, decoders) {
+        d->alphaWasModified |= decoder->alphaWasModified();
+    }
+    qDeleteAll(decoders);
+
+    // Add the layers
+    for (int i = 0; i < decodedLayers.size(); ++i) {
+        d->image->addNode(decodedLayers[i], decodedLayerParents[i]);
+    }
+
     // Set projectionColor to opaque
     d->image->setDefaultProjectionColor(KoColor(Qt::transparent, colorSpace));
 
@@ -913,8 +1012,8 @@ class Encoder
 {
 public:
     virtual ~Encoder() {}
-    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int line) = 0;
-    virtual void encodeData(int line) = 0;
+    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int ystart) = 0;
+    virtual void encodeData(int ystart, int numLines) = 0;
 
 };
 
@@ -922,24 +1021,26 @@ template<typename _T_, int size, int alphaPos>
 class EncoderImpl : public Encoder
 {
 public:
-    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width) : file(_file), info(_info), pixels(width), m_width(width) {}
+    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width) : file(_file), info(_info), pixels(width * exrBlockHeight), m_width(width), m_blockStart(0) {}
     ~EncoderImpl() override {}
-    void prepareFrameBuffer(Imf::FrameBuffer*, int line) override;
-    void encodeData(int line) override;
+    void prepareFrameBuffer(Imf::FrameBuffer*, int ystart) override;
+    void encodeData(int ystart, int numLines) override;
 private:
     typedef ExrPixel_<_T_, size> ExrPixel;
     Imf::OutputFile* file;
     const ExrPaintLayerSaveInfo* info;
     QVector<ExrPixel> pixels;
     int m_width;
+    int m_blockStart;
 };
 
 template<typename _T_, int size, int alphaPos>
-void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* frameBuffer, int line)
+void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* frameBuffer, int ystart)
 {
+    m_blockStart = ystart;
+
     int xstart = 0;
-    int ystart = 0;
-    ExrPixel* frameBufferData = (pixels.data()) - xstart - (ystart + line) * m_width;
+    ExrPixel* frameBufferData = (pixels.data()) - xstart - ystart * m_width;
     for (int k = 0; k < size; ++k) {
         frameBuffer->insert(info->channels[k].toUtf8(),
                             Imf::Slice(info->pixelType, (char *) &frameBufferData->data[k],
@@ -949,23 +1050,19 @@ void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* fram
 }
 
 template<typename _T_, int size, int alphaPos>
-void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
+void EncoderImpl<_T_, size, alphaPos>::encodeData(int ystart, int numLines)
 {
-    ExrPixel *rgba = pixels.data();
-    KisHLineIteratorSP it = info->layer->paintDevice()->createHLineIteratorNG(0, line, m_width);
-    do {
-        const _T_* dst = reinterpret_cast < const _T_* >(it->oldRawData());
+    // the pixels of the device have the same layout as ExrPixel
+    ExrPixel *rgba = pixels.data() + (ystart - m_blockStart) * m_width;
+    info->layer->paintDevice()->readBytes(reinterpret_cast<quint8*>(rgba), QRect(0, ystart, m_width, numLines));
 
-        for (int i = 0; i < size; ++i) {
-            rgba->data[i] = dst[i];
-        }
+    if (alphaPos != -1) {
+        const int numPixels = numLines * m_width;
 
-        if (alphaPos != -1) {
-            multiplyAlpha<_T_, ExrPixel, size, alphaPos>(rgba);
+        for (int i = 0; i < numPixels; ++i) {
+            multiplyAlpha<_T_, ExrPixel, size, alphaPos>(rgba + i);
         }
-
-        ++rgba;
-    } while (it->nextPixel());
+    }
 }
 
 Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int width)
@@ -1010,21 +1107,28 @@ Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int w
 
 void encodeData(Imf::OutputFile& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
 {
-    QList<Encoder*> encoders;
+    QVector<Encoder*> encoders;
     Q_FOREACH (const ExrPaintLayerSaveInfo& info, informationObjects) {
         encoders.push_back(encoder(file, info, width));
     }
 
-    for (int y = 0; y < height; ++y) {
+    for (int y = 0; y < height;) {
+        const int blockEnd = alignedBlockEnd(y, exrBlockHeight, height);
+
         Imf::FrameBuffer frameBuffer;
         Q_FOREACH (Encoder* encoder, encoders) {
             encoder->prepareFrameBuffer(&frameBuffer, y);
         }
         file.setFrameBuffer(frameBuffer);
-        Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->encodeData(y);
-        }
-        file.writePixels(1);
+
+        processBlockInStripes(encoders, y, blockEnd - y,
+                              [] (Encoder *encoder, int y, int numLines) {
+                                  encoder->encodeData(y, numLines);
+                              });
+
+        file.writePixels(blockEnd - y);
+
+        y = blockEnd;
     }
     qDeleteAll(encoders);
 }
@@ -27,6 +27,12 @@
 #include <KisMimeDatabase.h>
 #include "filestest.h"
 
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceTraits.h>
+#include <kis_paint_layer.h>
+#include <kis_sequential_iterator.h>
+
 #ifndef FILES_DATA_DIR
 #error "FILES_DATA_DIR not set. A directory with the data used for testing the importing of files in krita"
 #endif
@@ -89,6 +95,67 @@ void KisExrTest::testRoundTrip()
 
 }
 
+void fillHalfLayer(KisPaintDeviceSP dev, const QRect &rc, int seed)
+{
+    KisSequentialIterator it(dev, rc);
+
+    while (it.nextPixel()) {
+        KoRgbF16Traits::Pixel *pixel = reinterpret_cast<KoRgbF16Traits::Pixel*>(it.rawData());
+        pixel->red = half(0.01f * ((it.x() + seed) % 100));
+        pixel->green = half(0.02f * ((it.y() + seed) % 50));
+        pixel->blue = half(0.001f * ((it.x() * it.y() + seed) % 1000));
+        pixel->alpha = half(1.0f);
+    }
+}
+
+void KisExrTest::testRoundTripMultilayer()
+{
+    // the size is not aligned to the blocks of scanlines
+    const QRect rc(0, 0, 301, 517);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float16BitsColorDepthID.id(), "");
+
+    KisImageSP image = new KisImage(0, rc.width(), rc.height(), cs, "exr multilayer");
+
+    for (int i = 0; i < 3; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer%1").arg(i), OPACITY_OPAQUE_U8, cs);
+        fillHalfLayer(layer->paintDevice(), rc, i * 17);
+        image->addNode(layer, image->root());
+    }
+
+    QScopedPointer<KisDocument> doc1(KisPart::instance()->createDocument());
+    doc1->setCurrentImage(image);
+    doc1->setFileBatchMode(true);
+
+    QTemporaryFile savedFile(QDir::tempPath() + QLatin1String("/krita_XXXXXX") + QLatin1String(".exr"));
+    savedFile.setAutoRemove(true);
+    savedFile.open();
+
+    QString savedFileName(savedFile.fileName());
+    QByteArray mimeType(KisMimeDatabase::mimeTypeForFile(savedFileName, false).toLatin1());
+
+    QVERIFY(doc1->exportDocumentSync(QUrl::fromLocalFile(savedFileName), mimeType));
+
+    QScopedPointer<KisDocument> doc2(KisPart::instance()->createDocument());
+    doc2->setFileBatchMode(true);
+    QVERIFY(doc2->importDocument(QUrl::fromLocalFile(savedFileName)));
+    QVERIFY(doc2->image());
+
+    for (int i = 0; i < 3; i++) {
+        const QString name = QString("layer%1").arg(i);
+
+        KisNodeSP original = image->root()->findChildByName(name);
+        KisNodeSP loaded = doc2->image()->root()->findChildByName(name);
+        QVERIFY(original);
+        QVERIFY(loaded);
+
+        QVERIFY(TestUtil::comparePaintDevicesClever<half>(original->paintDevice(), loaded->paintDevice()));
+    }
+
+    savedFile.close();
+}
+
 KISTEST_MAIN(KisExrTest)
 
 
@@ -28,6 +28,7 @@
 #include <QBuffer>
 #include <QByteArray>
 #include <QMessageBox>
+#include <QElapsedTimer>
 
 #include <KoColorSpaceRegistry.h>
 #include <KoColorProfile.h>
@@ -531,12 +532,16 @@ bool KisKraLoadVisitor::loadPaintDeviceFrame(KisPaintDeviceSP device, const QStr
     }
 
     if (m_store->open(location)) {
+        QElapsedTimer timer;
+        timer.start();
+
         if (!policy.read(device, m_store->device())) {
             m_warningMessages << i18n("Could not read pixel data: %1.", location);
             device->disconnect();
             m_store->close();
             return true;
         }
+        dbgFile << "Loaded pixel data" << location << "in" << timer.elapsed() << "ms";
         m_store->close();
     } else {
         m_warningMessages << i18n("Could not load pixel data: %1.", location);
@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisKraSaveLoadBenchmark.h"
+
+#include <QTest>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoDocumentInfo.h>
+
+#include <KisDocument.h>
+#include <KisPart.h>
+#include <kis_image.h>
+#include <kis_group_layer.h>
+#include <kis_paint_layer.h>
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+#include <kis_random_generator.h>
+
+#include <testutil.h>
+#include <sdk/tests/kistest.h>
+
+namespace {
+
+const int imageSize = 2048;
+const int numLayers = 8;
+const QString fileName = "save_load_benchmark.kra";
+
+/**
+ * Fills the device with smooth gradients and a bit of noise, so
+ * that the tiles neither compress into nothing nor stay raw, just
+ * like in a real painting
+ */
+void fillLayer(KisPaintDeviceSP dev, int seed)
+{
+    KisRandomGenerator random(seed);
+    KisSequentialIterator it(dev, QRect(0, 0, imageSize, imageSize));
+
+    while (it.nextPixel()) {
+        const int x = it.x();
+        const int y = it.y();
+        const int noise = random.randomAt(x, y) & 0x7;
+
+        quint8 *pixel = it.rawData();
+        pixel[0] = quint8((x + seed * 37) / 16 + noise);
+        pixel[1] = quint8((y + seed * 53) / 16 + noise);
+        pixel[2] = quint8((x + y) / 32 + noise);
+        pixel[3] = quint8(0xf8 | noise);
+    }
+}
+
+KisDocument* createBenchmarkDocument()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageSize, imageSize, cs, "save/load benchmark");
+
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), OPACITY_OPAQUE_U8);
+        fillLayer(layer->paintDevice(), i);
+        image->addNode(layer, image->root());
+    }
+
+    KisDocument *doc = KisPart::instance()->createDocument();
+    doc->setCurrentImage(image);
+    doc->documentInfo()->setAboutInfo("title", image->objectName());
+
+    return doc;
+}
+
+}
+
+void KisKraSaveLoadBenchmark::initTestCase()
+{
+    QScopedPointer<KisDocument> doc(createBenchmarkDocument());
+    QVERIFY(doc->exportDocumentSync(QUrl::fromLocalFile(fileName), doc->mimeType()));
+}
+
+void KisKraSaveLoadBenchmark::cleanupTestCase()
+{
+    QFile::remove(fileName);
+}
+
+void KisKraSaveLoadBenchmark::benchmarkSave()
+{
+    QScopedPointer<KisDocument> doc(createBenchmarkDocument());
+
+    QBENCHMARK {
+        QVERIFY(doc->exportDocumentSync(QUrl::fromLocalFile(fileName), doc->mimeType()));
+    }
+}
+
+void KisKraSaveLoadBenchmark::benchmarkLoad()
+{
+    QScopedPointer<KisDocument> reference(createBenchmarkDocument());
+
+    QBENCHMARK {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        QVERIFY(doc->loadNativeFormat(fileName));
+        doc->image()->waitForDone();
+
+        QCOMPARE(doc->image()->root()->childCount(), numLayers);
+    }
+
+    // check that the parallel decompression restored the pixels exactly
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    QVERIFY(doc->loadNativeFormat(fileName));
+    doc->image()->waitForDone();
+
+    KisNodeSP refNode = reference->image()->root()->firstChild();
+    KisNodeSP node = doc->image()->root()->firstChild();
+
+    while (refNode && node) {
+        QPoint errorPoint;
+        QVERIFY(TestUtil::comparePaintDevices(errorPoint, refNode->paintDevice(), node->paintDevice()));
+
+        refNode = refNode->nextSibling();
+        node = node->nextSibling();
+    }
+}
+
+KISTEST_MAIN(KisKraSaveLoadBenchmark)
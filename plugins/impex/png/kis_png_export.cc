@@ -65,6 +65,8 @@ KisImportExportFilter::ConversionStatus KisPNGExport::convert(KisDocument *docum
     options.alpha = configuration->getBool("alpha", true);
     options.interlace = configuration->getBool("interlaced", false);
     options.compression = configuration->getInt("compression", 3);
+    options.compressionStrategy = configuration->getInt("compressionStrategy", 0);
+    options.parallelCompression = configuration->getBool("parallelCompression", false);
     options.tryToSaveAsIndexed = configuration->getBool("indexed", false);
     KoColor c(KoColorSpaceRegistry::instance()->rgb8());
     c.fromQColor(Qt::white);
@@ -108,6 +110,8 @@ KisPropertiesConfigurationSP KisPNGExport::defaultConfiguration(const QByteArray
     cfg->setProperty("alpha", true);
     cfg->setProperty("indexed", false);
     cfg->setProperty("compression", 3);
+    cfg->setProperty("compressionStrategy", 0);
+    cfg->setProperty("parallelCompression", false);
     cfg->setProperty("interlaced", false);
 
     KoColor fill_color(KoColorSpaceRegistry::instance()->rgb8());
@@ -170,6 +174,8 @@ void KisWdgOptionsPNG::setConfiguration(const KisPropertiesConfigurationSP cfg)
     interlacing->setChecked(cfg->getBool("interlaced", false));
     compressionLevel->setValue(cfg->getInt("compression", 3));
     compressionLevel->setRange(1, 9, 0);
+    cmbCompressionStrategy->setCurrentIndex(cfg->getInt("compressionStrategy", 0));
+    chkParallelCompression->setChecked(cfg->getBool("parallelCompression", false));
 
     tryToSaveAsIndexed->setVisible(!isThereAlpha);
 
@@ -198,6 +204,8 @@ KisPropertiesConfigurationSP KisWdgOptionsPNG::configuration() const
     bool alpha = this->alpha->isChecked();
     bool interlace = interlacing->isChecked();
     int compression = (int)compressionLevel->value();
+    int compressionStrategy = cmbCompressionStrategy->currentIndex();
+    bool parallelCompression = chkParallelCompression->isChecked();
     bool tryToSaveAsIndexed = this->tryToSaveAsIndexed->isChecked();
     bool saveSRGB = chkSRGB->isChecked();
     bool forceSRGB = chkForceSRGB->isChecked();
@@ -210,6 +218,8 @@ KisPropertiesConfigurationSP KisWdgOptionsPNG::configuration() const
     cfg->setProperty("alpha", alpha);
     cfg->setProperty("indexed", tryToSaveAsIndexed);
     cfg->setProperty("compression", compression);
+    cfg->setProperty("compressionStrategy", compressionStrategy);
+    cfg->setProperty("parallelCompression", parallelCompression);
     cfg->setProperty("interlaced", interlace);
     cfg->setProperty("transparencyFillcolor", transparencyFillcolor);
     cfg->setProperty("saveSRGBProfile", saveSRGB);
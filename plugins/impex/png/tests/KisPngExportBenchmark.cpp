@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisPngExportBenchmark.h"
+
+#include <QTest>
+#include <QBuffer>
+#include <QElapsedTimer>
+
+#include <limits>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_png_converter.h>
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+#include <kis_random_generator.h>
+
+#include <sdk/tests/kistest.h>
+
+namespace {
+
+const int imageWidth = 4096;
+const int imageHeight = 3072;
+
+/**
+ * Smooth gradients with a bit of noise, so that the filters and
+ * deflate have to do some real work
+ */
+KisPaintDeviceSP createBenchmarkDevice(const KoColorSpace *cs)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    const QRect rc(0, 0, imageWidth, imageHeight);
+
+    KisRandomGenerator random(42);
+    KisSequentialIterator it(dev, rc);
+
+    while (it.nextPixel()) {
+        const int x = it.x();
+        const int y = it.y();
+        const int noise = random.randomAt(x, y) & 0x7;
+
+        QColor color(qBound(0, x / 16 + noise, 255),
+                     qBound(0, y / 12 + noise, 255),
+                     qBound(0, (x + y) / 28 + noise, 255),
+                     0xf8 | noise);
+
+        cs->fromQColor(color, it.rawData());
+    }
+
+    return dev;
+}
+
+}
+
+void KisPngExportBenchmark::benchmarkExport_data()
+{
+    QTest::addColumn<bool>("use16Bit");
+    QTest::addColumn<int>("level");
+    QTest::addColumn<int>("strategy");
+    QTest::addColumn<bool>("parallel");
+
+    for (int depth = 0; depth < 2; depth++) {
+        Q_FOREACH (int level, QList<int>() << 1 << 3 << 6 << 9) {
+            // Z_DEFAULT_STRATEGY, Z_FILTERED and Z_RLE
+            Q_FOREACH (int strategy, QList<int>() << 0 << 1 << 3) {
+                for (int parallel = 0; parallel < 2; parallel++) {
+                    const QString name =
+                        QString("%1bit-level%2-strategy%3-%4")
+                        .arg(depth ? 16 : 8)
+                        .arg(level)
+                        .arg(strategy)
+                        .arg(parallel ? "parallel" : "serial");
+
+                    QTest::newRow(name.toLatin1()) << bool(depth) << level << strategy << bool(parallel);
+                }
+            }
+        }
+    }
+}
+
+void KisPngExportBenchmark::benchmarkExport()
+{
+    QFETCH(bool, use16Bit);
+    QFETCH(int, level);
+    QFETCH(int, strategy);
+    QFETCH(bool, parallel);
+
+    const KoColorSpace *cs =
+        use16Bit ?
+        KoColorSpaceRegistry::instance()->rgb16() :
+        KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP dev = createBenchmarkDevice(cs);
+    const QRect rc(0, 0, imageWidth, imageHeight);
+
+    KisPNGOptions options;
+    options.compression = level;
+    options.compressionStrategy = strategy;
+    options.parallelCompression = parallel;
+    options.alpha = true;
+    options.tryToSaveAsIndexed = false;
+
+    QByteArray result;
+    qint64 bestTime = std::numeric_limits<qint64>::max();
+
+    QBENCHMARK {
+        QBuffer buffer(&result);
+        buffer.open(QIODevice::WriteOnly);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        KisPNGConverter converter(0);
+        vKisAnnotationSP_it annotIt = 0;
+        QCOMPARE(converter.buildFile(&buffer, rc, 72.0, 72.0, dev, annotIt, annotIt, options, 0),
+                 KisImageBuilder_RESULT_OK);
+
+        bestTime = qMin(bestTime, timer.elapsed());
+    }
+
+    const qreal megaBytes = qreal(rc.width()) * rc.height() * cs->pixelSize() / (1024 * 1024);
+
+    qDebug() << "throughput:" << megaBytes / qMax(qint64(1), bestTime) * 1000 << "MiB/s"
+             << "file size:" << result.size() / 1024 << "KiB"
+             << "ratio:" << qreal(result.size()) / (megaBytes * 1024 * 1024);
+}
+
+KISTEST_MAIN(KisPngExportBenchmark)
@@ -21,6 +21,14 @@
 
 #include <QTest>
 #include <QCoreApplication>
+#include <QBuffer>
+#include <QtEndian>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_png_converter.h>
+#include <kis_paint_device.h>
 
 #include "filestest.h"
 
@@ -36,5 +44,80 @@ void KisPngTest::testFiles()
     TestUtil::testFiles(QString(FILES_DATA_DIR) + "/sources", QStringList(), QString(), 1);
 }
 
+namespace {
+
+/**
+ * Counts the IDAT chunks of a PNG file. The parallel compression
+ * writes one IDAT chunk per job, that is per 64 rows.
+ */
+int numIDATChunks(const QByteArray &data)
+{
+    int result = 0;
+    int pos = 8; // signature
+
+    while (pos + 8 <= data.size()) {
+        const quint32 length = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data.constData() + pos));
+        if (data.mid(pos + 4, 4) == "IDAT") {
+            result++;
+        }
+        pos += 12 + length;
+    }
+
+    return result;
+}
+
+}
+
+void KisPngTest::testParallelCompression()
+{
+    // the height is not a multiple of the chunk of rows
+    const QRect rc(0, 0, 531, 203);
+    const int numJobs = 4;
+
+    Q_FOREACH (const KoColorSpace *cs, TestUtil::roundTripColorSpaces()) {
+        KisPaintDeviceSP dev = new KisPaintDevice(cs);
+        TestUtil::fillRoundTripPattern(dev, rc);
+
+        const QByteArray refPixels = TestUtil::readDeviceBytes(dev, rc);
+
+        for (int strategy = 0; strategy < 4; strategy++) {
+            for (int parallel = 0; parallel < 2; parallel++) {
+                KisPNGOptions options;
+                options.compression = 6;
+                options.compressionStrategy = strategy;
+                options.parallelCompression = parallel;
+                options.alpha = true;
+                options.tryToSaveAsIndexed = false;
+
+                QBuffer buffer;
+                buffer.open(QIODevice::WriteOnly);
+
+                KisPNGConverter saver(0);
+                vKisAnnotationSP_it annotIt = 0;
+                QCOMPARE(saver.buildFile(&buffer, rc, 72.0, 72.0, dev, annotIt, annotIt, options, 0),
+                         KisImageBuilder_RESULT_OK);
+                buffer.close();
+
+                // the chunked path doesn't depend on the number of cores
+                if (parallel) {
+                    QCOMPARE(numIDATChunks(buffer.data()), numJobs);
+                }
+
+                buffer.open(QIODevice::ReadOnly);
+
+                KisPNGConverter loader(0, true);
+                QCOMPARE(loader.buildImage(&buffer), KisImageBuilder_RESULT_OK);
+
+                KisPaintDeviceSP loadedDev = loader.image()->root()->firstChild()->paintDevice();
+                QCOMPARE(loadedDev->colorSpace()->pixelSize(), cs->pixelSize());
+
+                QVERIFY2(TestUtil::readDeviceBytes(loadedDev, rc) == refPixels,
+                         QString("strategy %1, parallel %2, %3")
+                         .arg(strategy).arg(parallel).arg(cs->id()).toLatin1());
+            }
+        }
+    }
+}
+
 KISTEST_MAIN(KisPngTest)
 
@@ -21,6 +21,8 @@
 #include <QtGlobal>
 #include <QMap>
 #include <QIODevice>
+#include <QThread>
+#include <QtConcurrent>
 
 
 #include <KoColorSpace.h>
@@ -157,8 +159,10 @@ inline typename Traits::channels_type readChannelValue(const QMap<quint16, QByte
 {
     typedef typename Traits::channels_type channels_type;
 
-    if (channelBytes.contains(channelId)) {
-        const QByteArray &bytes = channelBytes[channelId];
+    QMap<quint16, QByteArray>::const_iterator it = channelBytes.constFind(channelId);
+
+    if (it != channelBytes.constEnd()) {
+        const QByteArray &bytes = *it;
         if (col < bytes.size()) {
             return convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(bytes.constData())[col]);
         }
@@ -391,42 +395,110 @@ psd_status psd_unzip_with_prediction(psd_uchar *src_buf, psd_int src_len,
 /* End of third party block                                           */
 /**********************************************************************/
 
-QMap<quint16, QByteArray> fetchChannelsBytes(QIODevice *io, QVector<ChannelInfo*> channelInfoRecords,
-                                            int row, int width, int channelSize, bool processMasks)
+/**
+ * Compressed data of all the rows of a channel, which is read
+ * from the file at once and decoded row by row later
+ */
+struct ChannelRows
+{
+    quint16 channelId = 0;
+    Compression::CompressionType compressionType = Compression::Uncompressed;
+    QByteArray data;
+    QVector<quint32> rowOffsets;
+    QVector<quint32> rowLengths;
+};
+
+QVector<ChannelRows> fetchChannelsRows(QIODevice *io, QVector<ChannelInfo*> channelInfoRecords,
+                                       int height, int width, int channelSize, bool processMasks)
 {
     const int uncompressedLength = width * channelSize;
 
-    QMap<quint16, QByteArray> channelBytes;
+    QVector<ChannelRows> channels;
 
     Q_FOREACH (ChannelInfo *channelInfo, channelInfoRecords) {
         // user supplied masks are ignored here
         if (!processMasks && channelInfo->channelId < -1) continue;
 
-        io->seek(channelInfo->channelDataStart + channelInfo->channelOffset);
+        ChannelRows rows;
+        rows.channelId = channelInfo->channelId;
+        rows.compressionType = channelInfo->compressionType;
 
         if (channelInfo->compressionType == Compression::Uncompressed) {
-            channelBytes[channelInfo->channelId] = io->read(uncompressedLength);
-            channelInfo->channelOffset += uncompressedLength;
+            for (int row = 0; row < height; row++) {
+                rows.rowOffsets << row * uncompressedLength;
+                rows.rowLengths << uncompressedLength;
+            }
         }
         else if (channelInfo->compressionType == Compression::RLE) {
-            int rleLength = channelInfo->rleRowLengths[row];
-            QByteArray compressedBytes = io->read(rleLength);
-            QByteArray uncompressedBytes = Compression::uncompress(uncompressedLength, compressedBytes, channelInfo->compressionType);
-            channelBytes.insert(channelInfo->channelId, uncompressedBytes);
-            channelInfo->channelOffset += rleLength;
+            if (channelInfo->rleRowLengths.size() < height) {
+                QString error = QString("Not enough RLE row lengths: %1 of %2").arg(channelInfo->rleRowLengths.size()).arg(height);
+                dbgFile << "ERROR: fetchChannelsRows:" << error;
+                throw KisAslReaderUtils::ASLParseException(error);
+            }
+
+            quint32 offset = 0;
+            for (int row = 0; row < height; row++) {
+                rows.rowOffsets << offset;
+                rows.rowLengths << channelInfo->rleRowLengths[row];
+                offset += channelInfo->rleRowLengths[row];
+            }
         }
         else {
             QString error = QString("Unsupported Compression mode: %1").arg(channelInfo->compressionType);
-            dbgFile << "ERROR: fetchChannelsBytes:" << error;
+            dbgFile << "ERROR: fetchChannelsRows:" << error;
             throw KisAslReaderUtils::ASLParseException(error);
         }
+
+        const qint64 totalLength = height > 0 ? qint64(rows.rowOffsets.last()) + rows.rowLengths.last() : 0;
+
+        io->seek(channelInfo->channelDataStart + channelInfo->channelOffset);
+        rows.data = io->read(totalLength);
+        channelInfo->channelOffset += totalLength;
+
+        channels << rows;
     }
 
-    return channelBytes;
+    return channels;
+}
+
+/**
+ * Decodes the \p row of every channel into \p channelBytes. The
+ * uncompressed rows are not copied, but point into the channel data,
+ * and the buffers of the compressed ones are reused for every row.
+ */
+void decodeChannelsRow(const QVector<ChannelRows> &channels, int row,
+                       int uncompressedLength,
+                       QMap<quint16, QByteArray> &channelBytes)
+{
+    for (int i = 0; i < channels.size(); i++) {
+        const ChannelRows &rows = channels[i];
+
+        const qint64 offset = rows.rowOffsets[row];
+        const int length = qMax(0, qMin(int(rows.rowLengths[row]), int(rows.data.size() - offset)));
+
+        if (length <= 0) {
+            // the file is truncated, the default values will be used
+            channelBytes.insert(rows.channelId, QByteArray());
+        } else if (rows.compressionType == Compression::Uncompressed) {
+            channelBytes.insert(rows.channelId, QByteArray::fromRawData(rows.data.constData() + offset, length));
+        } else {
+            QByteArray &buffer = channelBytes[rows.channelId];
+            buffer.resize(uncompressedLength);
+
+            Compression::decodePackBits(rows.data.constData() + offset, length,
+                                        buffer.data(), uncompressedLength);
+        }
+    }
 }
 
 typedef boost::function<void(int, const QMap<quint16, QByteArray>&, int, quint8*)> PixelFunc;
 
+/**
+ * The height of the bands of rows decoded in parallel, equal
+ * to the height of the tiles of a paint device
+ */
+const int bandHeight = 64;
+
 void readCommon(KisPaintDeviceSP dev,
                 QIODevice *io,
                 const QRect &layerRect,
@@ -485,19 +557,48 @@ void readCommon(KisPaintDeviceSP dev,
         }
 
     } else {
-        KisHLineIteratorSP it = dev->createHLineIteratorNG(layerRect.left(), layerRect.top(), layerRect.width());
-        for (int i = 0 ; i < layerRect.height(); i++) {
+        const QVector<ChannelRows> channels =
+            fetchChannelsRows(io, infoRecords,
+                              layerRect.height(), layerRect.width(),
+                              channelSize, processMasks);
+
+        const int uncompressedLength = layerRect.width() * channelSize;
+
+        /**
+         * The rows are decoded in bands aligned to the tiles of the
+         * device, so that the bands can be written in parallel without
+         * touching the same tiles.
+         */
+        QVector<QRect> bands;
+        for (int y = layerRect.top(); y <= layerRect.bottom(); ) {
+            const int offsetInTile = ((y % bandHeight) + bandHeight) % bandHeight;
+            const int bandBottom = qMin(layerRect.bottom(), y - offsetInTile + bandHeight - 1);
+            bands << QRect(layerRect.left(), y, layerRect.width(), bandBottom - y + 1);
+            y = bandBottom + 1;
+        }
+
+        auto readBand = [&] (const QRect &band) {
             QMap<quint16, QByteArray> channelBytes;
 
-            channelBytes = fetchChannelsBytes(io, infoRecords,
-                                              i, layerRect.width(),
-                                              channelSize, processMasks);
+            KisHLineIteratorSP it = dev->createHLineIteratorNG(band.left(), band.top(), band.width());
+
+            for (int y = band.top(); y <= band.bottom(); y++) {
+                decodeChannelsRow(channels, y - layerRect.top(), uncompressedLength, channelBytes);
+
+                for (qint64 col = 0; col < band.width(); col++){
+                    pixelFunc(channelSize, channelBytes, col, it->rawData());
+                    it->nextPixel();
+                }
+                it->nextRow();
+            }
+        };
 
-            for (qint64 col = 0; col < layerRect.width(); col++){
-                pixelFunc(channelSize, channelBytes, col, it->rawData());
-                it->nextPixel();
+        if (QThread::idealThreadCount() > 1 && bands.size() > 1) {
+            QtConcurrent::blockingMap(bands, readBand);
+        } else {
+            Q_FOREACH (const QRect &band, bands) {
+                readBand(band);
             }
-            it->nextRow();
         }
     }
 }
@@ -543,7 +644,7 @@ void readAlphaMaskChannels(QIODevice *io,
     readCommon(device, io, layerRect, infoRecords, channelSize, &readAlphaMaskPixelCommon, true);
 }
 
-void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSize, const QRect &rc, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
+void writeCompressedChannelRLE(QIODevice *io, const QVector<QByteArray> &rows, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
 {
     typedef KisAslWriterUtils::OffsetStreamPusher<quint32> Pusher;
     QScopedPointer<Pusher> channelBlockSizeExternalTag;
@@ -557,9 +658,6 @@ void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSi
 
     const bool externalRleBlock = rleBlockOffset >= 0;
 
-    // the start of RLE sizes block
-    const qint64 channelRLESizePos = externalRleBlock ? rleBlockOffset : io->pos();
-
     {
         QScopedPointer<KisOffsetKeeper> rleOffsetKeeper;
 
@@ -568,28 +666,41 @@ void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSi
             io->seek(rleBlockOffset);
         }
 
-        // write zero's for the channel lengths block
-        for(int i = 0; i < rc.height(); ++i) {
+        // the rows are already compressed, so the lengths block
+        // can be written right away
+        Q_FOREACH (const QByteArray &row, rows) {
             // XXX: choose size for PSB!
-            const quint16 fakeRLEBLockSize = 0;
-            SAFE_WRITE_EX(io, fakeRLEBLockSize);
+            const quint16 rleBlockSize = row.size();
+            SAFE_WRITE_EX(io, rleBlockSize);
         }
     }
 
-    quint32 stride = channelSize * rc.width();
-    for (qint32 row = 0; row < rc.height(); ++row) {
-
-        QByteArray uncompressed = QByteArray::fromRawData((const char*)plane + row * stride, stride);
-        QByteArray compressed = Compression::compress(uncompressed, Compression::RLE);
-
-        KisAslWriterUtils::OffsetStreamPusher<quint16> rleExternalTag(io, 0, channelRLESizePos + row * sizeof(quint16));
-
-        if (io->write(compressed) != compressed.size()) {
+    Q_FOREACH (const QByteArray &row, rows) {
+        if (io->write(row) != row.size()) {
             throw KisAslWriterUtils::ASLWriteException("Failed to write image data");
         }
     }
 }
 
+void compressRowsRLE(const quint8 *plane, const int stride, const int numRows, QByteArray *rows)
+{
+    for (int row = 0; row < numRows; ++row) {
+        const char *src = reinterpret_cast<const char*>(plane) + row * stride;
+
+        QByteArray &compressed = rows[row];
+        compressed.resize(Compression::packBitsMaxSize(stride));
+        compressed.resize(Compression::encodePackBits(src, stride, compressed.data()));
+    }
+}
+
+void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSize, const QRect &rc, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
+{
+    QVector<QByteArray> rows(rc.height());
+    compressRowsRLE(plane, channelSize * rc.width(), rc.height(), rows.data());
+
+    writeCompressedChannelRLE(io, rows, sizeFieldOffset, rleBlockOffset, writeCompressionType);
+}
+
 inline void preparePixelForWrite(quint8 *dataPlane,
                                  int numPixels,
                                  int channelSize,
@@ -633,6 +744,45 @@ inline void preparePixelForWrite(quint8 *dataPlane,
     }
 }
 
+/**
+ * Reads the planes of \p rc in the order they are written to PSD:
+ * the color channels in display order, then the alpha channel, which
+ * is moved to the front if \p alphaFirst is set. The caller owns the
+ * returned arrays.
+ */
+QVector<quint8*> readPlanesForWrite(KisPaintDeviceSP dev, const QRect &rc, bool alphaFirst)
+{
+    QVector<quint8* > tmp = dev->readPlanarBytes(rc.x() - dev->x(), rc.y() - dev->y(), rc.width(), rc.height());
+    const KoColorSpace *colorSpace = dev->colorSpace();
+
+    QVector<quint8*> planes;
+    quint8 *alphaPlanePtr = 0;
+
+    QList<KoChannelInfo*> origChannels = colorSpace->channels();
+    Q_FOREACH (KoChannelInfo *ch, KoChannelInfo::displayOrderSorted(origChannels)) {
+        int channelIndex = KoChannelInfo::displayPositionToChannelIndex(ch->displayPosition(), origChannels);
+
+        quint8 *holder = 0;
+        std::swap(holder, tmp[channelIndex]);
+
+        if (ch->channelType() == KoChannelInfo::ALPHA) {
+            std::swap(holder, alphaPlanePtr);
+        } else {
+            planes.append(holder);
+        }
+    }
+
+    if (alphaPlanePtr) {
+        if (alphaFirst) {
+            planes.insert(0, alphaPlanePtr);
+        } else {
+            planes.append(alphaPlanePtr);
+        }
+    }
+
+    return planes;
+}
+
 void writePixelDataCommon(QIODevice *io,
                           KisPaintDeviceSP dev,
                           const QRect &rc,
@@ -645,77 +795,92 @@ void writePixelDataCommon(QIODevice *io,
     // Empty rects must be processed separately on a higher level!
     KIS_ASSERT_RECOVER_RETURN(!rc.isEmpty());
 
-    QVector<quint8* > tmp = dev->readPlanarBytes(rc.x() - dev->x(), rc.y() - dev->y(), rc.width(), rc.height());
     const KoColorSpace *colorSpace = dev->colorSpace();
+    const int numPlanes = colorSpace->channelCount();
 
-    QVector<quint8*> planes;
+    bool hasAlpha = false;
+    Q_FOREACH (KoChannelInfo *ch, colorSpace->channels()) {
+        hasAlpha |= ch->channelType() == KoChannelInfo::ALPHA;
+    }
 
-    { // prepare 'planes' array
+    if (hasAlpha) {
+        if (alphaFirst) {
+            KIS_ASSERT_RECOVER_NOOP(writingInfoList.first().channelId == -1);
+        } else {
+            KIS_ASSERT_RECOVER_NOOP(
+                (writingInfoList.size() == numPlanes - 1) ||
+                (writingInfoList.last().channelId == -1));
+        }
+    }
 
-        quint8 *alphaPlanePtr = 0;
+    KIS_ASSERT_RECOVER_RETURN(numPlanes >= writingInfoList.size());
 
-        QList<KoChannelInfo*> origChannels = colorSpace->channels();
-        Q_FOREACH (KoChannelInfo *ch, KoChannelInfo::displayOrderSorted(origChannels)) {
-            int channelIndex = KoChannelInfo::displayPositionToChannelIndex(ch->displayPosition(), origChannels);
+    const int numChannels = writingInfoList.size();
+    const int stride = channelSize * rc.width();
 
-            quint8 *holder = 0;
-            std::swap(holder, tmp[channelIndex]);
+    /**
+     * The layer is converted and compressed in bands of rows, so only
+     * a few bands are held uncompressed at any moment. All the channels
+     * are compressed before anything is written, because the file
+     * stores the rows of every channel contiguously.
+     */
+    const int bandHeight = 64;
 
-            if (ch->channelType() == KoChannelInfo::ALPHA) {
-                std::swap(holder, alphaPlanePtr);
-            } else {
-                planes.append(holder);
-            }
+    QVector<QRect> bands;
+    for (int y = rc.top(); y <= rc.bottom(); y += bandHeight) {
+        bands << QRect(rc.x(), y, rc.width(), qMin(bandHeight, rc.bottom() - y + 1));
+    }
+
+    QVector<QVector<QByteArray>> compressedRows(numChannels);
+    QVector<QByteArray*> channelRows(numChannels);
+    QVector<qint16> channelIds(numChannels);
+    for (int i = 0; i < numChannels; i++) {
+        compressedRows[i].resize(rc.height());
+        channelRows[i] = compressedRows[i].data();
+        channelIds[i] = writingInfoList[i].channelId;
+    }
+
+    auto compressBand = [&] (const QRect &band) {
+        QVector<quint8*> planes = readPlanesForWrite(dev, band, alphaFirst);
+        const int numPixels = band.width() * band.height();
+        const int firstRow = band.y() - rc.y();
+
+        for (int i = 0; i < numChannels; i++) {
+            preparePixelForWrite(planes[i], numPixels, channelSize, channelIds.at(i), colorMode);
+            compressRowsRLE(planes[i], stride, band.height(), channelRows.at(i) + firstRow);
         }
 
-        if (alphaPlanePtr) {
-            if (alphaFirst) {
-                planes.insert(0, alphaPlanePtr);
-                KIS_ASSERT_RECOVER_NOOP(writingInfoList.first().channelId == -1);
-            } else {
-                planes.append(alphaPlanePtr);
-                KIS_ASSERT_RECOVER_NOOP(
-                    (writingInfoList.size() == planes.size() - 1) ||
-                    (writingInfoList.last().channelId == -1));
-            }
+        Q_FOREACH (quint8 *plane, planes) {
+            delete[] plane;
         }
+    };
 
-        // now planes are holding pointers to quint8 arrays
-        tmp.clear();
+    if (QThread::idealThreadCount() > 1 && bands.size() > 1) {
+        QtConcurrent::blockingMap(bands, compressBand);
+    } else {
+        Q_FOREACH (const QRect &band, bands) {
+            compressBand(band);
+        }
     }
 
-    KIS_ASSERT_RECOVER_RETURN(planes.size() >= writingInfoList.size());
-
-    const int numPixels = rc.width() * rc.height();
-
-    // write down the planes
+    // write down the channels in the required order
 
     try {
-        for (int i = 0; i < writingInfoList.size(); i++) {
+        for (int i = 0; i < numChannels; i++) {
             const ChannelWritingInfo &info = writingInfoList[i];
 
             dbgFile << "\tWriting channel" << i << "psd channel id" << info.channelId;
-
-            preparePixelForWrite(planes[i], numPixels, channelSize, info.channelId, colorMode);
-
             dbgFile << "\t\tchannel start" << ppVar(io->pos());
 
-            writeChannelDataRLE(io, planes[i], channelSize, rc, info.sizeFieldOffset, info.rleBlockOffset, writeCompressionType);
-        }
+            writeCompressedChannelRLE(io, compressedRows[i], info.sizeFieldOffset, info.rleBlockOffset, writeCompressionType);
 
-    } catch (KisAslWriterUtils::ASLWriteException &e) {
-        Q_FOREACH (quint8 *plane, planes) {
-            delete[] plane;
+            // the compressed data is not needed anymore
+            compressedRows[i].clear();
         }
-        planes.clear();
 
+    } catch (KisAslWriterUtils::ASLWriteException &e) {
         throw KisAslWriterUtils::ASLWriteException(PREPEND_METHOD(e.what()));
     }
-
-    Q_FOREACH (quint8 *plane, planes) {
-        delete[] plane;
-    }
-    planes.clear();
 }
 
 }
@@ -97,5 +97,61 @@ void CompressionTest::testCompressionUncompressed()
 
 }
 
+void CompressionTest::testDecodePackBits()
+{
+    // a row wider than the old 30000 bytes limit
+    QByteArray ba(40000, 'a');
+    for (int i = 0; i < ba.size(); i += 7) {
+        ba[i] = char(rand());
+    }
+
+    QByteArray compressed = Compression::compress(ba, Compression::RLE);
+    QByteArray uncompressed(ba.size(), '\xff');
+    Compression::decodePackBits(compressed.constData(), compressed.size(),
+                                uncompressed.data(), uncompressed.size());
+    QCOMPARE(uncompressed, ba);
+
+    // a truncated row is padded with zeros
+    const char truncated[] = { char(-3), 'x', 1, 'a' };
+    QByteArray row(10, '\xff');
+    Compression::decodePackBits(truncated, sizeof(truncated), row.data(), row.size());
+    QCOMPARE(row, QByteArray("xxxxa").append(QByteArray(5, '\0')));
+
+    // 128 is a no-op control byte
+    const char noop[] = { char(-128), 0, 'b' };
+    row = QByteArray(1, '\xff');
+    Compression::decodePackBits(noop, sizeof(noop), row.data(), row.size());
+    QCOMPARE(row, QByteArray("b"));
+}
+
+void CompressionTest::testEncodePackBits()
+{
+    // runs of every length around the word size and the packet limit
+    for (int runLength = 1; runLength < 300; runLength += 7) {
+        QByteArray ba;
+        for (int i = 0; ba.size() < 1000; i++) {
+            ba.append(QByteArray(i % 2 ? runLength : 3, char(i)));
+            ba.append(char(rand()));
+        }
+
+        QByteArray packed(Compression::packBitsMaxSize(ba.size()), 0);
+        const quint32 packedLength = Compression::encodePackBits(ba.constData(), ba.size(), packed.data());
+        QVERIFY(packedLength <= Compression::packBitsMaxSize(ba.size()));
+
+        QByteArray unpacked(ba.size(), 0);
+        Compression::decodePackBits(packed.constData(), packedLength, unpacked.data(), unpacked.size());
+        QCOMPARE(unpacked, ba);
+    }
+
+    // the worst case for the packed size is pure noise
+    QByteArray noise(1000, 0);
+    for (int i = 0; i < noise.size(); i++) {
+        noise[i] = char(i % 2 ? i : i * 7);
+    }
+    QByteArray packed = Compression::compress(noise, Compression::RLE);
+    QVERIFY(quint32(packed.size()) <= Compression::packBitsMaxSize(noise.size()));
+    QCOMPARE(Compression::uncompress(noise.size(), packed, Compression::RLE), noise);
+}
+
 QTEST_MAIN(CompressionTest)
 
@@ -29,6 +29,8 @@ private Q_SLOTS:
     void testCompressionRLE();
     void testCompressionZIP();
     void testCompressionUncompressed();
+    void testDecodePackBits();
+    void testEncodePackBits();
 
 };
 
@@ -34,6 +34,11 @@
 #include "kis_group_layer.h"
 #include "kis_psd_layer_style.h"
 #include "kis_paint_device_debug_utils.h"
+#include "kis_image.h"
+#include "kis_paint_layer.h"
+#include "kis_sequential_iterator.h"
+#include "kis_random_generator.h"
+#include <KoColorSpaceRegistry.h>
 
 
 void KisPSDTest::testFiles()
@@ -346,6 +351,58 @@ void KisPSDTest::testSavingAllFormats()
     }
 }
 
+void fillBandedLayer(KisPaintDeviceSP dev, const QRect &rc)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+    KisRandomGenerator random(17);
+    KisSequentialIterator it(dev, rc);
+
+    while (it.nextPixel()) {
+        const int x = it.x();
+        const int y = it.y();
+
+        // long runs in the upper half and noise in the lower one,
+        // so that both kinds of PackBits packets are written
+        const int noise = y > rc.center().y() ? random.randomAt(x, y) & 0xff : 0;
+
+        quint8 *pixel = it.rawData();
+        for (quint32 i = 0; i < cs->pixelSize(); i++) {
+            pixel[i] = quint8(x / 37 + y / 5 + i * 29 + noise);
+        }
+        cs->setOpacity(pixel, quint8(0x80 | noise), 1);
+    }
+}
+
+void KisPSDTest::testSaveLoadBandedLayers()
+{
+    // the height is not a multiple of the band height
+    const QRect rc(0, 0, 531, 203);
+
+    Q_FOREACH (const KoColorSpace *cs, TestUtil::roundTripColorSpaces()) {
+        KisImageSP image = new KisImage(0, rc.width(), rc.height(), cs, "psd banded layers");
+
+        KisPaintLayerSP layer = new KisPaintLayer(image, "layer", OPACITY_OPAQUE_U8);
+        fillBandedLayer(layer->paintDevice(), rc);
+        image->addNode(layer, image->root());
+
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        doc->setCurrentImage(image);
+        doc->setFileBatchMode(true);
+
+        QFileInfo dstFileInfo(QDir::currentPath() + QDir::separator() + "test_banded_layers.psd");
+        QVERIFY(doc->exportDocumentSync(QUrl::fromLocalFile(dstFileInfo.absoluteFilePath()), "image/vnd.adobe.photoshop"));
+
+        QSharedPointer<KisDocument> result = openPsdDocument(dstFileInfo);
+        QVERIFY(result->image());
+
+        KisNodeSP resultLayer = result->image()->root()->firstChild();
+        QVERIFY(resultLayer);
+        QCOMPARE(resultLayer->paintDevice()->colorSpace()->id(), cs->id());
+
+        QVERIFY(TestUtil::readDeviceBytes(resultLayer->paintDevice(), rc) ==
+                TestUtil::readDeviceBytes(layer->paintDevice(), rc));
+    }
+}
 
 KISTEST_MAIN(KisPSDTest)
 
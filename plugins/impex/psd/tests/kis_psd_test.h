@@ -40,6 +40,8 @@ private Q_SLOTS:
     void testOpeningFromOpenCanvas();
     void testOpeningAllFormats();
     void testSavingAllFormats();
+
+    void testSaveLoadBandedLayers();
 };
 
 #endif
@@ -38,6 +38,11 @@ void KisBufferStreamContigBase::moveToLine(uint32 lineNumber)
 
 uint32 KisBufferStreamContigBelow16::nextValue()
 {
+    // byte-aligned samples don't need the bit-by-bit unpacking
+    if (m_depth == 8) {
+        return *(m_srcIt++);
+    }
+
     uint8 remain;
     uint32 value;
     remain = (uint8) m_depth;
@@ -59,6 +64,12 @@ uint32 KisBufferStreamContigBelow16::nextValue()
 
 uint32 KisBufferStreamContigBelow32::nextValue()
 {
+    if (m_depth == 16) {
+        const uint32 value = m_srcIt[0] | (m_srcIt[1] << 8);
+        m_srcIt += 2;
+        return value;
+    }
+
     uint8 remain;
     uint32 value;
     remain = (uint8) m_depth;
@@ -80,6 +91,12 @@ uint32 KisBufferStreamContigBelow32::nextValue()
 
 uint32 KisBufferStreamContigAbove32::nextValue()
 {
+    if (m_depth == 32) {
+        const uint32 value = m_srcIt[0] | (m_srcIt[1] << 8) | (m_srcIt[2] << 16) | (uint32(m_srcIt[3]) << 24);
+        m_srcIt += 4;
+        return value;
+    }
+
     uint8 remain;
     uint32 value;
     remain = (uint8) m_depth;
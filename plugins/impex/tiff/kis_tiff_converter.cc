@@ -23,6 +23,9 @@
 
 #include <QFile>
 #include <QApplication>
+#include <QMutex>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <QFileInfo>
 
@@ -53,6 +56,69 @@ typedef size_t tmsize_t;
 namespace
 {
 
+typedef QPair<uint32, uint32> RowRange;
+
+/**
+ * Splits the rows of the image into ranges of whole strips or tile
+ * rows, one range per thread
+ */
+QVector<RowRange> splitRowsIntoRanges(uint32 height, uint32 rowsPerUnit, int numRanges)
+{
+    const uint32 numUnits = (height + rowsPerUnit - 1) / rowsPerUnit;
+    const uint32 unitsPerRange = (numUnits + numRanges - 1) / qMax(1, numRanges);
+
+    QVector<RowRange> ranges;
+    for (uint32 unit = 0; unit < numUnits; unit += unitsPerRange) {
+        ranges << RowRange(unit * rowsPerUnit, qMin(height, (unit + unitsPerRange) * rowsPerUnit));
+    }
+    return ranges;
+}
+
+/**
+ * Reads the ranges of rows of the current directory in parallel. A TIFF
+ * handle cannot be shared between threads, so every job opens its own
+ * handle to the file. The ranges which could not be read this way are
+ * read through \p image afterwards.
+ */
+template <class Func>
+void readRowRanges(TIFF *image, const QString &filename, QVector<RowRange> ranges, Func readRange)
+{
+    if (ranges.size() <= 1 || filename.isEmpty()) {
+        Q_FOREACH (const RowRange &range, ranges) {
+            readRange(image, range.first, range.second);
+        }
+        return;
+    }
+
+    const tdir_t directory = TIFFCurrentDirectory(image);
+    const QByteArray encodedFileName = QFile::encodeName(filename);
+
+    QMutex mutex;
+    QVector<RowRange> failedRanges;
+
+    QtConcurrent::blockingMap(ranges, [&] (const RowRange &range) {
+        TIFF *handle = TIFFOpen(encodedFileName.constData(), "r");
+
+        if (!handle || !TIFFSetDirectory(handle, directory)) {
+            if (handle) {
+                TIFFClose(handle);
+            }
+
+            QMutexLocker l(&mutex);
+            failedRanges << range;
+            return;
+        }
+
+        readRange(handle, range.first, range.second);
+        TIFFClose(handle);
+    });
+
+    Q_FOREACH (const RowRange &range, failedRanges) {
+        dbgFile << "Reading rows" << range.first << "-" << range.second << "on the main handle";
+        readRange(image, range.first, range.second);
+    }
+}
+
 QPair<QString, QString> getColorSpaceForColorType(uint16 sampletype, uint16 color_type, uint16 color_nb_bits, TIFF *image, uint16 &nbchannels, uint16 &extrasamplescount, uint8 &destDepth)
 {
     if (color_type == PHOTOMETRIC_MINISWHITE || color_type == PHOTOMETRIC_MINISBLACK) {
@@ -237,6 +303,7 @@ KisImageBuilder_Result KisTIFFConverter::decode(const QString &filename)
         dbgFile << "Could not open the file, either it does not exist, either it is not a TIFF :" << filename;
         return (KisImageBuilder_RESULT_BAD_FETCH);
     }
+    m_filename = filename;
     do {
         dbgFile << "Read new sub-image";
         KisImageBuilder_Result result = readTIFFDirectory(image);
@@ -438,9 +505,6 @@ KisImageBuilder_Result KisTIFFConverter::readTIFFDirectory(TIFF* image)
         }
     }
     KisPaintLayer* layer = new KisPaintLayer(m_image.data(), m_image -> nextLayerName(), quint8_MAX);
-    tdata_t buf = 0;
-    tdata_t* ps_buf = 0; // used only for planar configuration separated
-    KisBufferStreamBase* tiffstream;
 
     KisTIFFReaderBase* tiffReader = 0;
 
@@ -557,57 +621,85 @@ KisImageBuilder_Result KisTIFFConverter::readTIFFDirectory(TIFF* image)
         return KisImageBuilder_RESULT_INVALID_ARG;
     }
 
+    /**
+     * The readers, except the YCbCr one, keep no state between the lines
+     * and write into separate lines of the device, so the strips and
+     * the tiles can be decoded and converted by several threads. A color
+     * transformation cannot be shared between threads though.
+     */
+    const bool canReadInParallel = color_type != PHOTOMETRIC_YCBCR && !transform;
+    const int numRanges = canReadInParallel ? QThread::idealThreadCount() : 1;
+
     if (TIFFIsTiled(image)) {
         dbgFile << "tiled image";
         uint32 tileWidth, tileHeight;
-        uint32 x, y;
         TIFFGetField(image, TIFFTAG_TILEWIDTH, &tileWidth);
         TIFFGetField(image, TIFFTAG_TILELENGTH, &tileHeight);
         uint32 linewidth = (tileWidth * depth * nbchannels) / 8;
-        if (planarconfig == PLANARCONFIG_CONTIG) {
-            buf = _TIFFmalloc(TIFFTileSize(image));
-            if (depth < 16) {
-                tiffstream = new KisBufferStreamContigBelow16((uint8*)buf, depth, linewidth);
-            }
-            else if (depth < 32) {
-                tiffstream = new KisBufferStreamContigBelow32((uint8*)buf, depth, linewidth);
-            }
-            else {
-                tiffstream = new KisBufferStreamContigAbove32((uint8*)buf, depth, linewidth);
-            }
-        }
-        else {
-            ps_buf = new tdata_t[nbchannels];
-            uint32 * lineSizes = new uint32[nbchannels];
-            tmsize_t baseSize = TIFFTileSize(image) / nbchannels;
-            for (uint i = 0; i < nbchannels; i++) {
-                ps_buf[i] = _TIFFmalloc(baseSize);
-                lineSizes[i] = tileWidth; // baseSize / lineSizeCoeffs[i];
-            }
-            tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, depth, lineSizes);
-            delete [] lineSizes;
-        }
         dbgFile << linewidth << "" << nbchannels << "" << layer->paintDevice()->colorSpace()->colorChannelCount();
-        for (y = 0; y < height; y += tileHeight) {
-            for (x = 0; x < width; x += tileWidth) {
-                dbgFile << "Reading tile x =" << x << " y =" << y;
-                if (planarconfig == PLANARCONFIG_CONTIG) {
-                    TIFFReadTile(image, buf, x, y, 0, (tsample_t) - 1);
+
+        auto readTiles = [&] (TIFF *handle, uint32 ystart, uint32 yend) {
+            tdata_t buf = 0;
+            tdata_t* ps_buf = 0; // used only for planar configuration separated
+            KisBufferStreamBase* tiffstream;
+
+            if (planarconfig == PLANARCONFIG_CONTIG) {
+                buf = _TIFFmalloc(TIFFTileSize(handle));
+                if (depth < 16) {
+                    tiffstream = new KisBufferStreamContigBelow16((uint8*)buf, depth, linewidth);
+                }
+                else if (depth < 32) {
+                    tiffstream = new KisBufferStreamContigBelow32((uint8*)buf, depth, linewidth);
                 }
                 else {
-                    for (uint i = 0; i < nbchannels; i++) {
-                        TIFFReadTile(image, ps_buf[i], x, y, 0, i);
+                    tiffstream = new KisBufferStreamContigAbove32((uint8*)buf, depth, linewidth);
+                }
+            }
+            else {
+                ps_buf = new tdata_t[nbchannels];
+                uint32 * lineSizes = new uint32[nbchannels];
+                tmsize_t baseSize = TIFFTileSize(handle) / nbchannels;
+                for (uint i = 0; i < nbchannels; i++) {
+                    ps_buf[i] = _TIFFmalloc(baseSize);
+                    lineSizes[i] = tileWidth; // baseSize / lineSizeCoeffs[i];
+                }
+                tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, depth, lineSizes);
+                delete [] lineSizes;
+            }
+
+            for (uint32 y = ystart; y < yend; y += tileHeight) {
+                for (uint32 x = 0; x < width; x += tileWidth) {
+                    dbgFile << "Reading tile x =" << x << " y =" << y;
+                    if (planarconfig == PLANARCONFIG_CONTIG) {
+                        TIFFReadTile(handle, buf, x, y, 0, (tsample_t) - 1);
+                    }
+                    else {
+                        for (uint i = 0; i < nbchannels; i++) {
+                            TIFFReadTile(handle, ps_buf[i], x, y, 0, i);
+                        }
                     }
+                    uint32 realTileWidth = (x + tileWidth) < width ? tileWidth : width - x;
+                    for (uint yintile = 0; y + yintile < height && yintile < tileHeight / vsubsampling;) {
+                        tiffReader->copyDataToChannels(x, y + yintile , realTileWidth, tiffstream);
+                        yintile += 1;
+                        tiffstream->moveToLine(yintile);
+                    }
+                    tiffstream->restart();
                 }
-                uint32 realTileWidth = (x + tileWidth) < width ? tileWidth : width - x;
-                for (uint yintile = 0; y + yintile < height && yintile < tileHeight / vsubsampling;) {
-                    tiffReader->copyDataToChannels(x, y + yintile , realTileWidth, tiffstream);
-                    yintile += 1;
-                    tiffstream->moveToLine(yintile);
+            }
+
+            delete tiffstream;
+            if (planarconfig == PLANARCONFIG_CONTIG) {
+                _TIFFfree(buf);
+            } else {
+                for (uint i = 0; i < nbchannels; i++) {
+                    _TIFFfree(ps_buf[i]);
                 }
-                tiffstream->restart();
+                delete[] ps_buf;
             }
-        }
+        };
+
+        readRowRanges(image, m_filename, splitRowsIntoRanges(height, tileHeight, numRanges), readTiles);
     }
     else {
         dbgFile << "striped image";
@@ -616,64 +708,74 @@ KisImageBuilder_Result KisTIFFConverter::readTIFFDirectory(TIFF* image)
         TIFFGetFieldDefaulted(image, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
         dbgFile << rowsPerStrip << "" << height;
         rowsPerStrip = qMin(rowsPerStrip, height); // when TIFFNumberOfStrips(image) == 1 it might happen that rowsPerStrip is incorrectly set
-        if (planarconfig == PLANARCONFIG_CONTIG) {
-            buf = _TIFFmalloc(stripsize);
-            if (depth < 16) {
-                tiffstream = new KisBufferStreamContigBelow16((uint8*)buf, depth, stripsize / rowsPerStrip);
-            }
-            else if (depth < 32) {
-                tiffstream = new KisBufferStreamContigBelow32((uint8*)buf, depth, stripsize / rowsPerStrip);
-            }
-            else {
-                tiffstream = new KisBufferStreamContigAbove32((uint8*)buf, depth, stripsize / rowsPerStrip);
-            }
-        }
-        else {
-            ps_buf = new tdata_t[nbchannels];
-            uint32 scanLineSize = stripsize / rowsPerStrip;
-            dbgFile << " scanLineSize for each plan =" << scanLineSize;
-            uint32 * lineSizes = new uint32[nbchannels];
-            for (uint i = 0; i < nbchannels; i++) {
-                ps_buf[i] = _TIFFmalloc(stripsize);
-                lineSizes[i] = scanLineSize / lineSizeCoeffs[i];
-            }
-            tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, depth, lineSizes);
-            delete [] lineSizes;
-        }
 
         dbgFile << "Scanline size =" << TIFFRasterScanlineSize(image) << " / strip size =" << TIFFStripSize(image) << " / rowsPerStrip =" << rowsPerStrip << " stripsize/rowsPerStrip =" << stripsize / rowsPerStrip;
-        uint32 y = 0;
         dbgFile << " NbOfStrips =" << TIFFNumberOfStrips(image) << " rowsPerStrip =" << rowsPerStrip << " stripsize =" << stripsize;
-        for (uint32 strip = 0; y < height; strip++) {
+
+        auto readStrips = [&] (TIFF *handle, uint32 ystart, uint32 yend) {
+            tdata_t buf = 0;
+            tdata_t* ps_buf = 0; // used only for planar configuration separated
+            KisBufferStreamBase* tiffstream;
+
             if (planarconfig == PLANARCONFIG_CONTIG) {
-                TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, 0) , buf, (tsize_t) - 1);
+                buf = _TIFFmalloc(stripsize);
+                if (depth < 16) {
+                    tiffstream = new KisBufferStreamContigBelow16((uint8*)buf, depth, stripsize / rowsPerStrip);
+                }
+                else if (depth < 32) {
+                    tiffstream = new KisBufferStreamContigBelow32((uint8*)buf, depth, stripsize / rowsPerStrip);
+                }
+                else {
+                    tiffstream = new KisBufferStreamContigAbove32((uint8*)buf, depth, stripsize / rowsPerStrip);
+                }
             }
             else {
+                ps_buf = new tdata_t[nbchannels];
+                uint32 scanLineSize = stripsize / rowsPerStrip;
+                dbgFile << " scanLineSize for each plan =" << scanLineSize;
+                uint32 * lineSizes = new uint32[nbchannels];
                 for (uint i = 0; i < nbchannels; i++) {
-                    TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, i), ps_buf[i], (tsize_t) - 1);
+                    ps_buf[i] = _TIFFmalloc(stripsize);
+                    lineSizes[i] = scanLineSize / lineSizeCoeffs[i];
                 }
+                tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, depth, lineSizes);
+                delete [] lineSizes;
             }
-            for (uint32 yinstrip = 0 ; yinstrip < rowsPerStrip && y < height ;) {
-                uint linesread = tiffReader->copyDataToChannels(0, y, width, tiffstream);
-                y += linesread;
-                yinstrip += linesread;
-                tiffstream->moveToLine(yinstrip);
+
+            for (uint32 y = ystart; y < yend;) {
+                if (planarconfig == PLANARCONFIG_CONTIG) {
+                    TIFFReadEncodedStrip(handle, TIFFComputeStrip(handle, y, 0) , buf, (tsize_t) - 1);
+                }
+                else {
+                    for (uint i = 0; i < nbchannels; i++) {
+                        TIFFReadEncodedStrip(handle, TIFFComputeStrip(handle, y, i), ps_buf[i], (tsize_t) - 1);
+                    }
+                }
+                for (uint32 yinstrip = 0 ; yinstrip < rowsPerStrip && y < yend ;) {
+                    uint linesread = tiffReader->copyDataToChannels(0, y, width, tiffstream);
+                    y += linesread;
+                    yinstrip += linesread;
+                    tiffstream->moveToLine(yinstrip);
+                }
+                tiffstream->restart();
             }
-            tiffstream->restart();
-        }
+
+            delete tiffstream;
+            if (planarconfig == PLANARCONFIG_CONTIG) {
+                _TIFFfree(buf);
+            } else {
+                for (uint i = 0; i < nbchannels; i++) {
+                    _TIFFfree(ps_buf[i]);
+                }
+                delete[] ps_buf;
+            }
+        };
+
+        readRowRanges(image, m_filename, splitRowsIntoRanges(height, rowsPerStrip, numRanges), readStrips);
     }
     tiffReader->finalize();
     delete[] lineSizeCoeffs;
     delete tiffReader;
-    delete tiffstream;
-    if (planarconfig == PLANARCONFIG_CONTIG) {
-        _TIFFfree(buf);
-    } else {
-        for (uint i = 0; i < nbchannels; i++) {
-            _TIFFfree(ps_buf[i]);
-        }
-        delete[] ps_buf;
-    }
 
     m_image->addNode(KisNodeSP(layer), m_image->rootLayer().data());
     return KisImageBuilder_RESULT_OK;
@@ -65,6 +65,7 @@ private:
 private:
     KisImageSP m_image;
     KisDocument *m_doc;
+    QString m_filename;
     bool m_stop;
 };
 
@@ -19,6 +19,12 @@
 
 #include "kis_tiff_writer_visitor.h"
 
+#include <QAtomicInt>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <zlib.h>
+
 #include <KoColorProfile.h>
 #include <KoColorSpace.h>
 #include <KoID.h>
@@ -58,6 +64,37 @@ namespace
         return false;
 
     }
+
+    /**
+     * Deflate strips are plain zlib streams, so they can be compressed
+     * by several threads and written with TIFFWriteRawStrip(). The
+     * horizontal predictor is simple enough to be applied here for the
+     * integer samples; other codecs and predictors go through libtiff.
+     */
+    bool canCompressStripsInParallel(const KisTIFFOptions *options, uint8 depth, uint16 sample_format)
+    {
+        if (options->compressionType != COMPRESSION_ADOBE_DEFLATE &&
+            options->compressionType != COMPRESSION_DEFLATE) {
+
+            return false;
+        }
+
+        return options->predictor == PREDICTOR_NONE ||
+            (options->predictor == PREDICTOR_HORIZONTAL &&
+             sample_format == SAMPLEFORMAT_UINT &&
+             (depth == 8 || depth == 16));
+    }
+
+    template <typename T>
+    void applyHorizontalPredictor(quint8 *data, int numRows, tsize_t rowSize, int samplesPerPixel)
+    {
+        for (int row = 0; row < numRows; row++) {
+            T *samples = reinterpret_cast<T*>(data + row * rowSize);
+            for (int i = rowSize / sizeof(T) - 1; i >= samplesPerPixel; i--) {
+                samples[i] -= samples[i - samplesPerPixel];
+            }
+        }
+    }
 }
 
 KisTIFFWriterVisitor::KisTIFFWriterVisitor(TIFF*image, KisTIFFOptions* options)
@@ -170,7 +207,8 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
     // Use contiguous configuration
     TIFFSetField(image(), TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
     // Use 8 rows per strip
-    TIFFSetField(image(), TIFFTAG_ROWSPERSTRIP, 8);
+    const int rowsPerStrip = 8;
+    TIFFSetField(image(), TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
 
     // Save profile
     if (m_options->saveProfile) {
@@ -180,45 +218,124 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
             TIFFSetField(image(), TIFFTAG_ICCPROFILE, ba.size(), ba.constData());
         }
     }
-    tsize_t stripsize = TIFFStripSize(image());
-    tdata_t buff = _TIFFmalloc(stripsize);
-    qint32 height = layer->image()->height();
-    qint32 width = layer->image()->width();
-    bool r = true;
-    for (int y = 0; y < height; y++) {
-        KisHLineConstIteratorSP it = pd->createHLineConstIteratorNG(0, y, width);
-        switch (color_type) {
-        case PHOTOMETRIC_MINISBLACK: {
-                quint8 poses[] = { 0, 1 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 1, poses);
-            }
-            break;
-        case PHOTOMETRIC_RGB: {
-                quint8 poses[4];
-                if (sample_format == SAMPLEFORMAT_IEEEFP) {
-                    poses[2] = 2; poses[1] = 1; poses[0] = 0; poses[3] = 3;
-                } else {
-                    poses[0] = 2; poses[1] = 1; poses[2] = 0; poses[3] = 3;
-                }
-                r = copyDataToStrips(it, buff, depth, sample_format, 3, poses);
+    quint8 poses[5];
+    uint8 nbcolorssamples = 0;
+    switch (color_type) {
+    case PHOTOMETRIC_MINISBLACK: {
+            poses[0] = 0; poses[1] = 1;
+            nbcolorssamples = 1;
+        }
+        break;
+    case PHOTOMETRIC_RGB: {
+            if (sample_format == SAMPLEFORMAT_IEEEFP) {
+                poses[2] = 2; poses[1] = 1; poses[0] = 0; poses[3] = 3;
+            } else {
+                poses[0] = 2; poses[1] = 1; poses[2] = 0; poses[3] = 3;
             }
-            break;
-        case PHOTOMETRIC_SEPARATED: {
-                quint8 poses[] = { 0, 1, 2, 3, 4 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 4, poses);
+            nbcolorssamples = 3;
+        }
+        break;
+    case PHOTOMETRIC_SEPARATED: {
+            poses[0] = 0; poses[1] = 1; poses[2] = 2; poses[3] = 3; poses[4] = 4;
+            nbcolorssamples = 4;
+        }
+        break;
+    case PHOTOMETRIC_ICCLAB: {
+            poses[0] = 0; poses[1] = 1; poses[2] = 2; poses[3] = 3;
+            nbcolorssamples = 3;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    const qint32 height = layer->image()->height();
+    const qint32 width = layer->image()->width();
+    const tsize_t scanlineSize = TIFFScanlineSize(image());
+    const int samplesPerPixel = nbcolorssamples + (m_options->alpha ? 1 : 0);
+    const bool compressInParallel = canCompressStripsInParallel(m_options, depth, sample_format);
+
+    /**
+     * The strips are converted (and compressed, if possible) in blocks
+     * by several threads, then written in order by this thread
+     */
+    const int stripsPerBlock = qMax(1, QThread::idealThreadCount()) * 8;
+
+    QAtomicInt failed;
+
+    auto prepareStrip = [&] (QByteArray &strip, int firstRow) {
+        const int numRows = qMin(rowsPerStrip, height - firstRow);
+        QByteArray buff(scanlineSize * numRows, Qt::Uninitialized);
+
+        for (int row = 0; row < numRows; row++) {
+            KisHLineConstIteratorSP it = pd->createHLineConstIteratorNG(0, firstRow + row, width);
+            if (!copyDataToStrips(it, buff.data() + row * scanlineSize, depth, sample_format, nbcolorssamples, poses)) {
+                failed.fetchAndStoreOrdered(1);
+                return;
             }
-            break;
-        case PHOTOMETRIC_ICCLAB: {
-                quint8 poses[] = { 0, 1, 2, 3 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 3, poses);
+        }
+
+        if (!compressInParallel) {
+            strip = buff;
+            return;
+        }
+
+        if (m_options->predictor == PREDICTOR_HORIZONTAL) {
+            if (depth == 8) {
+                applyHorizontalPredictor<quint8>(reinterpret_cast<quint8*>(buff.data()), numRows, scanlineSize, samplesPerPixel);
+            } else {
+                applyHorizontalPredictor<quint16>(reinterpret_cast<quint8*>(buff.data()), numRows, scanlineSize, samplesPerPixel);
             }
-            break;
+        }
+
+        uLongf compressedSize = compressBound(buff.size());
+        strip.resize(compressedSize);
+        if (compress2(reinterpret_cast<Bytef*>(strip.data()), &compressedSize,
+                      reinterpret_cast<const Bytef*>(buff.constData()), buff.size(),
+                      m_options->deflateCompress) != Z_OK) {
+
+            failed.fetchAndStoreOrdered(1);
+            return;
+        }
+        strip.resize(compressedSize);
+    };
+
+    for (int blockStart = 0; blockStart < height; blockStart += stripsPerBlock * rowsPerStrip) {
+        const int firstStrip = blockStart / rowsPerStrip;
+        const int numStrips = qMin(stripsPerBlock, (height - blockStart + rowsPerStrip - 1) / rowsPerStrip);
+
+        QVector<QByteArray> strips(numStrips);
+        QVector<int> indexes(numStrips);
+        for (int i = 0; i < numStrips; i++) {
+            indexes[i] = i;
+        }
+
+        auto prepareStripByIndex = [&] (int index) {
+            prepareStrip(strips[index], blockStart + index * rowsPerStrip);
+        };
+
+        if (numStrips > 1) {
+            QtConcurrent::blockingMap(indexes, prepareStripByIndex);
+        } else {
+            prepareStripByIndex(0);
+        }
+
+        if (failed.load()) {
             return false;
         }
-        if (!r) return false;
-        TIFFWriteScanline(image(), buff, y, (tsample_t) - 1);
+
+        for (int i = 0; i < numStrips; i++) {
+            QByteArray &strip = strips[i];
+            const tsize_t written = compressInParallel ?
+                TIFFWriteRawStrip(image(), firstStrip + i, strip.data(), strip.size()) :
+                TIFFWriteEncodedStrip(image(), firstStrip + i, strip.data(), strip.size());
+
+            if (written < 0) {
+                return false;
+            }
+        }
     }
-    _TIFFfree(buff);
+
     TIFFWriteDirectory(image());
     return true;
 }
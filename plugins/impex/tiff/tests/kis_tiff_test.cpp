@@ -26,6 +26,9 @@
 
 #include <KoColorModelStandardIds.h>
 #include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_properties_configuration.h>
 
 #include "kisexiv2/kis_exiv2.h"
 #include  <sdk/tests/kistest.h>
@@ -115,5 +118,53 @@ void KisTiffTest::testRoundTripRGBF16()
 #endif
 }
 
+void KisTiffTest::testRoundTripCompressedStrips()
+{
+    // the height is not a multiple of the block of strips
+    const QRect rc(0, 0, 333, 221);
+
+    // none, deflate and LZW, as indexes of the export dialog
+    QList<int> compressionTypes;
+    compressionTypes << 0 << 2 << 3;
+
+    Q_FOREACH (const KoColorSpace *cs, TestUtil::roundTripColorSpaces()) {
+        QScopedPointer<KisDocument> doc0(KisPart::instance()->createDocument());
+        doc0->newImage("test", rc.width(), rc.height(), cs, KoColor(Qt::white, cs), QString(), 1.0);
+        doc0->setFileBatchMode(true);
+
+        KisPaintDeviceSP dev = doc0->image()->root()->firstChild()->paintDevice();
+        TestUtil::fillRoundTripPattern(dev, rc, true);
+
+        doc0->image()->refreshGraph();
+        doc0->image()->waitForDone();
+
+        Q_FOREACH (int compressionType, compressionTypes) {
+            for (int predictor = 0; predictor < 2; predictor++) {
+                KisPropertiesConfigurationSP cfg = new KisPropertiesConfiguration();
+                cfg->setProperty("compressiontype", compressionType);
+                cfg->setProperty("predictor", predictor);
+                cfg->setProperty("alpha", true);
+                cfg->setProperty("flatten", true);
+
+                QTemporaryFile tmpFile(QDir::tempPath() + QLatin1String("/krita_XXXXXX") + QLatin1String(".tiff"));
+                tmpFile.open();
+
+                QVERIFY(doc0->exportDocumentSync(QUrl::fromLocalFile(tmpFile.fileName()), "image/tiff", cfg));
+
+                QScopedPointer<KisDocument> doc1(KisPart::instance()->createDocument());
+                doc1->setFileBatchMode(true);
+                QVERIFY(doc1->importDocument(QUrl::fromLocalFile(tmpFile.fileName())));
+                QVERIFY(doc1->image());
+
+                KisPaintDeviceSP result = doc1->image()->root()->firstChild()->paintDevice();
+                QCOMPARE(result->colorSpace()->id(), cs->id());
+
+                QVERIFY2(TestUtil::readDeviceBytes(result, rc) == TestUtil::readDeviceBytes(dev, rc),
+                         QString("compression %1, predictor %2").arg(compressionType).arg(predictor + 1).toLatin1());
+            }
+        }
+    }
+}
+
 KISTEST_MAIN(KisTiffTest)
 
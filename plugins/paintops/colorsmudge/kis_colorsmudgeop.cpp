@@ -39,6 +39,12 @@
 #include <kis_lod_transform.h>
 #include <kis_spacing_information.h>
 #include <KoColorModelStandardIds.h>
+#include <kis_default_bounds_base.h>
+#include <kis_texture_option.h>
+#include <KisDabRenderingExecutor.h>
+#include <KisRenderedDab.h>
+#include <KisRunnableStrokeJobData.h>
+
 
 KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPainter* painter, KisNodeSP node, KisImageSP image)
     : KisBrushBasedPaintOp(settings, painter)
@@ -110,6 +116,47 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
     if(m_overlayModeOption.isChecked()){
         m_preciseImageDeviceWrapper.reset(new KisPrecisePaintDeviceWrapper(m_image->projection()));
     }
+
+    /**
+     * We do our own threading here, so we need to forbid the brushes
+     * to do threading internally
+     */
+    m_brush->setThreadingAllowed(false);
+
+    KisBrushSP baseBrush = m_brush;
+    const int levelOfDetail = painter->device()->defaultBounds()->currentLevelOfDetail();
+
+    KisDabCacheUtils::ResourcesFactory resourcesFactory =
+        [baseBrush, settings, levelOfDetail] () {
+            KisDabCacheUtils::DabRenderingResources *resources =
+                new KisDabCacheUtils::DabRenderingResources();
+            resources->brush = baseBrush->clone();
+            resources->textureOption.reset(new KisTextureProperties(levelOfDetail));
+            resources->textureOption->fillProperties(settings);
+            return resources;
+        };
+
+    m_dabExecutor.reset(
+        new KisDabRenderingExecutor(
+                    KoColorSpaceRegistry::instance()->alpha8(),
+                    resourcesFactory,
+                    painter->runnableStrokeJobsInterface(),
+                    &m_mirrorOption,
+                    &m_precisionOption));
+
+    if (m_smudgeRateOption.getMode() == KisSmudgeOption::SMEARING_MODE) {
+        /**
+        * Disable handling of the subpixel precision. In the smudge op we
+        * should read from the aligned areas of the image, so having
+        * additional internal offsets, created by the subpixel precision,
+        * will worsen the quality (at least because
+        * QRectF(dstDabRect).center() will not point to the real center
+        * of the brush anymore).
+        * Of course, this only really matters with smearing_mode (bug:327235),
+        * and you only notice the lack of subpixel precision in the dulling methods.
+        */
+        m_dabExecutor->disableSubpixelPrecision();
+    }
 }
 
 KisColorSmudgeOp::~KisColorSmudgeOp()
@@ -118,23 +165,6 @@ KisColorSmudgeOp::~KisColorSmudgeOp()
     delete m_hsvTransform;
 }
 
-void KisColorSmudgeOp::updateMask(const KisPaintInformation& info, double scale, double rotation, const QPointF &cursorPoint)
-{
-    static const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
-    static KoColor color(Qt::black, cs);
-
-    m_maskDab = m_dabCache->fetchDab(cs,
-                                     color,
-                                     cursorPoint,
-                                     KisDabShape(scale, 1.0, rotation),
-                                     info,
-                                     1.0,
-                                     &m_dstDabRect);
-
-    // sanity check
-    KIS_ASSERT_RECOVER_NOOP(m_dstDabRect.size() == m_maskDab->bounds().size());
-}
-
 inline void KisColorSmudgeOp::getTopLeftAligned(const QPointF &pos, const QPointF &hotSpot, qint32 *x, qint32 *y)
 {
     QPointF topLeft = pos - hotSpot;
@@ -147,37 +177,12 @@ inline void KisColorSmudgeOp::getTopLeftAligned(const QPointF &pos, const QPoint
 KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
 {
     KisBrushSP brush = m_brush;
-    const bool useDullingMode = m_smudgeRateOption.getMode() == KisSmudgeOption::DULLING_MODE;
-
-    /* This is a fix for dulling + overlay + paint,
-     * this should allow the image to composite paint addition effects correctly
-     * while also respecting overlay mode. */
-    bool useAlternatePrecisionSource = (m_overlayModeOption.isChecked() &&
-                                        useDullingMode &&
-                                        m_preciseImageDeviceWrapper!= nullptr);
-
-    KisPrecisePaintDeviceWrapper &activeWrapper = useAlternatePrecisionSource ? *m_preciseImageDeviceWrapper :
-                                                                                 m_precisePainterWrapper;
 
     // Simple error catching
     if (!painter()->device() || !brush || !brush->canPaintFor(info)) {
         return KisSpacingInformation(1.0);
     }
 
-    if (m_smudgeRateOption.getMode() == KisSmudgeOption::SMEARING_MODE) {
-        /**
-        * Disable handling of the subpixel precision. In the smudge op we
-        * should read from the aligned areas of the image, so having
-        * additional internal offsets, created by the subpixel precision,
-        * will worsen the quality (at least because
-        * QRectF(m_dstDabRect).center() will not point to the real center
-        * of the brush anymore).
-        * Of course, this only really matters with smearing_mode (bug:327235),
-        * and you only notice the lack of subpixel precision in the dulling methods.
-        */
-        m_dabCache->disableSubpixelPrecision();
-    }
-
 #if 0
     //if precision
     KoColor colorSpaceChanger = painter()->paintColor();
@@ -202,20 +207,116 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
                               brush->maskWidth(shape, 0, 0, info),
                               brush->maskHeight(shape, 0, 0, info));
 
-    QPointF hotSpot = brush->hotSpot(shape, info);
+    DabParameters dab;
+    dab.hotSpot = brush->hotSpot(shape, info);
 
     /**
-     * Update the brush mask.
-     *
-     * Upon leaving the function:
-     *   o m_maskDab stores the new mask
-     *   o m_maskBounds stores the extents of the mask paint device
-     *   o m_dstDabRect stores the destination rect where the mask is going
-     *     to be written to
+     * The mask parameters are calculated right away, because the cache
+     * should see the dabs in the order they are painted. The mask itself
+     * is rendered by the executor in a separate job.
      */
-    updateMask(info, scale, rotation, scatteredPos);
+    static const KoColorSpace *maskColorSpace = KoColorSpaceRegistry::instance()->alpha8();
+    static KoColor maskColor(Qt::black, maskColorSpace);
 
-    QPointF newCenterPos = QRectF(m_dstDabRect).center();
+    m_dabExecutor->addDab(KisDabCacheUtils::DabRequestInfo(maskColor, scatteredPos, shape, info, 1.0),
+                          OPACITY_OPAQUE_F, OPACITY_OPAQUE_F);
+
+    dab.isFirstDab = m_firstRun;
+    m_firstRun = false;
+
+    if (!dab.isFirstDab) {
+        const qreal fpOpacity = (qreal(painter()->opacity()) / 255.0) * m_opacityOption.getOpacityf(info);
+
+        if (m_smudgeRateOption.getMode() == KisSmudgeOption::DULLING_MODE &&
+            m_smudgeRadiusOption.isChecked()) {
+
+            /**
+             * The sample rect and the color are calculated with separate
+             * evaluations of the option, exactly as they were when the dab
+             * was painted right here. It keeps the fuzzy sensors consuming
+             * the same random values.
+             */
+            dab.smudgeRadiusSampleValue = m_smudgeRadiusOption.computeSizeLikeValue(info);
+            dab.smudgeRadiusValue = m_smudgeRadiusOption.computeSizeLikeValue(info);
+        }
+
+        if (m_colorRateOption.isChecked()) {
+            // this will apply the opacity (selected by the user) to copyPainter
+            // (but fit the rate inbetween the range 0.0 to (1.0-SmudgeRate))
+            qreal maxColorRate = qMax<qreal>(1.0 - m_smudgeRateOption.getRate(), 0.2);
+            dab.colorRateOpacity = m_colorRateOption.computeOpacity(info, 0.0, maxColorRate, fpOpacity);
+
+            // the current color (foreground color) or a gradient color (if enabled)
+            KoColor color = m_paintColor;
+            m_gradientOption.apply(color, m_gradient, info);
+            if (m_hsvTransform) {
+                Q_FOREACH (KisPressureHSVOption * option, m_hsvOptions) {
+                    option->apply(m_hsvTransform, info);
+                }
+                m_hsvTransform->transform(color.data(), color.data(), 1);
+            }
+            dab.color = color;
+        }
+
+        // set opacity calculated by the rate option
+        dab.smudgeRateOpacity = m_smudgeRateOption.computeOpacity(info, 0.0, 1.0, fpOpacity);
+    }
+
+    /**
+     * The dab itself is painted in doAsyncronousUpdate() when its
+     * mask and the masks of all the previous dabs are ready
+     */
+    m_dabParameters.append(dab);
+
+    return effectiveSpacing(scale, rotation, m_spacingOption, info);
+}
+
+std::pair<int, bool> KisColorSmudgeOp::doAsyncronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    bool someDabsAreStillInQueue = false;
+
+    const QList<KisRenderedDab> readyDabs =
+        m_dabExecutor->takeReadyDabs(m_finalPainter->hasMirroring(), -1, &someDabsAreStillInQueue);
+
+    if (!readyDabs.isEmpty()) {
+        jobs.append(
+            new KisRunnableStrokeJobData(
+                [this, readyDabs] () {
+                    /**
+                     * The executor returns the dabs in the order of paintAt()
+                     * calls. m_dabParameters is accessed by the sequential
+                     * jobs only, so it needs no locking.
+                     */
+                    Q_FOREACH (const KisRenderedDab &dab, readyDabs) {
+                        KIS_SAFE_ASSERT_RECOVER_BREAK(!m_dabParameters.isEmpty());
+                        paintDab(dab, m_dabParameters.takeFirst());
+                    }
+                },
+                KisStrokeJobData::SEQUENTIAL));
+    }
+
+    const int updatePeriod = someDabsAreStillInQueue ? 10 : 40;
+    return std::make_pair(updatePeriod, someDabsAreStillInQueue);
+}
+
+void KisColorSmudgeOp::paintDab(const KisRenderedDab &renderedDab, const DabParameters &dab)
+{
+    const bool useDullingMode = m_smudgeRateOption.getMode() == KisSmudgeOption::DULLING_MODE;
+
+    /* This is a fix for dulling + overlay + paint,
+     * this should allow the image to composite paint addition effects correctly
+     * while also respecting overlay mode. */
+    bool useAlternatePrecisionSource = (m_overlayModeOption.isChecked() &&
+                                        useDullingMode &&
+                                        m_preciseImageDeviceWrapper!= nullptr);
+
+    KisPrecisePaintDeviceWrapper &activeWrapper = useAlternatePrecisionSource ? *m_preciseImageDeviceWrapper :
+                                                                                 m_precisePainterWrapper;
+
+    const QRect dstDabRect = renderedDab.realBounds();
+    KisFixedPaintDeviceSP maskDab = renderedDab.device;
+
+    QPointF newCenterPos = QRectF(dstDabRect).center();
     /**
      * Save the center of the current dab to know where to read the
      * data during the next pass. We do not save scatteredPos here,
@@ -223,21 +324,14 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
      * brush (due to rounding effects), which will result in a
      * really weird quality.
      */
-    QRect srcDabRect = m_dstDabRect.translated((m_lastPaintPos - newCenterPos).toPoint());
+    QRect srcDabRect = dstDabRect.translated((m_lastPaintPos - newCenterPos).toPoint());
 
     m_lastPaintPos = newCenterPos;
 
-    KisSpacingInformation spacingInfo =
-        effectiveSpacing(scale, rotation,
-                         m_spacingOption, info);
-
-    if (m_firstRun) {
-        m_firstRun = false;
-        return spacingInfo;
+    if (dab.isFirstDab) {
+        return;
     }
 
-    const qreal fpOpacity = (qreal(painter()->opacity()) / 255.0) * m_opacityOption.getOpacityf(info);
-
     if (m_image && m_overlayModeOption.isChecked()) {
         m_image->blockUpdates();
         m_backgroundPainter->bitBlt(QPoint(), m_image->projection(), srcDabRect);
@@ -246,25 +340,25 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
     else {
         // IMPORTANT: Clear the temporary painting device to transparent black.
         //            It will only clear the extents of the brush.
-        m_tempDev->clear(QRect(QPoint(), m_dstDabRect.size()));
+        m_tempDev->clear(QRect(QPoint(), dstDabRect.size()));
     }
 
     // stored in the color space of the paintColor
     KoColor dullingFillColor = m_paintColor;
 
-    QPoint canvasLocalSamplePoint = (srcDabRect.topLeft() + hotSpot).toPoint();
+    QPoint canvasLocalSamplePoint = (srcDabRect.topLeft() + dab.hotSpot).toPoint();
 
     if (!useDullingMode) {
         activeWrapper.readRect(srcDabRect);
         m_smudgePainter->bitBlt(QPoint(), activeWrapper.preciseDevice(), srcDabRect);
     } else {
         if (m_smudgeRadiusOption.isChecked()) {
-            const qreal effectiveSize = 0.5 * (m_dstDabRect.width() + m_dstDabRect.height());
+            const qreal effectiveSize = 0.5 * (dstDabRect.width() + dstDabRect.height());
 
-            const QRect sampleRect = m_smudgeRadiusOption.sampleRect(info, effectiveSize, canvasLocalSamplePoint);
+            const QRect sampleRect = m_smudgeRadiusOption.sampleRect(dab.smudgeRadiusSampleValue, effectiveSize, canvasLocalSamplePoint);
             activeWrapper.readRect(sampleRect);
 
-            m_smudgeRadiusOption.apply(&dullingFillColor, info, effectiveSize, canvasLocalSamplePoint.x(), canvasLocalSamplePoint.y(), activeWrapper.preciseDevice());
+            m_smudgeRadiusOption.apply(&dullingFillColor, dab.smudgeRadiusValue, effectiveSize, canvasLocalSamplePoint.x(), canvasLocalSamplePoint.y(), activeWrapper.preciseDevice());
             KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
         } else {
             // get the pixel on the canvas that lies beneath the hot spot
@@ -279,30 +373,20 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
     // if the user selected the color smudge option,
     // we will mix some color into the temporary painting device (m_tempDev)
     if (m_colorRateOption.isChecked()) {
-        // this will apply the opacity (selected by the user) to copyPainter
-        // (but fit the rate inbetween the range 0.0 to (1.0-SmudgeRate))
-        qreal maxColorRate = qMax<qreal>(1.0 - m_smudgeRateOption.getRate(), 0.2);
-        m_colorRateOption.apply(*m_colorRatePainter, info, 0.0, maxColorRate, fpOpacity);
+        m_colorRatePainter->setOpacity(dab.colorRateOpacity);
 
         // paint a rectangle with the current color (foreground color)
         // or a gradient color (if enabled)
         // into the temporary painting device and use the user selected
         // composite mode
-        KoColor color = m_paintColor;
-        m_gradientOption.apply(color, m_gradient, info);
-        if (m_hsvTransform) {
-            Q_FOREACH (KisPressureHSVOption * option, m_hsvOptions) {
-                option->apply(m_hsvTransform, info);
-            }
-            m_hsvTransform->transform(color.data(), color.data(), 1);
-        }
+        KoColor color = dab.color;
 
         if (!useDullingMode) {
             KIS_SAFE_ASSERT_RECOVER(*m_colorRatePainter->device()->colorSpace() == *color.colorSpace()) {
                 color.convertTo(m_colorRatePainter->device()->colorSpace());
             }
 
-            m_colorRatePainter->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
+            m_colorRatePainter->fill(0, 0, dstDabRect.width(), dstDabRect.height(), color);
         } else {
             KIS_SAFE_ASSERT_RECOVER(*dullingFillColor.colorSpace() == *color.colorSpace()) {
                 color.convertTo(dullingFillColor.colorSpace());
@@ -318,10 +402,10 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
 
     if (useDullingMode) {
         KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
-        m_tempDev->fill(QRect(0, 0, m_dstDabRect.width(), m_dstDabRect.height()), dullingFillColor);
+        m_tempDev->fill(QRect(0, 0, dstDabRect.width(), dstDabRect.height()), dullingFillColor);
     }
 
-    m_precisePainterWrapper.readRects(m_finalPainter->calculateAllMirroredRects(m_dstDabRect));
+    m_precisePainterWrapper.readRects(m_finalPainter->calculateAllMirroredRects(dstDabRect));
 
     // if color is disabled (only smudge) and "overlay mode" is enabled
     // then first blit the region under the brush from the image projection
@@ -333,23 +417,23 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
         // TODO: check if this code is correct in mirrored mode! Technically, the
         //       painter renders the mirrored dab only, so we should also prepare
         //       the overlay for it in all the places.
-        m_finalPainter->bitBlt(m_dstDabRect.topLeft(), m_image->projection(), m_dstDabRect);
+        m_finalPainter->bitBlt(dstDabRect.topLeft(), m_image->projection(), dstDabRect);
         m_image->unblockUpdates();
     }
 
     // set opacity calculated by the rate option
-    m_smudgeRateOption.apply(*m_finalPainter, info, 0.0, 1.0, fpOpacity);
+    m_finalPainter->setOpacity(dab.smudgeRateOpacity);
 
     // then blit the temporary painting device on the canvas at the current brush position
     // the alpha mask (maskDab) will be used here to only blit the pixels that are in the area (shape) of the brush
-    m_finalPainter->bitBltWithFixedSelection(m_dstDabRect.x(), m_dstDabRect.y(), m_tempDev, m_maskDab, m_dstDabRect.width(), m_dstDabRect.height());
-    m_finalPainter->renderMirrorMaskSafe(m_dstDabRect, m_tempDev, 0, 0, m_maskDab, !m_dabCache->needSeparateOriginal());
+    m_finalPainter->bitBltWithFixedSelection(dstDabRect.x(), dstDabRect.y(), m_tempDev, maskDab, dstDabRect.width(), dstDabRect.height());
+
+    // the executor returns a private copy of the mask when the painter has mirroring
+    m_finalPainter->renderMirrorMaskSafe(dstDabRect, m_tempDev, 0, 0, maskDab, false);
 
     const QVector<QRect> dirtyRects = m_finalPainter->takeDirtyRegion();
     m_precisePainterWrapper.writeRects(dirtyRects);
     painter()->addDirtyRects(dirtyRects);
-
-    return spacingInfo;
 }
 
 KisSpacingInformation KisColorSmudgeOp::updateSpacingImpl(const KisPaintInformation &info) const
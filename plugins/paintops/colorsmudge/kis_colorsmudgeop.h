@@ -20,6 +20,9 @@
 #define _KIS_COLORSMUDGEOP_H_
 
 #include <QRect>
+#include <QList>
+#include <QPointF>
+#include <QScopedPointer>
 
 #include <kis_brush_based_paintop.h>
 #include <kis_types.h>
@@ -38,11 +41,13 @@
 #include "kis_smudge_radius_option.h"
 #include "KisPrecisePaintDeviceWrapper.h"
 
-class QPointF;
 class KoAbstractGradient;
 class KisBrushBasedPaintOpSettings;
 class KisPainter;
 class KoColorSpace;
+class KisRunnableStrokeJobData;
+class KisDabRenderingExecutor;
+struct KisRenderedDab;
 
 class KisColorSmudgeOp: public KisBrushBasedPaintOp
 {
@@ -50,14 +55,36 @@ public:
     KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPainter* painter, KisNodeSP node, KisImageSP image);
     ~KisColorSmudgeOp() override;
 
+    std::pair<int, bool> doAsyncronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs) override;
+
 protected:
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
 
     KisSpacingInformation updateSpacingImpl(const KisPaintInformation &info) const override;
 
 private:
-    // Sets the m_maskDab _and m_maskDabRect
-    void updateMask(const KisPaintInformation& info, double scale, double rotation, const QPointF &cursorPoint);
+    /**
+     * The values the dab is painted with. They depend on the paint
+     * information, so they are calculated in paintAt(), in the order
+     * of dabs, and wait there until the mask of the dab is rendered.
+     */
+    struct DabParameters
+    {
+        /**
+         * The first dab is never painted, it only defines the
+         * position to smudge the color from for the next dab
+         */
+        bool isFirstDab = false;
+
+        QPointF hotSpot;
+        quint8 smudgeRateOpacity = OPACITY_OPAQUE_U8;
+        quint8 colorRateOpacity = OPACITY_OPAQUE_U8;
+        KoColor color;
+        qreal smudgeRadiusSampleValue = 0.0;
+        qreal smudgeRadiusValue = 0.0;
+    };
+
+    void paintDab(const KisRenderedDab &renderedDab, const DabParameters &dab);
 
     inline void getTopLeftAligned(const QPointF &pos, const QPointF &hotSpot, qint32 *x, qint32 *y);
 
@@ -84,10 +111,16 @@ private:
     KisPressureScatterOption  m_scatterOption;
     KisPressureGradientOption m_gradientOption;
     QList<KisPressureHSVOption*> m_hsvOptions;
-    QRect                     m_dstDabRect;
-    KisFixedPaintDeviceSP     m_maskDab;
     QPointF                   m_lastPaintPos;
 
+    /**
+     * The masks of the dabs are rendered in parallel, but the dabs
+     * themselves are painted in the order of paintAt() calls, because
+     * every dab smudges the result of the previous ones
+     */
+    QScopedPointer<KisDabRenderingExecutor> m_dabExecutor;
+    QList<DabParameters>      m_dabParameters;
+
     KoColorTransformation *m_hsvTransform {0};
     const KoCompositeOp *m_preciseColorRateCompositeOp {0};
 };
@@ -38,6 +38,12 @@ public:
      */
     void apply(KisPainter& painter, const KisPaintInformation& info, qreal scaleMin = 0.0, qreal scaleMax = 1.0, qreal multiplicator = 1.0) const;
 
+    /**
+     * Calculate the opacity the painter would get in apply(),
+     * without touching any painter
+     */
+    quint8 computeOpacity(const KisPaintInformation& info, qreal scaleMin = 0.0, qreal scaleMax = 1.0, qreal multiplicator = 1.0) const;
+
     void setRate(qreal rate) {
         KisCurveOption::setValue(rate);
     }
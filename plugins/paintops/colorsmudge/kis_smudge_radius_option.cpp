@@ -50,7 +50,13 @@ QRect KisSmudgeRadiusOption::sampleRect(const KisPaintInformation& info,
                                         qreal diameter,
                                         const QPoint &pos) const
 {
-    const qreal sliderValue = computeSizeLikeValue(info);
+    return sampleRect(computeSizeLikeValue(info), diameter, pos);
+}
+
+QRect KisSmudgeRadiusOption::sampleRect(qreal sliderValue,
+                                        qreal diameter,
+                                        const QPoint &pos) const
+{
     const int smudgeRadius = ((sliderValue * diameter) * 0.5) / 100.0;
 
     return kisGrowRect(QRect(pos, QSize(1,1)), smudgeRadius + 1);
@@ -65,7 +71,17 @@ void KisSmudgeRadiusOption::apply(KoColor *resultColor,
 {
     if (!isChecked()) return;
 
-    qreal sliderValue = computeSizeLikeValue(info);
+    apply(resultColor, computeSizeLikeValue(info), diameter, posx, posy, dev);
+}
+
+void KisSmudgeRadiusOption::apply(KoColor *resultColor,
+                                  qreal sliderValue,
+                                  qreal diameter,
+                                  qreal posx,
+                                  qreal posy,
+                                  KisPaintDeviceSP dev) const
+{
+    if (!isChecked()) return;
 
     int smudgeRadius = ((sliderValue * diameter) * 0.5) / 100.0;
 
@@ -42,6 +42,19 @@ public:
                qreal posy,
                KisPaintDeviceSP dev) const;
 
+    /**
+     * The same as above, but take the value of the option calculated
+     * in advance with computeSizeLikeValue(). It lets the paintop
+     * sample the color after the paint information is gone.
+     */
+    QRect sampleRect(qreal sliderValue, qreal diameter, const QPoint &pos) const;
+    void apply(KoColor *resultColor,
+               qreal sliderValue,
+               qreal diameter,
+               qreal posx,
+               qreal posy,
+               KisPaintDeviceSP dev) const;
+
     void writeOptionSetting(KisPropertiesConfigurationSP setting) const override;
     void readOptionSetting(const KisPropertiesConfigurationSP setting) override;
 
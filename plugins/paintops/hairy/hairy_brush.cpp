@@ -21,14 +21,15 @@
 #include <KoColor.h>
 #include <KoColorSpace.h>
 #include <KoColorTransformation.h>
-#include <KoCompositeOpRegistry.h>
 
 #include <QVariant>
 #include <QHash>
 #include <QVector>
+#include <QThread>
+#include <QTransform>
+#include <QtConcurrentMap>
 
 #include <kis_types.h>
-#include <kis_random_accessor_ng.h>
 #include <kis_cross_device_color_picker.h>
 #include <kis_fixed_paint_device.h>
 
@@ -37,19 +38,31 @@
 #include <ctime>
 
 
+namespace {
+/**
+ * Threading overhead is not worth it for small brushes
+ */
+const int minBristlesPerChunk = 256;
+}
+
 HairyBrush::HairyBrush()
 {
     m_counter = 0;
     m_lastAngle = 0.0;
     m_oldPressure = 1.0f;
+    m_threadingAllowed = true;
 
     m_saturationId = -1;
-    m_transfo = 0;
 }
 
 HairyBrush::~HairyBrush()
 {
-    delete m_transfo;
+    Q_FOREACH (BristleChunk *chunk, m_chunks) {
+        delete chunk->transfo;
+    }
+    qDeleteAll(m_chunks);
+    m_chunks.clear();
+
     qDeleteAll(m_bristles.begin(), m_bristles.end());
     m_bristles.clear();
 }
@@ -57,17 +70,34 @@ HairyBrush::~HairyBrush()
 
 void HairyBrush::initAndCache()
 {
-    m_compositeOp = m_dab->colorSpace()->compositeOp(COMPOSITE_OVER);
     m_pixelSize = m_dab->colorSpace()->pixelSize();
 
-    if (m_properties->useSaturation) {
-        m_transfo = m_dab->colorSpace()->createColorTransformation("hsv_adjustment", m_params);
-        if (m_transfo) {
-            m_saturationId = m_transfo->parameterId("s");
+    const int bristleCount = m_bristles.size();
+    const int numChunks = !m_threadingAllowed ? 1 :
+        qBound(1, qMin(QThread::idealThreadCount(), bristleCount / minBristlesPerChunk), bristleCount);
+
+    for (int i = 0; i < numChunks; i++) {
+        BristleChunk *chunk = new BristleChunk();
+        chunk->begin = i * bristleCount / numChunks;
+        chunk->end = (i + 1) * bristleCount / numChunks;
+
+        if (m_properties->useSaturation) {
+            chunk->transfo = m_dab->colorSpace()->createColorTransformation("hsv_adjustment", m_params);
+            if (chunk->transfo) {
+                m_saturationId = chunk->transfo->parameterId("s");
+            }
         }
+
+        m_chunks.append(chunk);
     }
 }
 
+void HairyBrush::setThreadingAllowed(bool value)
+{
+    m_threadingAllowed = value;
+    m_depositor.setThreadingAllowed(value);
+}
+
 void HairyBrush::fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density)
 {
     int width = dab->bounds().width();
@@ -103,6 +133,28 @@ void HairyBrush::fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density)
             dabPointer += pixelSize;
         }
     }
+
+    const int bristleCount = m_bristles.size();
+
+    m_bristleX.resize(bristleCount);
+    m_bristleY.resize(bristleCount);
+    m_prevX.resize(bristleCount);
+    m_prevY.resize(bristleCount);
+    m_randomX.resize(bristleCount);
+    m_randomY.resize(bristleCount);
+    m_startX.resize(bristleCount);
+    m_startY.resize(bristleCount);
+    m_endX.resize(bristleCount);
+    m_endY.resize(bristleCount);
+    m_enabled.resize(bristleCount);
+
+    for (int i = 0; i < bristleCount; i++) {
+        m_bristleX[i] = m_bristles[i]->x();
+        m_bristleY[i] = m_bristles[i]->y();
+        m_prevX[i] = m_bristles[i]->prevX();
+        m_prevY[i] = m_bristles[i]->prevY();
+        m_enabled[i] = m_bristles[i]->enabled();
+    }
 }
 
 
@@ -133,11 +185,6 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
     // this pressure controls shear and ink depletion
     qreal pressure = mousePressure * (pi2.pressure() * 2);
 
-    Bristle *bristle = 0;
-    KoColor bristleColor(dab->colorSpace());
-
-    m_dabAccessor = dab->createRandomAccessorNG((int)x1, (int)y1);
-
     m_dab = dab;
 
     // initialization block
@@ -157,69 +204,144 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
         }
     }
 
+    /**
+     * The random offsets are generated sequentially to keep the
+     * same sequence of random numbers as the strokes had before
+     */
     KisRandomSourceSP randomSource = pi2.randomSource();
 
-    qreal fx1, fy1, fx2, fy2;
-    qreal randomX, randomY;
-    qreal shear;
-
-    float inkDeplation = 0.0;
-    int inkDepletionSize = m_properties->inkDepletionCurve.size();
-    int bristleCount = m_bristles.size();
-    int bristlePathSize;
-    qreal threshold = 1.0 - pi2.pressure();
+    const int bristleCount = m_bristles.size();
     for (int i = 0; i < bristleCount; i++) {
+        if (!m_enabled[i]) continue;
 
-        if (!m_bristles.at(i)->enabled()) continue;
-        bristle = m_bristles[i];
+        m_randomX[i] = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
+        m_randomY[i] = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
+    }
 
-        randomX = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
-        randomY = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
+    updateBristlePositions(angle, scale, pressure * m_properties->shearFactor,
+                           !firstStroke() && m_properties->connectedPath);
 
-        shear = pressure * m_properties->shearFactor;
+    const qreal threshold = 1.0 - pi2.pressure();
 
-        m_transform.reset();
-        m_transform.rotateRadians(-angle);
-        m_transform.scale(scale, scale);
-        m_transform.translate(randomX, randomY);
-        m_transform.shear(shear, shear);
+    auto paintChunk = [this, x1, y1, x2, y2, pressure, threshold] (BristleChunk *chunk) {
+        paintBristles(chunk, x1, y1, x2, y2, pressure, threshold);
+    };
 
-        if (firstStroke() || (!m_properties->connectedPath)) {
-            // transform start dab
-            m_transform.map(bristle->x(), bristle->y(), &fx1, &fy1);
-            // transform end dab
-            m_transform.map(bristle->x(), bristle->y(), &fx2, &fy2);
-        }
-        else {
-            // continue the path of the bristle from the previous position
-            fx1 = bristle->prevX();
-            fy1 = bristle->prevY();
-            m_transform.map(bristle->x(), bristle->y(), &fx2, &fy2);
+    if (m_chunks.size() > 1) {
+        QtConcurrent::blockingMap(m_chunks, paintChunk);
+    } else {
+        Q_FOREACH (BristleChunk *chunk, m_chunks) {
+            paintChunk(chunk);
         }
-        // remember the end point
-        bristle->setPrevX(fx2);
-        bristle->setPrevY(fy2);
+    }
 
-        // all coords relative to device position
-        fx1 += x1;
-        fy1 += y1;
+    /**
+     * The chunks cover the bristles in order, so after concatenation
+     * the ink keeps the order in which a single thread would have
+     * painted it
+     */
+    Q_FOREACH (BristleChunk *chunk, m_chunks) {
+        m_depositor.append(chunk->depositor);
+    }
 
-        fx2 += x2;
-        fy2 += y2;
+    m_depositor.deposit(m_dab);
+
+    m_dab = 0;
+}
+
+void HairyBrush::updateBristlePositions(qreal angle, qreal scale, qreal shear, bool continuePath)
+{
+    /**
+     * Every bristle used to be mapped with its own transform:
+     *
+     * rotate(-angle) * scale(scale) * translate(random) * shear(shear)
+     *
+     * The random translation can be moved out of the transform, so the
+     * position is a sum of two linear maps, common for all the bristles,
+     * applied to the position of the bristle and to its random offset.
+     */
+    QTransform bristleTransform;
+    bristleTransform.rotateRadians(-angle);
+    bristleTransform.scale(scale, scale);
+    bristleTransform.shear(shear, shear);
+
+    QTransform offsetTransform;
+    offsetTransform.rotateRadians(-angle);
+    offsetTransform.scale(scale, scale);
+
+    const float a11 = bristleTransform.m11();
+    const float a12 = bristleTransform.m12();
+    const float a21 = bristleTransform.m21();
+    const float a22 = bristleTransform.m22();
+
+    const float b11 = offsetTransform.m11();
+    const float b12 = offsetTransform.m12();
+    const float b21 = offsetTransform.m21();
+    const float b22 = offsetTransform.m22();
+
+    const int bristleCount = m_bristleX.size();
+
+    const float *bristleX = m_bristleX.constData();
+    const float *bristleY = m_bristleY.constData();
+    const float *randomX = m_randomX.constData();
+    const float *randomY = m_randomY.constData();
+    const quint8 *enabled = m_enabled.constData();
+    float *prevX = m_prevX.data();
+    float *prevY = m_prevY.data();
+    float *startX = m_startX.data();
+    float *startY = m_startY.data();
+    float *endX = m_endX.data();
+    float *endY = m_endY.data();
+
+    // this loop has no branches, so it can be vectorized by the compiler
+    for (int i = 0; i < bristleCount; i++) {
+        const float x = a11 * bristleX[i] + a21 * bristleY[i] + b11 * randomX[i] + b21 * randomY[i];
+        const float y = a12 * bristleX[i] + a22 * bristleY[i] + b12 * randomX[i] + b22 * randomY[i];
+
+        // continue the path of the bristle from the previous position
+        startX[i] = continuePath ? prevX[i] : x;
+        startY[i] = continuePath ? prevY[i] : y;
+        endX[i] = x;
+        endY[i] = y;
+
+        // remember the end point, disabled bristles don't move
+        prevX[i] = enabled[i] ? x : prevX[i];
+        prevY[i] = enabled[i] ? y : prevY[i];
+    }
+}
+
+void HairyBrush::paintBristles(BristleChunk *chunk, qreal x1, qreal y1, qreal x2, qreal y2,
+                               qreal pressure, qreal threshold)
+{
+    KoColor bristleColor(m_dab->colorSpace());
+
+    float inkDeplation = 0.0;
+    int inkDepletionSize = m_properties->inkDepletionCurve.size();
+    int bristlePathSize;
+
+    for (int i = chunk->begin; i < chunk->end; i++) {
+        if (!m_enabled[i]) continue;
+
+        Bristle *bristle = m_bristles[i];
 
         if (m_properties->threshold && (bristle->length() < threshold)) continue;
+
+        // all coords relative to device position
+        const QPointF start(m_startX[i] + x1, m_startY[i] + y1);
+        const QPointF end(m_endX[i] + x2, m_endY[i] + y2);
+
         // paint between first and last dab
-        const QVector<QPointF> bristlePath = m_trajectory.getLinearTrajectory(QPointF(fx1, fy1), QPointF(fx2, fy2), 1.0);
-        bristlePathSize = m_trajectory.size();
+        const QVector<QPointF> &bristlePath = chunk->trajectory.getLinearTrajectory(start, end, 1.0);
+        bristlePathSize = chunk->trajectory.size();
 
         memcpy(bristleColor.data(), bristle->color().data() , m_pixelSize);
-        for (int i = 0; i < bristlePathSize ; i++) {
+        for (int j = 0; j < bristlePathSize ; j++) {
 
             if (m_properties->inkDepletionEnabled) {
                 inkDeplation = fetchInkDepletion(bristle, inkDepletionSize);
 
-                if (m_properties->useSaturation && m_transfo != 0) {
-                    saturationDepletion(bristle, bristleColor, pressure, inkDeplation);
+                if (m_properties->useSaturation && chunk->transfo != 0) {
+                    saturationDepletion(bristle, bristleColor, pressure, inkDeplation, chunk->transfo);
                 }
 
                 if (m_properties->useOpacity) {
@@ -233,17 +355,13 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
                 }
             }
 
-            addBristleInk(bristle, bristlePath.at(i), bristleColor);
+            addBristleInk(chunk, bristlePath.at(j), bristleColor);
             bristle->setInkAmount(1.0 - inkDeplation);
             bristle->upIncrement();
         }
-
     }
-    m_dab = 0;
-    m_dabAccessor = 0;
 }
 
-
 inline qreal HairyBrush::fetchInkDepletion(Bristle* bristle, int inkDepletionSize)
 {
     if (bristle->counter() >= inkDepletionSize - 1) {
@@ -254,7 +372,7 @@ inline qreal HairyBrush::fetchInkDepletion(Bristle* bristle, int inkDepletionSiz
 }
 
 
-void HairyBrush::saturationDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDeplation)
+void HairyBrush::saturationDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDeplation, KoColorTransformation *transfo)
 {
     qreal saturation;
     if (m_properties->useWeights) {
@@ -274,12 +392,12 @@ void HairyBrush::saturationDepletion(Bristle * bristle, KoColor &bristleColor, q
                          (1.0 - inkDeplation)) - 1.0;
 
     }
-    m_transfo->setParameter(m_transfo->parameterId("h"), 0.0);
-    m_transfo->setParameter(m_transfo->parameterId("v"), 0.0);
-    m_transfo->setParameter(m_saturationId, saturation);
-    m_transfo->setParameter(3, 1);//sets the type to
-    m_transfo->setParameter(4, false);//sets the colorize to none.
-    m_transfo->transform(bristleColor.data(), bristleColor.data() , 1);
+    transfo->setParameter(transfo->parameterId("h"), 0.0);
+    transfo->setParameter(transfo->parameterId("v"), 0.0);
+    transfo->setParameter(m_saturationId, saturation);
+    transfo->setParameter(3, 1);//sets the type to
+    transfo->setParameter(4, false);//sets the colorize to none.
+    transfo->transform(bristleColor.data(), bristleColor.data() , 1);
 }
 
 void HairyBrush::opacityDepletion(Bristle* bristle, KoColor& bristleColor, qreal pressure, qreal inkDeplation)
@@ -301,108 +419,37 @@ void HairyBrush::opacityDepletion(Bristle* bristle, KoColor& bristleColor, qreal
     bristleColor.setOpacity(opacity);
 }
 
-inline void HairyBrush::addBristleInk(Bristle *bristle,const QPointF &pos, const KoColor &color)
+inline void HairyBrush::addBristleInk(BristleChunk *chunk, const QPointF &pos, const KoColor &color)
 {
-    Q_UNUSED(bristle);
+    // the color changes only when the ink is depleting, the depositor shares it between the pixels
+    chunk->depositor.setColor(color);
+
     if (m_properties->antialias) {
-        if (m_properties->useCompositing) {
-            paintParticle(pos, color);
-        } else {
-            paintParticle(pos, color, 1.0);
-        }
+        const KisParticleDepositor::Operation op =
+            m_properties->useCompositing ?
+            KisParticleDepositor::OverWithOpacity :
+            KisParticleDepositor::AddOpacity;
+
+        // paint wu particle, the opacity is split between top left, right, bottom left, right
+        const quint8 opacity = color.opacityU8();
+        int ipx = int (pos.x());
+        int ipy = int (pos.y());
+        qreal fx = pos.x() - ipx;
+        qreal fy = pos.y() - ipy;
+
+        chunk->depositor.addPixel(ipx, ipy, op, qRound((1.0 - fx) * (1.0 - fy) * opacity) / 255.0);
+        chunk->depositor.addPixel(ipx + 1, ipy, op, qRound((fx) * (1.0 - fy) * opacity) / 255.0);
+        chunk->depositor.addPixel(ipx, ipy + 1, op, qRound((1.0 - fx) * (fy) * opacity) / 255.0);
+        chunk->depositor.addPixel(ipx + 1, ipy + 1, op, qRound((fx) * (fy) * opacity) / 255.0);
     }
     else {
-        int ix = qRound(pos.x());
-        int iy = qRound(pos.y());
-        if (m_properties->useCompositing) {
-            plotPixel(ix, iy, color);
-        }
-        else {
-            darkenPixel(ix, iy, color);
-        }
-    }
-}
-
-void HairyBrush::paintParticle(QPointF pos, const KoColor& color, qreal weight)
-{
-    // opacity top left, right, bottom left, right
-    quint8 opacity = color.opacityU8();
-    opacity *= weight;
-
-    int ipx = int (pos.x());
-    int ipy = int (pos.y());
-    qreal fx = pos.x() - ipx;
-    qreal fy = pos.y() - ipy;
-
-    quint8 btl = qRound((1.0 - fx) * (1.0 - fy) * opacity);
-    quint8 btr = qRound((fx)  * (1.0 - fy) * opacity);
-    quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity);
-    quint8 bbr = qRound((fx)  * (fy)  * opacity);
-
-    const KoColorSpace * cs = m_dab->colorSpace();
-
-    m_dabAccessor->moveTo(ipx  , ipy);
-    btl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btl, 1);
-
-    m_dabAccessor->moveTo(ipx + 1, ipy);
-    btr =  quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btr, 1);
-
-    m_dabAccessor->moveTo(ipx, ipy + 1);
-    bbl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbl, 1);
-
-    m_dabAccessor->moveTo(ipx + 1, ipy + 1);
-    bbr = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbr, 1);
-}
-
-void HairyBrush::paintParticle(QPointF pos, const KoColor& color)
-{
-    // opacity top left, right, bottom left, right
-    memcpy(m_color.data(), color.data(), m_pixelSize);
-    quint8 opacity = color.opacityU8();
-
-    int ipx = int (pos.x());
-    int ipy = int (pos.y());
-    qreal fx = pos.x() - ipx;
-    qreal fy = pos.y() - ipy;
-
-    quint8 btl = qRound((1.0 - fx) * (1.0 - fy) * opacity);
-    quint8 btr = qRound((fx)  * (1.0 - fy) * opacity);
-    quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity);
-    quint8 bbr = qRound((fx)  * (fy)  * opacity);
-
-    m_color.setOpacity(btl);
-    plotPixel(ipx  , ipy, m_color);
+        // without compositing the pixel is darkened only if the opacity of the dab is less than the color
+        const KisParticleDepositor::Operation op =
+            m_properties->useCompositing ?
+            KisParticleDepositor::Over :
+            KisParticleDepositor::CopyIfMoreOpaque;
 
-    m_color.setOpacity(btr);
-    plotPixel(ipx + 1  , ipy, m_color);
-
-    m_color.setOpacity(bbl);
-    plotPixel(ipx  , ipy + 1, m_color);
-
-    m_color.setOpacity(bbr);
-    plotPixel(ipx + 1 , ipy + 1, m_color);
-}
-
-
-inline void HairyBrush::plotPixel(int wx, int wy, const KoColor &color)
-{
-    m_dabAccessor->moveTo(wx, wy);
-    m_compositeOp->composite(m_dabAccessor->rawData(), m_pixelSize, color.data() , m_pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_U8);
-}
-
-inline void HairyBrush::darkenPixel(int wx, int wy, const KoColor &color)
-{
-    m_dabAccessor->moveTo(wx, wy);
-    if (m_dab->colorSpace()->opacityU8(m_dabAccessor->rawData()) < color.opacityU8()) {
-        memcpy(m_dabAccessor->rawData(), color.data(), m_pixelSize);
+        chunk->depositor.addPixel(qRound(pos.x()), qRound(pos.y()), op);
     }
 }
 
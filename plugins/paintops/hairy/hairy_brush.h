@@ -30,9 +30,9 @@
 
 #include <kis_paint_device.h>
 #include <brushengine/kis_paint_information.h>
-#include <kis_random_accessor_ng.h>
+#include <KisParticleDepositor.h>
 
-class KoCompositeOp;
+class KoColorTransformation;
 
 
 class KisHairyProperties
@@ -74,10 +74,6 @@ public:
     ~HairyBrush();
 
     void paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const KisPaintInformation &pi1, const KisPaintInformation &pi2, qreal scale, qreal rotation);
-    /// set ink color for the whole bristle shape
-    void setInkColor(const KoColor &color) {
-        m_color = color;
-    }
     /// set parameters for the brush engine
     void setProperties(KisHairyProperties * properties) {
         m_properties = properties;
@@ -85,17 +81,35 @@ public:
     /// set the shape of the bristles according the dab
     void fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density);
 
+    /**
+     * Allow painting the bristles and writing the ink on several
+     * threads. It is allowed by default. Should be set before the
+     * first call to paintLine().
+     */
+    void setThreadingAllowed(bool value);
+
 private:
+    /**
+     * A contiguous range of bristles painted by a single thread. Every
+     * chunk owns its own trajectory and color transformation, because
+     * both of them keep state between the calls. The ink of the chunk
+     * is collected into its own depositor.
+     */
+    struct BristleChunk {
+        int begin = 0;
+        int end = 0;
+        Trajectory trajectory;
+        KoColorTransformation *transfo = 0;
+        KisParticleDepositor depositor;
+    };
+
+    /// computes the start and end positions of all the bristles for the current line
+    void updateBristlePositions(qreal angle, qreal scale, qreal shear, bool continuePath);
+    /// paints the bristles of a chunk into its depositor
+    void paintBristles(BristleChunk *chunk, qreal x1, qreal y1, qreal x2, qreal y2,
+                       qreal pressure, qreal threshold);
     /// paints single bristle
-    void addBristleInk(Bristle *bristle,const QPointF &pos, const KoColor &color);
-    /// composite single pixel to dab
-    void plotPixel(int wx, int wy, const KoColor &color);
-    /// check the opacity of dab pixel and if the opacity is less then color, it will copy color to dab
-    void darkenPixel(int wx, int wy, const KoColor &color);
-    /// paint wu particle by copying the color and setup just the opacity, weight is complementary to opacity of the color
-    void paintParticle(QPointF pos, const KoColor& color, qreal weight);
-    /// paint wu particle using composite operation
-    void paintParticle(QPointF pos, const KoColor& color);
+    void addBristleInk(BristleChunk *chunk, const QPointF &pos, const KoColor &color);
     /// similar to sample input color in spray
     void colorifyBristles(KisPaintDeviceSP source, QPointF point);
 
@@ -104,7 +118,7 @@ private:
     double computeMousePressure(double distance);
 
     /// simulate running out of saturation
-    void saturationDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDeplation);
+    void saturationDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDeplation, KoColorTransformation *transfo);
     /// simulate running out of ink through opacity decreasing
     void opacityDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDeplation);
     /// fetch actual ink status according depletion curve
@@ -116,25 +130,36 @@ private:
     const KisHairyProperties * m_properties;
 
     QVector<Bristle*> m_bristles;
-    QTransform m_transform;
 
-    // used for interpolation the path of bristles
-    Trajectory m_trajectory;
+    // the positions of the bristles are kept as a structure of arrays,
+    // so that the compiler could vectorize their transformation
+    QVector<float> m_bristleX;
+    QVector<float> m_bristleY;
+    QVector<float> m_prevX;
+    QVector<float> m_prevY;
+    QVector<float> m_randomX;
+    QVector<float> m_randomY;
+    QVector<float> m_startX;
+    QVector<float> m_startY;
+    QVector<float> m_endX;
+    QVector<float> m_endY;
+    QVector<quint8> m_enabled;
+
+    QVector<BristleChunk*> m_chunks;
+    KisParticleDepositor m_depositor;
+
     QHash<QString, QVariant> m_params;
     // temporary device
     KisPaintDeviceSP m_dab;
-    KisRandomAccessorSP m_dabAccessor;
-    const KoCompositeOp * m_compositeOp;
     quint32 m_pixelSize;
 
     int m_counter;
 
     double m_lastAngle;
     double m_oldPressure;
-    KoColor m_color;
+    bool m_threadingAllowed;
 
     int m_saturationId;
-    KoColorTransformation * m_transfo;
 
     // internal counter counts the calls of paint, the counter is 1 when the first call occurs
     inline bool firstStroke() const {
@@ -65,7 +65,6 @@ KisHairyPaintOp::KisHairyPaintOp(const KisPaintOpSettingsSP settings, KisPainter
     }
 
     m_brush.fromDabWithDensity(dab, settings->getDouble(HAIRY_BRISTLE_DENSITY) * 0.01);
-    m_brush.setInkColor(painter->paintColor());
 
     loadSettings(static_cast<const KisBrushBasedPaintOpSettings*>(settings.data()));
     m_brush.setProperties(&m_properties);
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisHairyBrushTest.h"
+
+#include <QTest>
+#include <QThread>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_fixed_paint_device.h>
+#include <brushengine/kis_paint_information.h>
+#include <brushengine/kis_random_source.h>
+
+#include "hairy_brush.h"
+#include "testutil.h"
+
+
+inline KisHairyProperties testProperties(bool antialias, bool useCompositing)
+{
+    KisHairyProperties properties;
+
+    properties.radius = 60;
+    properties.inkAmount = 1024;
+    properties.sigma = 1.0;
+    properties.inkDepletionEnabled = false;
+    properties.isbrushDimension1D = false;
+    properties.useMousePressure = false;
+    properties.useSaturation = false;
+    properties.useOpacity = false;
+    properties.useWeights = false;
+    properties.useSoakInk = false;
+    properties.connectedPath = true;
+    properties.antialias = antialias;
+    properties.useCompositing = useCompositing;
+    properties.pressureWeight = 50;
+    properties.bristleLengthWeight = 50;
+    properties.bristleInkAmountWeight = 50;
+    properties.inkDepletionWeight = 50;
+    properties.shearFactor = 0.0;
+    properties.randomFactor = 2.0;
+    properties.scaleFactor = 1.0;
+    properties.threshold = false;
+
+    return properties;
+}
+
+/**
+ * Paints a stroke with a brush of about 11000 bristles, which
+ * makes both the bristle painting and the ink deposit go parallel
+ * when threading is allowed. The device has an offset, so the
+ * tiles of the deposit are not aligned to zero.
+ */
+inline KisPaintDeviceSP paintStroke(KisHairyProperties properties, bool threadingAllowed)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+    KoColor color(Qt::blue, cs);
+    color.setOpacity(quint8(200));
+    dab->fill(QRect(0, 0, 120, 120), color);
+
+    HairyBrush brush;
+    brush.setProperties(&properties);
+    brush.setThreadingAllowed(threadingAllowed);
+    brush.fromDabWithDensity(dab, 0.8);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setX(37);
+    dev->setY(-21);
+
+    KisRandomSourceSP randomSource = new KisRandomSource(42);
+
+    KisPaintInformation pi1(QPointF(100, 100), 0.8);
+    pi1.setRandomSource(randomSource);
+
+    for (int i = 1; i <= 10; i++) {
+        KisPaintInformation pi2(QPointF(100 + 17 * i, 100 + 9 * i), 0.8);
+        pi2.setRandomSource(randomSource);
+
+        brush.paintLine(dev, 0, pi1, pi2, 1.0, 0.1 * i);
+        pi1 = pi2;
+    }
+
+    return dev;
+}
+
+void KisHairyBrushTest::testParallelPainting_data()
+{
+    QTest::addColumn<bool>("antialias");
+    QTest::addColumn<bool>("useCompositing");
+
+    QTest::newRow("copy") << false << false;
+    QTest::newRow("over") << false << true;
+    QTest::newRow("add-opacity") << true << false;
+    QTest::newRow("over-with-opacity") << true << true;
+}
+
+void KisHairyBrushTest::testParallelPainting()
+{
+    QFETCH(bool, antialias);
+    QFETCH(bool, useCompositing);
+
+    if (QThread::idealThreadCount() < 2) {
+        QSKIP("The parallel path is used only when there are several cores");
+    }
+
+    const KisHairyProperties properties = testProperties(antialias, useCompositing);
+
+    KisPaintDeviceSP parallelDev = paintStroke(properties, true);
+    KisPaintDeviceSP sequentialDev = paintStroke(properties, false);
+
+    const QRect rc = parallelDev->exactBounds();
+    QCOMPARE(sequentialDev->exactBounds(), rc);
+    QVERIFY(!rc.isEmpty());
+
+    QPoint errorPoint;
+    if (!TestUtil::compareQImages(errorPoint,
+                                  parallelDev->convertToQImage(0, rc),
+                                  sequentialDev->convertToQImage(0, rc))) {
+
+        QFAIL(QString("Parallel hairy stroke differs from the sequential one, first different pixel: %1,%2 ")
+              .arg(errorPoint.x()).arg(errorPoint.y()).toLatin1());
+    }
+}
+
+QTEST_MAIN(KisHairyBrushTest)
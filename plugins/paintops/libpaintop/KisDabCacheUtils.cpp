@@ -60,6 +60,16 @@ void generateDab(const DabGenerationInfo &di, DabRenderingResources *resources,
     KIS_SAFE_ASSERT_RECOVER_RETURN(*dab);
     const KoColorSpace *cs = (*dab)->colorSpace();
 
+    KisSharedDabCache::Key sharedCacheKey;
+
+    if (di.useSharedCache) {
+        sharedCacheKey = di.sharedCacheKey;
+        sharedCacheKey.colorSpace = cs;
+
+        if (KisSharedDabCache::instance()->fetchDab(sharedCacheKey, *dab)) {
+            return;
+        }
+    }
 
     if (resources->brush->brushType() == IMAGE || resources->brush->brushType() == PIPE_IMAGE) {
         *dab = resources->brush->paintDevice(cs, di.shape, di.info,
@@ -98,6 +108,10 @@ void generateDab(const DabGenerationInfo &di, DabRenderingResources *resources,
         (*dab)->mirror(di.mirrorProperties.horizontalMirror,
                        di.mirrorProperties.verticalMirror);
     }
+
+    if (di.useSharedCache) {
+        KisSharedDabCache::instance()->addDab(sharedCacheKey, *dab);
+    }
 }
 
 void postProcessDab(KisFixedPaintDeviceSP dab,
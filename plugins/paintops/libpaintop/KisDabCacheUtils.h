@@ -28,6 +28,7 @@
 #include "kis_dab_shape.h"
 
 #include "kritapaintop_export.h"
+#include "KisSharedDabCache.h"
 #include <functional>
 
 class KisBrush;
@@ -99,6 +100,13 @@ struct PAINTOP_EXPORT DabGenerationInfo
     qreal softnessFactor = 1.0;
 
     bool needsPostprocessing = false;
+
+    /**
+     * If set, the generated dab is shared with other strokes
+     * via KisSharedDabCache
+     */
+    bool useSharedCache = false;
+    KisSharedDabCache::Key sharedCacheKey;
 };
 
 PAINTOP_EXPORT QRect correctDabRectWhenFetchedFromCache(const QRect &dabRect,
@@ -29,6 +29,7 @@
 struct KisDabRenderingExecutor::Private
 {
     QScopedPointer<KisDabRenderingQueue> renderingQueue;
+    KisDabRenderingQueueCache *cache = 0; // owned by renderingQueue
     KisRunnableStrokeJobsInterface *runnableJobsInterface;
 };
 
@@ -44,11 +45,11 @@ KisDabRenderingExecutor::KisDabRenderingExecutor(const KoColorSpace *cs,
     m_d->renderingQueue.reset(
         new KisDabRenderingQueue(cs, resourcesFactory));
 
-    KisDabRenderingQueueCache *cache = new KisDabRenderingQueueCache();
-    cache->setMirrorPostprocessing(mirrorOption);
-    cache->setPrecisionOption(precisionOption);
+    m_d->cache = new KisDabRenderingQueueCache();
+    m_d->cache->setMirrorPostprocessing(mirrorOption);
+    m_d->cache->setPrecisionOption(precisionOption);
 
-    m_d->renderingQueue->setCacheInterface(cache);
+    m_d->renderingQueue->setCacheInterface(m_d->cache);
 }
 
 KisDabRenderingExecutor::~KisDabRenderingExecutor()
@@ -79,6 +80,11 @@ bool KisDabRenderingExecutor::hasPreparedDabs() const
     return m_d->renderingQueue->hasPreparedDabs();
 }
 
+void KisDabRenderingExecutor::disableSubpixelPrecision()
+{
+    m_d->cache->disableSubpixelPrecision();
+}
+
 qreal KisDabRenderingExecutor::averageDabRenderingTime() const
 {
     return m_d->renderingQueue->averageExecutionTime();
@@ -0,0 +1,297 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisDabRenderingUpdater.h"
+
+#include <QElapsedTimer>
+#include <QSharedPointer>
+
+#include <kis_painter.h>
+#include <kis_paint_device.h>
+#include <kis_default_bounds_base.h>
+#include <kis_image_config.h>
+#include <kis_wrapped_rect.h>
+#include <kis_paintop_utils.h>
+#include <kis_assert.h>
+#include <kis_pointer_utils.h>
+
+#include <KisRenderedDab.h>
+#include <KisRollingMeanAccumulatorWrapper.h>
+#include <KisRunnableStrokeJobData.h>
+
+#include "KisDabRenderingExecutor.h"
+
+
+namespace {
+
+struct UpdateSharedState
+{
+    // rendering data
+    KisPainter *painter = 0;
+    QList<KisRenderedDab> dabsQueue;
+
+    // speed metrics
+    QVector<QPointF> dabPoints;
+    QElapsedTimer dabRenderingTimer;
+
+    // final report
+    QVector<QRect> allDirtyRects;
+};
+
+typedef QSharedPointer<UpdateSharedState> UpdateSharedStateSP;
+
+void addMirroringJobs(Qt::Orientation direction,
+                      QVector<QRect> &rects,
+                      UpdateSharedStateSP state,
+                      QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    jobs.append(new KisRunnableStrokeJobData(0, KisStrokeJobData::SEQUENTIAL));
+
+    for (KisRenderedDab &dab : state->dabsQueue) {
+        jobs.append(
+            new KisRunnableStrokeJobData(
+                [state, &dab, direction] () {
+                    state->painter->mirrorDab(direction, &dab);
+                },
+                KisStrokeJobData::CONCURRENT));
+    }
+
+    jobs.append(new KisRunnableStrokeJobData(0, KisStrokeJobData::SEQUENTIAL));
+
+    for (QRect &rc : rects) {
+        state->painter->mirrorRect(direction, &rc);
+
+        jobs.append(
+            new KisRunnableStrokeJobData(
+                [rc, state] () {
+                    state->painter->bltFixed(rc, state->dabsQueue);
+                },
+                KisStrokeJobData::CONCURRENT));
+    }
+
+    state->allDirtyRects.append(rects);
+}
+
+}
+
+struct KisDabRenderingUpdater::Private
+{
+    Private(KisDabRenderingExecutor *_executor, KisPainter *_painter)
+        : executor(_executor),
+          painter(_painter),
+          avgSpacing(50),
+          avgNumDabs(50),
+          avgUpdateTimePerDab(50),
+          idealNumRects(KisImageConfig(true).maxNumberOfThreads()),
+          minUpdatePeriod(10),
+          maxUpdatePeriod(100)
+    {
+    }
+
+    KisDabRenderingExecutor *executor;
+    KisPainter *painter;
+
+    UpdateSharedStateSP updateSharedState;
+
+    qreal currentUpdatePeriod = 20.0;
+    KisRollingMeanAccumulatorWrapper avgSpacing;
+    KisRollingMeanAccumulatorWrapper avgNumDabs;
+    KisRollingMeanAccumulatorWrapper avgUpdateTimePerDab;
+
+    const int idealNumRects;
+
+    const int minUpdatePeriod;
+    const int maxUpdatePeriod;
+};
+
+KisDabRenderingUpdater::KisDabRenderingUpdater(KisDabRenderingExecutor *executor, KisPainter *painter)
+    : m_d(new Private(executor, painter))
+{
+}
+
+KisDabRenderingUpdater::~KisDabRenderingUpdater()
+{
+}
+
+void KisDabRenderingUpdater::addSpacingSample(qreal spacing)
+{
+    m_d->avgSpacing(spacing);
+}
+
+std::pair<int, bool> KisDabRenderingUpdater::doAsyncronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    bool someDabsAreStillInQueue = false;
+    const bool hasPreparedDabsAtStart = m_d->executor->hasPreparedDabs();
+
+    if (!m_d->updateSharedState && hasPreparedDabsAtStart) {
+
+        m_d->updateSharedState = toQShared(new UpdateSharedState());
+        UpdateSharedStateSP state = m_d->updateSharedState;
+
+        state->painter = m_d->painter;
+
+        {
+            const qreal dabRenderingTime = m_d->executor->averageDabRenderingTime();
+            const qreal totalRenderingTimePerDab = dabRenderingTime + m_d->avgUpdateTimePerDab.rollingMeanSafe();
+
+            // we limit the number of fetched dabs to fit the maximum update period and not
+            // make visual hiccups
+            const int dabsLimit =
+                totalRenderingTimePerDab > 0 ?
+                    qMax(10, int(m_d->maxUpdatePeriod  / totalRenderingTimePerDab * m_d->idealNumRects)) :
+                    -1;
+
+            state->dabsQueue = m_d->executor->takeReadyDabs(state->painter->hasMirroring(), dabsLimit, &someDabsAreStillInQueue);
+        }
+
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!state->dabsQueue.isEmpty(),
+                                             std::make_pair(m_d->currentUpdatePeriod, false));
+
+        const int diameter = m_d->executor->averageDabSize();
+        const qreal spacing = m_d->avgSpacing.rollingMean();
+
+        const int idealNumRects = m_d->idealNumRects;
+
+        QVector<QRect> rects;
+
+        // wrap the dabs if needed
+        if (state->painter->device()->defaultBounds()->wrapAroundMode()) {
+            /**
+             * In WA mode we do two things:
+             *
+             * 1) We ensure that the parallel threads do not access the same are on
+             *    the image. For normal updates that is ensured by the code in KisImage
+             *    and the scheduler. Here we should do that manually by adjusting 'rects'
+             *    so that they would not intersect in the wrapped space.
+             *
+             * 2) We duplicate dabs, to ensure that all the pieces of dabs are painted
+             *    inside the wrapped rect. No pieces are dabs are painted twice, because
+             *    we paint only the parts intersecting the wrap rect.
+             */
+
+            const QRect wrapRect = state->painter->device()->defaultBounds()->bounds();
+
+            QList<KisRenderedDab> wrappedDabs;
+
+            Q_FOREACH (const KisRenderedDab &dab, state->dabsQueue) {
+                const QVector<QPoint> normalizationOrigins =
+                    KisWrappedRect::normalizationOriginsForRect(dab.realBounds(), wrapRect);
+
+                Q_FOREACH(const QPoint &pt, normalizationOrigins) {
+                    KisRenderedDab newDab = dab;
+
+                    newDab.offset = pt;
+
+                    rects.append(newDab.realBounds() & wrapRect);
+                    wrappedDabs.append(newDab);
+                }
+            }
+
+            state->dabsQueue = wrappedDabs;
+
+        } else {
+            // just get all rects
+            Q_FOREACH (const KisRenderedDab &dab, state->dabsQueue) {
+                rects.append(dab.realBounds());
+            }
+        }
+
+        // split/merge rects into non-overlapping areas
+        rects = KisPaintOpUtils::splitDabsIntoRects(rects,
+                                                    idealNumRects, diameter, spacing);
+
+        state->allDirtyRects = rects;
+
+        Q_FOREACH (const KisRenderedDab &dab, state->dabsQueue) {
+            state->dabPoints.append(dab.realBounds().center());
+        }
+
+        state->dabRenderingTimer.start();
+
+        Q_FOREACH (const QRect &rc, rects) {
+            jobs.append(
+                new KisRunnableStrokeJobData(
+                    [rc, state] () {
+                        state->painter->bltFixed(rc, state->dabsQueue);
+                    },
+                    KisStrokeJobData::CONCURRENT));
+        }
+
+        /**
+         * After the dab has been rendered once, we should mirror it either one
+         * (h __or__ v) or three (h __and__ v) times. This sequence of 'if's achieves
+         * the goal without any extra copying. Please note that it has __no__ 'else'
+         * branches, which is done intentionally!
+         */
+        if (state->painter->hasHorizontalMirroring()) {
+            addMirroringJobs(Qt::Horizontal, rects, state, jobs);
+        }
+
+        if (state->painter->hasVerticalMirroring()) {
+            addMirroringJobs(Qt::Vertical, rects, state, jobs);
+        }
+
+        if (state->painter->hasHorizontalMirroring() && state->painter->hasVerticalMirroring()) {
+            addMirroringJobs(Qt::Horizontal, rects, state, jobs);
+        }
+
+        Private *d = m_d.data();
+
+        jobs.append(
+            new KisRunnableStrokeJobData(
+                [state, d, someDabsAreStillInQueue] () {
+                    Q_FOREACH(const QRect &rc, state->allDirtyRects) {
+                        state->painter->addDirtyRect(rc);
+                    }
+
+                    state->painter->setAverageOpacity(state->dabsQueue.last().averageOpacity);
+
+                    const int updateRenderingTime = state->dabRenderingTimer.elapsed();
+                    const qreal dabRenderingTime = d->executor->averageDabRenderingTime();
+
+                    d->avgNumDabs(state->dabsQueue.size());
+
+                    const qreal currentUpdateTimePerDab = qreal(updateRenderingTime) / state->dabsQueue.size();
+                    d->avgUpdateTimePerDab(currentUpdateTimePerDab);
+
+                    /**
+                     * NOTE: using currentUpdateTimePerDab in the calculation for the next update time instead
+                     *       of the average one makes rendering speed about 40% faster. It happens because the
+                     *       adaptation period is shorter than if it used
+                     */
+                    const qreal totalRenderingTimePerDab = dabRenderingTime + currentUpdateTimePerDab;
+
+                    const int approxDabRenderingTime =
+                        qreal(totalRenderingTimePerDab) * d->avgNumDabs.rollingMean() / d->idealNumRects;
+
+                    d->currentUpdatePeriod =
+                        someDabsAreStillInQueue ? d->minUpdatePeriod :
+                        qBound(d->minUpdatePeriod, int(1.5 * approxDabRenderingTime), d->maxUpdatePeriod);
+
+                    // release all the dab devices
+                    state->dabsQueue.clear();
+
+                    d->updateSharedState.clear();
+                },
+                KisStrokeJobData::SEQUENTIAL));
+    } else if (m_d->updateSharedState && hasPreparedDabsAtStart) {
+        someDabsAreStillInQueue = true;
+    }
+
+    return std::make_pair(m_d->currentUpdatePeriod, someDabsAreStillInQueue);
+}
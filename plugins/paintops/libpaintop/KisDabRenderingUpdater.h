@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISDABRENDERINGUPDATER_H
+#define KISDABRENDERINGUPDATER_H
+
+#include "kritapaintop_export.h"
+
+#include <QScopedPointer>
+#include <QVector>
+#include <utility>
+
+class KisPainter;
+class KisDabRenderingExecutor;
+class KisRunnableStrokeJobData;
+
+
+/**
+ * Transfers the dabs rendered by KisDabRenderingExecutor onto the
+ * painter's device. The dabs are split into non-overlapping rects,
+ * which are blitted in parallel, then mirrored if needed. The update
+ * period is adjusted to the measured speed of rendering and blitting.
+ *
+ * A paintop using the executor should feed the spacing of every dab
+ * into addSpacingSample() and forward its doAsyncronousUpdate() here.
+ */
+class PAINTOP_EXPORT KisDabRenderingUpdater
+{
+public:
+    KisDabRenderingUpdater(KisDabRenderingExecutor *executor, KisPainter *painter);
+    ~KisDabRenderingUpdater();
+
+    void addSpacingSample(qreal spacing);
+
+    std::pair<int, bool> doAsyncronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs);
+
+private:
+    KisDabRenderingUpdater(const KisDabRenderingUpdater &rhs) = delete;
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISDABRENDERINGUPDATER_H
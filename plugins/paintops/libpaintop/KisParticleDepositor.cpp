@@ -0,0 +1,292 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisParticleDepositor.h"
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceTraits.h>
+#include <KoCompositeOpRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+#include <kis_algebra_2d.h>
+#include <kis_assert.h>
+#include "tiles3/kis_tile_data_interface.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+/**
+ * Threading overhead is not worth it for small batches
+ */
+const int minWritesForThreading = 4096;
+
+struct PixelWrite {
+    qint32 x;
+    qint32 y;
+    float opacity;
+    int colorOffset;
+    KisParticleDepositor::Operation op;
+};
+
+struct TileRange {
+    const PixelWrite * const *begin;
+    const PixelWrite * const *end;
+};
+}
+
+struct KisParticleDepositor::Private
+{
+    QVector<PixelWrite> writes;
+    QVector<quint8> colors;
+    int currentColorOffset = -1;
+    int pixelSize = 0;
+    bool threadingAllowed = true;
+
+    void writePixels(KisPaintDeviceSP dev, const KoCompositeOp *overOp,
+                     const PixelWrite * const *begin, const PixelWrite * const *end);
+};
+
+KisParticleDepositor::KisParticleDepositor()
+    : m_d(new Private)
+{
+}
+
+KisParticleDepositor::~KisParticleDepositor()
+{
+}
+
+void KisParticleDepositor::setColor(const KoColor &color)
+{
+    const int pixelSize = color.colorSpace()->pixelSize();
+
+    if (m_d->currentColorOffset >= 0 &&
+        pixelSize == m_d->pixelSize &&
+        !memcmp(m_d->colors.constData() + m_d->currentColorOffset, color.data(), pixelSize)) {
+
+        return;
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_NOOP(m_d->colors.isEmpty() || pixelSize == m_d->pixelSize);
+
+    m_d->pixelSize = pixelSize;
+    m_d->currentColorOffset = m_d->colors.size();
+    m_d->colors.resize(m_d->currentColorOffset + pixelSize);
+    memcpy(m_d->colors.data() + m_d->currentColorOffset, color.data(), pixelSize);
+}
+
+void KisParticleDepositor::addPixel(int x, int y, Operation op, qreal opacity)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_d->currentColorOffset >= 0);
+
+    const PixelWrite write = {x, y, float(opacity), m_d->currentColorOffset, op};
+    m_d->writes.append(write);
+}
+
+void KisParticleDepositor::addParticle(qreal x, qreal y, Operation op, qreal opacity)
+{
+    const int ipx = std::floor(x);
+    const int ipy = std::floor(y);
+    const qreal fx = x - ipx;
+    const qreal fy = y - ipy;
+
+    // opacity top left, right, bottom left, right
+    addPixel(ipx, ipy, op, (1.0 - fx) * (1.0 - fy) * opacity);
+    addPixel(ipx + 1, ipy, op, fx * (1.0 - fy) * opacity);
+    addPixel(ipx, ipy + 1, op, (1.0 - fx) * fy * opacity);
+    addPixel(ipx + 1, ipy + 1, op, fx * fy * opacity);
+}
+
+void KisParticleDepositor::append(KisParticleDepositor &rhs)
+{
+    if (rhs.m_d->writes.isEmpty()) return;
+
+    KIS_SAFE_ASSERT_RECOVER(m_d->colors.isEmpty() || m_d->pixelSize == rhs.m_d->pixelSize) {
+        rhs.clear();
+        return;
+    }
+
+    const int colorsShift = m_d->colors.size();
+    m_d->colors += rhs.m_d->colors;
+    m_d->pixelSize = rhs.m_d->pixelSize;
+
+    m_d->writes.reserve(m_d->writes.size() + rhs.m_d->writes.size());
+    for (PixelWrite write : rhs.m_d->writes) {
+        write.colorOffset += colorsShift;
+        m_d->writes.append(write);
+    }
+
+    rhs.clear();
+}
+
+int KisParticleDepositor::size() const
+{
+    return m_d->writes.size();
+}
+
+void KisParticleDepositor::Private::writePixels(KisPaintDeviceSP dev, const KoCompositeOp *overOp,
+                                                const PixelWrite * const *begin, const PixelWrite * const *end)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+    KisRandomAccessorSP accessor = dev->createRandomAccessorNG((*begin)->x, (*begin)->y);
+
+    quint8 pixel[MAX_PIXEL_SIZE];
+
+    for (const PixelWrite * const *it = begin; it != end; ++it) {
+        const PixelWrite *write = *it;
+        const quint8 *color = colors.constData() + write->colorOffset;
+
+        accessor->moveTo(write->x, write->y);
+        quint8 *dst = accessor->rawData();
+
+        switch (write->op) {
+        case Copy:
+            memcpy(dst, color, pixelSize);
+            break;
+        case CopyWithOpacity:
+            memcpy(dst, color, pixelSize);
+            cs->setOpacity(dst, qreal(write->opacity), 1);
+            break;
+        case AddOpacity: {
+            const quint8 opacity = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8,
+                                                          qRound(write->opacity * OPACITY_OPAQUE_U8) + cs->opacityU8(dst),
+                                                          OPACITY_OPAQUE_U8));
+            memcpy(dst, color, pixelSize);
+            cs->setOpacity(dst, opacity, 1);
+            break;
+        }
+        case CopyIfMoreOpaque:
+            if (cs->opacityU8(dst) < cs->opacityU8(color)) {
+                memcpy(dst, color, pixelSize);
+            }
+            break;
+        case Over:
+            overOp->composite(dst, pixelSize, color, pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+            break;
+        case OverWithOpacity:
+            memcpy(pixel, color, pixelSize);
+            cs->setOpacity(pixel, qreal(write->opacity), 1);
+            overOp->composite(dst, pixelSize, pixel, pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+            break;
+        }
+    }
+}
+
+void KisParticleDepositor::deposit(KisPaintDeviceSP dev)
+{
+    if (m_d->writes.isEmpty()) return;
+
+    KIS_SAFE_ASSERT_RECOVER(int(dev->pixelSize()) == m_d->pixelSize) {
+        clear();
+        return;
+    }
+
+    QVector<const PixelWrite*> sortedWrites;
+    sortedWrites.reserve(m_d->writes.size());
+    for (const PixelWrite &write : m_d->writes) {
+        sortedWrites.append(&write);
+    }
+
+    const PixelWrite * const *begin = sortedWrites.constData();
+    const PixelWrite * const *end = begin + sortedWrites.size();
+
+    const KoCompositeOp *overOp = dev->colorSpace()->compositeOp(COMPOSITE_OVER);
+
+    if (m_d->threadingAllowed &&
+        sortedWrites.size() >= minWritesForThreading &&
+        QThread::idealThreadCount() > 1) {
+
+        const int tileWidth = KisTileData::WIDTH;
+        const int tileHeight = KisTileData::HEIGHT;
+        const int originX = dev->x();
+        const int originY = dev->y();
+
+        // the tiles of the device are aligned to its offset
+        auto tileKey = [tileWidth, tileHeight, originX, originY] (const PixelWrite *write) {
+            const qint32 col = KisAlgebra2D::divideFloor(write->x - originX, tileWidth);
+            const qint32 row = KisAlgebra2D::divideFloor(write->y - originY, tileHeight);
+            return (quint64(quint32(row)) << 32) | quint32(col);
+        };
+
+        // the sort is stable, so the writes inside a tile keep their order
+        std::stable_sort(sortedWrites.begin(), sortedWrites.end(),
+                         [tileKey] (const PixelWrite *lhs, const PixelWrite *rhs) {
+                             return tileKey(lhs) < tileKey(rhs);
+                         });
+
+        begin = sortedWrites.constData();
+        end = begin + sortedWrites.size();
+
+        QVector<TileRange> tiles;
+
+        const PixelWrite * const *tileBegin = begin;
+        for (const PixelWrite * const *it = begin; it != end; ++it) {
+            if (tileKey(*it) != tileKey(*tileBegin)) {
+                tiles.append({tileBegin, it});
+                tileBegin = it;
+            }
+        }
+        tiles.append({tileBegin, end});
+
+        Private *d = m_d.data();
+        QtConcurrent::blockingMap(tiles,
+                                  [d, dev, overOp] (const TileRange &tile) {
+                                      d->writePixels(dev, overOp, tile.begin, tile.end);
+                                  });
+    } else {
+        m_d->writePixels(dev, overOp, begin, end);
+    }
+
+    clear();
+}
+
+void KisParticleDepositor::clear()
+{
+    m_d->writes.resize(0);
+
+    if (m_d->currentColorOffset < 0) {
+        m_d->colors.resize(0);
+        return;
+    }
+
+    // keep the current color for the next batch
+    if (m_d->currentColorOffset > 0) {
+        memmove(m_d->colors.data(), m_d->colors.constData() + m_d->currentColorOffset, m_d->pixelSize);
+        m_d->currentColorOffset = 0;
+    }
+
+    m_d->colors.resize(m_d->pixelSize);
+}
+
+void KisParticleDepositor::setThreadingAllowed(bool value)
+{
+    m_d->threadingAllowed = value;
+}
+
+bool KisParticleDepositor::threadingAllowed() const
+{
+    return m_d->threadingAllowed;
+}
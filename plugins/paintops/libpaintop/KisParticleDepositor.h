@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISPARTICLEDEPOSITOR_H
+#define KISPARTICLEDEPOSITOR_H
+
+#include "kritapaintop_export.h"
+
+#include <QScopedPointer>
+
+#include "kis_types.h"
+
+class KoColor;
+
+
+/**
+ * Collects the single-pixel writes of particle-based paintops (spray,
+ * particle, hairy) and applies them to a paint device in one pass. Writing
+ * every particle through a random accessor directly makes the accessor
+ * jump between the tiles and locks the tiles over and over again.
+ *
+ * The writes are binned by tile and every tile is visited only once.
+ * The tiles are processed in parallel when the batch is big enough.
+ * Inside a tile the writes keep the order they were added in, so the
+ * result is the same as if they were written one by one.
+ */
+class PAINTOP_EXPORT KisParticleDepositor
+{
+public:
+    enum Operation {
+        /// copy the color into the pixel
+        Copy,
+        /// copy the color and replace its opacity with the particle's one
+        CopyWithOpacity,
+        /// copy the color and add the particle's opacity to the opacity of the pixel
+        AddOpacity,
+        /// copy the color only if it is more opaque than the pixel
+        CopyIfMoreOpaque,
+        /// composite the color over the pixel
+        Over,
+        /// replace the opacity of the color with the particle's one and composite it over the pixel
+        OverWithOpacity
+    };
+
+public:
+    KisParticleDepositor();
+    ~KisParticleDepositor();
+
+    /**
+     * Sets the color of all the following particles. The color is
+     * stored only when it differs from the previous one, so it is
+     * cheap to call it for every particle.
+     */
+    void setColor(const KoColor &color);
+
+    /**
+     * Adds a single pixel write. The \p opacity is ignored
+     * by Copy, CopyIfMoreOpaque and Over operations.
+     */
+    void addPixel(int x, int y, Operation op, qreal opacity = 1.0);
+
+    /**
+     * Adds an antialiased (Wu) particle: the \p opacity is split
+     * between the four pixels the point \p x, \p y falls on.
+     */
+    void addParticle(qreal x, qreal y, Operation op, qreal opacity = 1.0);
+
+    /**
+     * Moves all the particles of \p rhs to the end of this batch.
+     * It lets several threads collect the particles into separate
+     * depositors and write them in a single pass keeping the order.
+     */
+    void append(KisParticleDepositor &rhs);
+
+    /**
+     * \return the number of pixel writes waiting for deposit()
+     */
+    int size() const;
+
+    /**
+     * Writes all the collected particles into \p dev and clears
+     * the batch. The color space of \p dev should have the same
+     * pixel size as the colors passed to setColor().
+     */
+    void deposit(KisPaintDeviceSP dev);
+
+    /**
+     * Drops the collected particles. The current color is kept.
+     */
+    void clear();
+
+    /**
+     * Allow deposit() to write the tiles on several threads. It is
+     * allowed by default, but the paintops that already paint on
+     * several threads may ask the depositor to avoid it.
+     */
+    void setThreadingAllowed(bool value);
+
+    /**
+     * \see setThreadingAllowed() for details
+     */
+    bool threadingAllowed() const;
+
+private:
+    KisParticleDepositor(const KisParticleDepositor &rhs) = delete;
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISPARTICLEDEPOSITOR_H
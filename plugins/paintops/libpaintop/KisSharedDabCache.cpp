@@ -0,0 +1,151 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisSharedDabCache.h"
+
+#include <QHash>
+#include <QMutexLocker>
+
+#include <kis_fixed_paint_device.h>
+
+
+namespace {
+/**
+ * The costs in QCache are stored in kilobytes, otherwise
+ * an int would overflow for the big limits
+ */
+const int costUnit = 1024;
+const qint64 defaultMemoryLimit = 64 * 1024 * 1024;
+
+int dabCost(KisFixedPaintDeviceSP dab) {
+    return qMax(1, dab->bounds().width() * dab->bounds().height() * dab->pixelSize() / costUnit);
+}
+}
+
+struct KisSharedDabCache::CachedDab
+{
+    KisFixedPaintDeviceSP dab;
+};
+
+bool KisSharedDabCache::Key::operator==(const Key &rhs) const
+{
+    return width == rhs.width &&
+        height == rhs.height &&
+        angle == rhs.angle &&
+        subPixelX == rhs.subPixelX &&
+        subPixelY == rhs.subPixelY &&
+        softness == rhs.softness &&
+        brushIndex == rhs.brushIndex &&
+        horizontalMirror == rhs.horizontalMirror &&
+        verticalMirror == rhs.verticalMirror &&
+        colorSpace == rhs.colorSpace &&
+        color == rhs.color &&
+        brushKey == rhs.brushKey;
+}
+
+uint qHash(const KisSharedDabCache::Key &key, uint seed)
+{
+    return qHash(key.brushKey, seed) ^
+        qHash(key.color, seed) ^
+        qHash(quintptr(key.colorSpace), seed) ^
+        qHash(key.width, seed) ^
+        qHash(key.height << 16, seed) ^
+        qHash(key.angle << 8, seed) ^
+        qHash(key.subPixelX << 20, seed) ^
+        qHash(key.subPixelY << 24, seed) ^
+        qHash(key.softness << 12, seed) ^
+        qHash(key.brushIndex << 4, seed) ^
+        qHash(int(key.horizontalMirror) | int(key.verticalMirror) << 1, seed);
+}
+
+Q_GLOBAL_STATIC(KisSharedDabCache, s_instance)
+
+KisSharedDabCache::KisSharedDabCache()
+{
+    m_cache.setMaxCost(defaultMemoryLimit / costUnit);
+}
+
+KisSharedDabCache::~KisSharedDabCache()
+{
+}
+
+KisSharedDabCache* KisSharedDabCache::instance()
+{
+    return s_instance;
+}
+
+bool KisSharedDabCache::fetchDab(const Key &key, KisFixedPaintDeviceSP dab)
+{
+    QMutexLocker l(&m_mutex);
+
+    CachedDab *cachedDab = m_cache.object(key);
+
+    if (!cachedDab) {
+        m_misses++;
+        return false;
+    }
+
+    m_hits++;
+    *dab = *cachedDab->dab;
+
+    return true;
+}
+
+void KisSharedDabCache::addDab(const Key &key, KisFixedPaintDeviceSP dab)
+{
+    CachedDab *cachedDab = new CachedDab();
+    cachedDab->dab = new KisFixedPaintDevice(*dab);
+
+    const int cost = dabCost(dab);
+
+    QMutexLocker l(&m_mutex);
+    m_cache.insert(key, cachedDab, cost);
+}
+
+void KisSharedDabCache::setMemoryLimit(qint64 bytes)
+{
+    QMutexLocker l(&m_mutex);
+    m_cache.setMaxCost(qMax(qint64(1), bytes / costUnit));
+}
+
+void KisSharedDabCache::clear()
+{
+    QMutexLocker l(&m_mutex);
+    m_cache.clear();
+}
+
+KisSharedDabCache::Statistics KisSharedDabCache::statistics() const
+{
+    QMutexLocker l(&m_mutex);
+
+    Statistics stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.numDabs = m_cache.count();
+    stats.memoryUsage = qint64(m_cache.totalCost()) * costUnit;
+    stats.memoryLimit = qint64(m_cache.maxCost()) * costUnit;
+
+    return stats;
+}
+
+void KisSharedDabCache::resetStatistics()
+{
+    QMutexLocker l(&m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+}
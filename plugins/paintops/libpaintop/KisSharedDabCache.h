@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISSHAREDDABCACHE_H
+#define KISSHAREDDABCACHE_H
+
+#include "kritapaintop_export.h"
+
+#include <QByteArray>
+#include <QMutex>
+#include <QCache>
+#include <QString>
+
+#include "kis_types.h"
+
+class KoColorSpace;
+
+
+/**
+ * A process-wide cache of generated dabs, which persists across
+ * the strokes. KisDabCacheBase can reuse only the previously
+ * generated dab, but a pressure-driven brush usually produces a
+ * small set of distinct dabs after the parameters are quantized
+ * to the precision level of the preset. This cache keeps them all,
+ * so they don't need to be regenerated on every stroke.
+ *
+ * The dabs are stored before postprocessing (sharpness and texture)
+ * and evicted in LRU order when the memory limit is reached.
+ */
+class PAINTOP_EXPORT KisSharedDabCache
+{
+public:
+    struct PAINTOP_EXPORT Key
+    {
+        QString brushKey;
+        const KoColorSpace *colorSpace = 0;
+        QByteArray color;
+        int width = 0;
+        int height = 0;
+        int angle = 0;
+        int subPixelX = 0;
+        int subPixelY = 0;
+        int softness = 0;
+        int brushIndex = 0;
+        bool horizontalMirror = false;
+        bool verticalMirror = false;
+
+        bool operator==(const Key &rhs) const;
+    };
+
+    struct Statistics
+    {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        int numDabs = 0;
+        qint64 memoryUsage = 0; // bytes
+        qint64 memoryLimit = 0; // bytes
+
+        qreal hitRate() const {
+            return hits + misses > 0 ? qreal(hits) / (hits + misses) : 0.0;
+        }
+    };
+
+public:
+    KisSharedDabCache();
+    ~KisSharedDabCache();
+
+    static KisSharedDabCache* instance();
+
+    /**
+     * Copies a cached dab into \p dab. The color space of the dab is
+     * a part of the key, so \p dab should already have the color space
+     * the caller expects.
+     *
+     * \return true if the dab has been found in the cache
+     */
+    bool fetchDab(const Key &key, KisFixedPaintDeviceSP dab);
+
+    /**
+     * Saves a copy of \p dab into the cache
+     */
+    void addDab(const Key &key, KisFixedPaintDeviceSP dab);
+
+    void setMemoryLimit(qint64 bytes);
+    void clear();
+
+    /**
+     * Debugging API: the numbers of hits and misses since the
+     * last call to resetStatistics() and the current memory usage
+     */
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    struct CachedDab;
+
+    mutable QMutex m_mutex;
+    QCache<Key, CachedDab> m_cache;
+    qint64 m_hits = 0;
+    qint64 m_misses = 0;
+};
+
+PAINTOP_EXPORT uint qHash(const KisSharedDabCache::Key &key, uint seed = 0);
+
+#endif // KISSHAREDDABCACHE_H
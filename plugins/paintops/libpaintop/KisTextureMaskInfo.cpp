@@ -27,7 +27,6 @@
 
 #include <kis_algebra_2d.h>
 #include <kis_lod_transform.h>
-#include <kis_iterator_ng.h>
 
 #include <QGlobalStatic>
 
@@ -94,17 +93,21 @@ int KisTextureMaskInfo::levelOfDetail() const {
 }
 
 bool KisTextureMaskInfo::hasMask() const {
-    return m_mask;
+    return !m_mask.isEmpty();
 }
 
-KisPaintDeviceSP KisTextureMaskInfo::mask() {
-    return m_mask;
+const quint8* KisTextureMaskInfo::maskRow(int y) const {
+    return m_mask.constData() + y * m_maskBounds.width();
 }
 
 QRect KisTextureMaskInfo::maskBounds() const {
     return m_maskBounds;
 }
 
+int KisTextureMaskInfo::maskMemoryCost() const {
+    return m_mask.size();
+}
+
 bool KisTextureMaskInfo::fillProperties(const KisPropertiesConfigurationSP setting)
 {
 
@@ -136,10 +139,6 @@ void KisTextureMaskInfo::recalculateMask()
 
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
 
-    if (!m_mask) {
-        m_mask = new KisPaintDevice(cs);
-    }
-
     QImage mask = m_pattern->pattern();
 
     if ((mask.format() != QImage::Format_RGB32) |
@@ -161,7 +160,8 @@ void KisTextureMaskInfo::recalculateMask()
     const int width = mask.width();
     const int height = mask.height();
 
-    KisHLineIteratorSP iter = m_mask->createHLineIteratorNG(0, 0, width);
+    m_mask.resize(width * height);
+    quint8 *dstPixel = m_mask.data();
 
     for (int row = 0; row < height; ++row) {
         for (int col = 0; col < width; ++col) {
@@ -194,10 +194,9 @@ void KisTextureMaskInfo::recalculateMask()
                 maskValue = OPACITY_OPAQUE_F;
             }
 
-            cs->setOpacity(iter->rawData(), maskValue, 1);
-            iter->nextPixel();
+            cs->setOpacity(dstPixel, maskValue, 1);
+            dstPixel++;
         }
-        iter->nextRow();
     }
 
     m_maskBounds = QRect(0, 0, width, height);
@@ -214,16 +213,36 @@ KisTextureMaskInfoCache *KisTextureMaskInfoCache::instance()
     return s_instance;
 }
 
+namespace {
+/**
+ * The cache always keeps the most recent mask, even if it is bigger
+ * than the limit
+ */
+const int maxCacheMemory = 64 * 1024 * 1024;
+}
+
 KisTextureMaskInfoSP KisTextureMaskInfoCache::fetchCachedTextureInfo(KisTextureMaskInfoSP info) {
     QMutexLocker locker(&m_mutex);
 
-    KisTextureMaskInfoSP &cachedInfo =
-            info->levelOfDetail() > 0 ? m_lodInfo : m_mainInfo;
+    for (int i = 0; i < m_infos.size(); i++) {
+        if (*m_infos[i] == *info) {
+            m_infos.move(i, 0);
+            return m_infos.first();
+        }
+    }
+
+    info->recalculateMask();
+    m_infos.prepend(info);
+
+    int totalMemory = 0;
+    for (int i = 0; i < m_infos.size(); i++) {
+        totalMemory += m_infos[i]->maskMemoryCost();
 
-    if (!cachedInfo || *cachedInfo != *info) {
-        cachedInfo = info;
-        cachedInfo->recalculateMask();
+        if (i > 0 && totalMemory > maxCacheMemory) {
+            m_infos.erase(m_infos.begin() + i, m_infos.end());
+            break;
+        }
     }
 
-    return cachedInfo;
+    return info;
 }
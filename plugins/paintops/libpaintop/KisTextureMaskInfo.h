@@ -20,9 +20,13 @@
 #define KISTEXTUREMASKINFO_H
 
 
-#include <kis_paint_device.h>
+#include <kritapaintop_export.h>
+#include <kis_types.h>
 #include <QSharedPointer>
 #include <QMutex>
+#include <QRect>
+#include <QVector>
+#include <QList>
 
 
 #include <boost/operators.hpp>
@@ -30,7 +34,7 @@
 class KoPattern;
 class KisTextureMaskInfo;
 
-class KisTextureMaskInfo : public boost::equality_comparable<KisTextureMaskInfo>
+class PAINTOP_EXPORT KisTextureMaskInfo : public boost::equality_comparable<KisTextureMaskInfo>
 {
 public:
     KisTextureMaskInfo(int levelOfDetail);
@@ -46,10 +50,21 @@ public:
 
     bool hasMask() const;
 
-    KisPaintDeviceSP mask();
+    /**
+     * The mask is stored as a plain 8-bit buffer with one byte per
+     * pixel, so the dabs can read it row by row without going through
+     * a paint device. Returns the row \p y, which must be inside
+     * maskBounds()
+     */
+    const quint8* maskRow(int y) const;
 
     QRect maskBounds() const;
 
+    /**
+     * The size of the calculated mask in bytes
+     */
+    int maskMemoryCost() const;
+
     bool fillProperties(const KisPropertiesConfigurationSP setting);
 
     void recalculateMask();
@@ -68,22 +83,28 @@ private:
     int m_cutoffRight = 255;
     int m_cutoffPolicy = 0;
 
-    KisPaintDeviceSP m_mask;
+    QVector<quint8> m_mask;
     QRect m_maskBounds;
 
 };
 
 typedef QSharedPointer<KisTextureMaskInfo> KisTextureMaskInfoSP;
 
-struct KisTextureMaskInfoCache
+struct PAINTOP_EXPORT KisTextureMaskInfoCache
 {
     static KisTextureMaskInfoCache *instance();
     KisTextureMaskInfoSP fetchCachedTextureInfo(KisTextureMaskInfoSP info);
 
 private:
     QMutex m_mutex;
-    QSharedPointer<KisTextureMaskInfo> m_lodInfo;
-    QSharedPointer<KisTextureMaskInfo> m_mainInfo;
+
+    /**
+     * The recently used masks, the most recent one goes first. Every
+     * combination of the pattern, scale, brightness, contrast, invert
+     * and cutoff gets its own mask, so switching between presets or
+     * their instant preview doesn't recalculate the mask every time.
+     */
+    QList<KisTextureMaskInfoSP> m_infos;
 };
 
 #endif // KISTEXTUREMASKINFO_H
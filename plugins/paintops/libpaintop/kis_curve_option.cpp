@@ -20,6 +20,9 @@
 #include "kis_curve_option.h"
 
 #include <QDomNode>
+#include <QVarLengthArray>
+
+#include <algorithm>
 
 KisCurveOption::KisCurveOption(const QString& name, KisPaintOpOption::PaintopCategory category,
                                bool checked, qreal value, qreal min, qreal max)
@@ -31,6 +34,7 @@ KisCurveOption::KisCurveOption(const QString& name, KisPaintOpOption::PaintopCat
     , m_useSameCurve(true)
     , m_separateCurveValue(false)
     , m_curveMode(0)
+    , m_compiledSensorsValid(false)
 {
     Q_FOREACH (const DynamicSensorType sensorType, KisDynamicSensor::sensorsTypes()) {
         KisDynamicSensorSP sensor = KisDynamicSensor::type2Sensor(sensorType, m_name);
@@ -38,6 +42,7 @@ KisCurveOption::KisCurveOption(const QString& name, KisPaintOpOption::PaintopCat
         replaceSensor(sensor);
     }
     m_sensorMap[PRESSURE]->setActive(true);
+    compileSensors();
 
     setValueRange(min, max);
     setValue(value);
@@ -79,6 +84,9 @@ void KisCurveOption::resetAllSensors()
             sensor->reset();
         }
     }
+
+    // a new stroke is starting, so take the latest state of the sensors
+    compileSensors();
 }
 
 void KisCurveOption::writeOptionSetting(KisPropertiesConfigurationSP setting) const
@@ -212,16 +220,22 @@ void KisCurveOption::readNamedOptionSetting(const QString& prefix, const KisProp
 
     m_curveMode = setting->getInt(m_name + "curveMode");
     //dbgKrita << "-----------------";
+
+    compileSensors();
 }
 
 void KisCurveOption::replaceSensor(KisDynamicSensorSP s)
 {
     Q_ASSERT(s);
     m_sensorMap[s->sensorType()] = s;
+    compileSensors();
 }
 
 KisDynamicSensorSP KisCurveOption::sensor(DynamicSensorType sensorType, bool active) const
 {
+    // the caller may change the sensor
+    invalidateCompiledSensors();
+
     if (m_sensorMap.contains(sensorType)) {
         if (!active) {
             return m_sensorMap[sensorType];
@@ -238,8 +252,11 @@ KisDynamicSensorSP KisCurveOption::sensor(DynamicSensorType sensorType, bool act
 
 bool KisCurveOption::isRandom() const
 {
-    return bool(sensor(FUZZY_PER_DAB, true)) ||
-        bool(sensor(FUZZY_PER_STROKE, true));
+    auto isActive = [this] (DynamicSensorType sensorType) {
+        return m_sensorMap.contains(sensorType) && m_sensorMap[sensorType]->isActive();
+    };
+
+    return isActive(FUZZY_PER_DAB) || isActive(FUZZY_PER_STROKE);
 }
 
 bool KisCurveOption::isCurveUsed() const
@@ -340,6 +357,8 @@ void KisCurveOption::setCurve(DynamicSensorType sensorType, bool useSameCurve, c
         }
         m_useSameCurve = useSameCurve;
     }
+
+    compileSensors();
 }
 
 void KisCurveOption::setValueRange(qreal min, qreal max)
@@ -353,55 +372,106 @@ void KisCurveOption::setValue(qreal value)
     m_value = qBound(m_minValue, value, m_maxValue);
 }
 
+void KisCurveOption::invalidateCompiledSensors() const
+{
+    m_compiledSensorsValid = false;
+}
+
+void KisCurveOption::compileSensors()
+{
+    collectCompiledSensors(&m_compiledSensors);
+    m_compiledSensorsValid = true;
+}
+
+void KisCurveOption::collectCompiledSensors(QVector<CompiledSensor> *compiledSensors) const
+{
+    compiledSensors->clear();
+
+    QMap<DynamicSensorType, KisDynamicSensorSP>::const_iterator i;
+    for (i = m_sensorMap.constBegin(); i != m_sensorMap.constEnd(); ++i) {
+        KisDynamicSensor *s = i.value().data();
+
+        if (s->isActive()) {
+            CompiledSensor compiled;
+            compiled.sensor = s;
+            compiled.kind =
+                s->isAdditive() ? AdditiveSensor :
+                s->isAbsoluteRotation() ? AbsoluteRotationSensor :
+                ScalingSensor;
+
+            compiledSensors->append(compiled);
+        }
+    }
+}
+
 KisCurveOption::ValueComponents KisCurveOption::computeValueComponents(const KisPaintInformation& info) const
 {
     ValueComponents components;
 
     if (m_useCurve) {
-        QMap<DynamicSensorType, KisDynamicSensorSP>::const_iterator i;
-        QList<double> sensorValues;
-        for (i = m_sensorMap.constBegin(); i != m_sensorMap.constEnd(); ++i) {
-            KisDynamicSensorSP s(i.value());
-
-            if (s->isActive()) {
-                if (s->isAdditive()) {
-                    components.additive += s->parameter(info);
-                    components.hasAdditive = true;
-                } else if (s->isAbsoluteRotation()) {
-                    components.absoluteOffset = s->parameter(info);
-                    components.hasAbsoluteOffset =true;
-                } else {
-                    sensorValues << s->parameter(info);
-                    components.hasScaling = true;
-                }
+        /**
+         * The dabs may be computed from several threads at once, so
+         * this method never touches the compiled list. If the sensors
+         * have been handed out for modification after it was built,
+         * a temporary list is collected for this call only.
+         */
+        QVector<CompiledSensor> localSensors;
+        const QVector<CompiledSensor> *compiledSensors = &m_compiledSensors;
+
+        if (!m_compiledSensorsValid) {
+            collectCompiledSensors(&localSensors);
+            compiledSensors = &localSensors;
+        }
+
+        // the sensors are evaluated in the order of the map, as before
+        QVarLengthArray<qreal, 32> sensorValues;
+
+        for (const CompiledSensor &compiled : *compiledSensors) {
+            const qreal value = compiled.sensor->parameter(info);
+
+            switch (compiled.kind) {
+            case AdditiveSensor:
+                components.additive += value;
+                components.hasAdditive = true;
+                break;
+            case AbsoluteRotationSensor:
+                components.absoluteOffset = value;
+                components.hasAbsoluteOffset = true;
+                break;
+            case ScalingSensor:
+                sensorValues.append(value);
+                components.hasScaling = true;
+                break;
             }
         }
 
-        if (sensorValues.count() == 1) {
-            components.scaling = sensorValues.first();
-        } else {
+        const int numSensorValues = sensorValues.size();
+        const qreal *valuesBegin = sensorValues.constData();
+        const qreal *valuesEnd = valuesBegin + numSensorValues;
 
-            if (m_curveMode == 1){           // add
-                components.scaling = 0;
-                double i;
-                foreach (i, sensorValues) {
-                    components.scaling += i;
-                }
-            } else if (m_curveMode == 2){    //max
-                components.scaling = *std::max_element(sensorValues.begin(), sensorValues.end());
+        if (numSensorValues == 1) {
+            components.scaling = sensorValues[0];
+        } else if (m_curveMode == 1) {       // add
+            components.scaling = 0;
+            for (const qreal *v = valuesBegin; v != valuesEnd; ++v) {
+                components.scaling += *v;
+            }
+        } else if (numSensorValues > 1) {
+
+            if (m_curveMode == 2){           //max
+                components.scaling = *std::max_element(valuesBegin, valuesEnd);
 
             } else if (m_curveMode == 3){    //min
-                components.scaling = *std::min_element(sensorValues.begin(), sensorValues.end());
+                components.scaling = *std::min_element(valuesBegin, valuesEnd);
 
             } else if (m_curveMode == 4){    //difference
-                double max = *std::max_element(sensorValues.begin(), sensorValues.end());
-                double min = *std::min_element(sensorValues.begin(), sensorValues.end());
+                qreal max = *std::max_element(valuesBegin, valuesEnd);
+                qreal min = *std::min_element(valuesBegin, valuesEnd);
                 components.scaling = max-min;
 
             } else {                         //multuply - default
-                double i;
-                foreach (i, sensorValues) {
-                    components.scaling *= i;
+                for (const qreal *v = valuesBegin; v != valuesEnd; ++v) {
+                    components.scaling *= *v;
                 }
             }
         }
@@ -432,12 +502,18 @@ qreal KisCurveOption::computeRotationLikeValue(const KisPaintInformation& info,
 
 QList<KisDynamicSensorSP> KisCurveOption::sensors()
 {
+    // the caller may change the sensors
+    invalidateCompiledSensors();
+
     //dbgKrita << "ID" << name() << "has" <<  m_sensorMap.count() << "Sensors of which" << sensorList.count() << "are active.";
     return m_sensorMap.values();
 }
 
 QList<KisDynamicSensorSP> KisCurveOption::activeSensors() const
 {
+    // the caller may change the sensors
+    invalidateCompiledSensors();
+
     QList<KisDynamicSensorSP> sensorList;
     Q_FOREACH (KisDynamicSensorSP sensor, m_sensorMap.values()) {
         if (sensor->isActive()) {
@@ -205,6 +205,32 @@ protected:
 
 private:
 
+    /**
+     * The active sensors are sorted out into a flat list before the
+     * first dab, so computeValueComponents() doesn't need to walk the
+     * sensor map and ask every sensor about its kind on every dab.
+     * The list is rebuilt by the non-const methods that change the
+     * sensors. The const accessors that return the sensors only mark
+     * it as outdated, since the caller may modify them.
+     */
+    enum CompiledSensorKind {
+        ScalingSensor,
+        AdditiveSensor,
+        AbsoluteRotationSensor
+    };
+
+    struct CompiledSensor {
+        KisDynamicSensor *sensor;
+        CompiledSensorKind kind;
+    };
+
+    void compileSensors();
+    void collectCompiledSensors(QVector<CompiledSensor> *compiledSensors) const;
+    void invalidateCompiledSensors() const;
+
+    QVector<CompiledSensor> m_compiledSensors;
+    mutable bool m_compiledSensorsValid;
+
     qreal m_value;
     qreal m_minValue;
     qreal m_maxValue;
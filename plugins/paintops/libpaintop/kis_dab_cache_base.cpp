@@ -28,6 +28,9 @@
 #include <kis_precision_option.h>
 #include <kis_fixed_paint_device.h>
 #include <brushengine/kis_paintop.h>
+#include <kis_auto_brush.h>
+
+#include <QtMath>
 
 #include <kundo2command.h>
 
@@ -88,7 +91,11 @@ struct KisDabCacheBase::Private {
 
     SavedDabParameters lastSavedDabParameters;
 
+    bool sharedCacheKeyInitialized = false;
+    QString sharedCacheBrushKey;
+
     static qreal positiveFraction(qreal x);
+    static QString sharedCacheBrushKeyFor(KisBrushSP brush);
 };
 
 
@@ -163,6 +170,25 @@ struct KisDabCacheBase::DabPosition {
     qreal realAngle;
 };
 
+QString KisDabCacheBase::Private::sharedCacheBrushKeyFor(KisBrushSP brush)
+{
+    /**
+     * Pipe brushes change their state on every dab and randomized
+     * auto brushes generate a new mask every time, so they cannot
+     * share the dabs between the strokes
+     */
+    if (brush->brushType() != MASK && brush->brushType() != IMAGE) {
+        return QString();
+    }
+
+    KisAutoBrush *autoBrush = dynamic_cast<KisAutoBrush*>(brush.data());
+    if (autoBrush && (autoBrush->randomness() > 0.0 || autoBrush->density() < 1.0)) {
+        return QString();
+    }
+
+    return brush->contentCacheKey();
+}
+
 qreal KisDabCacheBase::Private::positiveFraction(qreal x) {
     qint32 unused = 0;
     qreal fraction = 0.0;
@@ -273,6 +299,42 @@ void KisDabCacheBase::fetchDabGenerationInfo(bool hasDabInCache,
 
     if (!*shouldUseCache) {
         m_d->lastSavedDabParameters = newParams;
+
+        if (!m_d->sharedCacheKeyInitialized) {
+            m_d->sharedCacheBrushKey = Private::sharedCacheBrushKeyFor(resources->brush);
+            m_d->sharedCacheKeyInitialized = true;
+        }
+
+        /**
+         * The highest precision level asks for the exact dabs, so the
+         * shared cache is used only on the lower ones. The parameters
+         * are quantized with the same tolerance as the ones used for
+         * comparing with the previous dab.
+         */
+        const int lastPrecisionLevel = sizeof(precisionLevels) / sizeof(PrecisionValues) - 1;
+
+        di->useSharedCache =
+            di->solidColorFill &&
+            precisionLevel < lastPrecisionLevel &&
+            !m_d->sharedCacheBrushKey.isEmpty();
+
+        if (di->useSharedCache) {
+            const PrecisionValues &prec = precisionLevels[precisionLevel];
+
+            KisSharedDabCache::Key &key = di->sharedCacheKey;
+            key.brushKey = m_d->sharedCacheBrushKey;
+            key.color = QByteArray(reinterpret_cast<const char*>(newParams.color.data()),
+                                   newParams.color.colorSpace()->pixelSize());
+            key.width = newParams.width;
+            key.height = newParams.height;
+            key.angle = qFloor(newParams.angle / prec.angle);
+            key.subPixelX = qFloor(newParams.subPixelX / prec.subPixel);
+            key.subPixelY = qFloor(newParams.subPixelY / prec.subPixel);
+            key.softness = qFloor(newParams.softnessFactor / prec.softnessFactor);
+            key.brushIndex = newParams.index;
+            key.horizontalMirror = newParams.mirrorProperties.horizontalMirror;
+            key.verticalMirror = newParams.mirrorProperties.verticalMirror;
+        }
     }
 
     di->needsPostprocessing = needSeparateOriginal(resources->textureOption.data(), resources->sharpnessOption.data());
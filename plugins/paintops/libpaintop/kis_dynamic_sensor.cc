@@ -509,6 +509,7 @@ void KisDynamicSensor::fromXML(const QDomElement& e)
     if (!curve_elt.isNull()) {
         m_customCurve = true;
         m_curve.fromString(curve_elt.text());
+        m_curveTransfer = m_curve.floatTransfer(256);
     }
 }
 
@@ -518,8 +519,7 @@ qreal KisDynamicSensor::parameter(const KisPaintInformation& info)
     if (m_customCurve) {
         qreal scaledVal = isAdditive() ? additiveToScaling(val) : val;
 
-        const QVector<qreal> transfer = m_curve.floatTransfer(256);
-        scaledVal = KisCubicCurve::interpolateLinear(scaledVal, transfer);
+        scaledVal = KisCubicCurve::interpolateLinear(scaledVal, m_curveTransfer);
 
         return isAdditive() ? scalingToAdditive(scaledVal) : scaledVal;
     }
@@ -532,6 +532,7 @@ void KisDynamicSensor::setCurve(const KisCubicCurve& curve)
 {
     m_customCurve = true;
     m_curve = curve;
+    m_curveTransfer = m_curve.floatTransfer(256);
 }
 
 const KisCubicCurve& KisDynamicSensor::curve() const
@@ -213,6 +213,8 @@ private:
     DynamicSensorType m_type;
     bool m_customCurve;
     KisCubicCurve m_curve;
+    // the curve is sampled once when it is set, not on every dab
+    QVector<qreal> m_curveTransfer;
     bool m_active;
 
 };
@@ -30,6 +30,7 @@
 #include <QTransform>
 #include <QPainter>
 #include <QBoxLayout>
+#include <QVarLengthArray>
 
 #include <klocalizedstring.h>
 
@@ -38,10 +39,9 @@
 #include <kis_multipliers_double_slider_spinbox.h>
 #include <resources/KoPattern.h>
 #include <kis_paint_device.h>
-#include <kis_fill_painter.h>
 #include <kis_painter.h>
-#include <kis_iterator_ng.h>
 #include <kis_fixed_paint_device.h>
+#include <KoColorSpace.h>
 #include <KisGradientSlider.h>
 #include "kis_embedded_pattern_manager.h"
 #include <brushengine/kis_paintop_lod_limitations.h>
@@ -230,44 +230,71 @@ void KisTextureProperties::apply(KisFixedPaintDeviceSP dab, const QPoint &offset
 {
     if (!m_enabled) return;
 
-    KisPaintDeviceSP fillDevice = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
-    QRect rect = dab->bounds();
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_maskInfo->hasMask());
 
-    KisPaintDeviceSP mask = m_maskInfo->mask();
+    const QRect rect = dab->bounds();
     const QRect maskBounds = m_maskInfo->maskBounds();
+    const int maskWidth = maskBounds.width();
+    const int maskHeight = maskBounds.height();
 
-    KIS_SAFE_ASSERT_RECOVER_RETURN(mask);
+    auto wrap = [] (int value, int size) {
+        value %= size;
+        return value >= 0 ? value : value + size;
+    };
 
-    int x = offset.x() % maskBounds.width() - m_offsetX;
-    int y = offset.y() % maskBounds.height() - m_offsetY;
+    const int x = wrap(offset.x() % maskWidth - m_offsetX, maskWidth);
+    const int y = wrap(offset.y() % maskHeight - m_offsetY, maskHeight);
 
+    const qreal pressure = m_strengthOption.apply(info);
+    const KoColorSpace *cs = dab->colorSpace();
+    const int pixelSize = dab->pixelSize();
+    quint8 *dabData = dab->data();
 
-    KisFillPainter fillPainter(fillDevice);
-    fillPainter.fillRect(x - 1, y - 1, rect.width() + 2, rect.height() + 2, mask, maskBounds);
-    fillPainter.end();
+    /**
+     * The mask row is collected for the whole dab row, wrapping
+     * around the pattern, and then applied to the dab in one call,
+     * instead of calling into the color space for every pixel
+     */
+    QVarLengthArray<quint8, 1024> maskRow(rect.width());
 
-    qreal pressure = m_strengthOption.apply(info);
-    quint8 *dabData = dab->data();
+    quint8 pressureTable[256];
+    for (int i = 0; i < 256; i++) {
+        pressureTable[i] = m_texturingMode == MULTIPLY ? quint8(i * pressure) : quint8(i);
+    }
+
+    const int pressureOffset = (1.0 - pressure) * 255;
 
-    KisHLineIteratorSP iter = fillDevice->createHLineIteratorNG(x, y, rect.width());
     for (int row = 0; row < rect.height(); ++row) {
-        for (int col = 0; col < rect.width(); ++col) {
-            if (m_texturingMode == MULTIPLY) {
-                dab->colorSpace()->multiplyAlpha(dabData, quint8(*iter->oldRawData() * pressure), 1);
+        const quint8 *srcRow = m_maskInfo->maskRow((y + row) % maskHeight);
+        quint8 *dstRow = maskRow.data();
+
+        int srcX = x;
+        int col = 0;
+
+        while (col < rect.width()) {
+            const int numPixels = qMin(maskWidth - srcX, rect.width() - col);
+
+            for (int i = 0; i < numPixels; i++) {
+                dstRow[col + i] = pressureTable[srcRow[srcX + i]];
             }
-            else {
-                int pressureOffset = (1.0 - pressure) * 255;
 
-                qint16 maskA = *iter->oldRawData() + pressureOffset;
-                quint8 dabA = dab->colorSpace()->opacityU8(dabData);
+            col += numPixels;
+            srcX = 0;
+        }
+
+        if (m_texturingMode == MULTIPLY) {
+            cs->applyAlphaU8Mask(dabData, dstRow, rect.width());
+            dabData += rect.width() * pixelSize;
+        } else {
+            for (col = 0; col < rect.width(); ++col) {
+                qint16 maskA = dstRow[col] + pressureOffset;
+                quint8 dabA = cs->opacityU8(dabData);
 
                 dabA = qMax(0, (qint16)dabA - maskA);
-                dab->colorSpace()->setOpacity(dabData, dabA, 1);
-            }
+                cs->setOpacity(dabData, dabA, 1);
 
-            iter->nextPixel();
-            dabData += dab->pixelSize();
+                dabData += pixelSize;
+            }
         }
-        iter->nextRow();
     }
 }
@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisParticleDepositorTest.h"
+
+#include <QTest>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoCompositeOpRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+#include <brushengine/kis_random_source.h>
+#include <KisParticleDepositor.h>
+
+#include "testutil.h"
+
+
+/**
+ * Writes the particles both with the depositor and directly with
+ * a random accessor. The number of the particles is big enough to
+ * make the depositor use the threaded path. When \p splitBatch is
+ * set, the second half of the particles is collected by a separate
+ * depositor and appended to the first one.
+ */
+inline void testParticles(KisParticleDepositor::Operation op, bool splitBatch = false)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const KoCompositeOp *overOp = cs->compositeOp(COMPOSITE_OVER);
+
+    KisPaintDeviceSP dev1 = new KisPaintDevice(cs);
+    KisPaintDeviceSP dev2 = new KisPaintDevice(cs);
+
+    KisRandomAccessorSP accessor = dev2->createRandomAccessorNG(0, 0);
+
+    const QColor colors[] = {Qt::red, Qt::green, Qt::blue};
+
+    KisRandomSource randomSource(1);
+    KisParticleDepositor depositor;
+    KisParticleDepositor secondDepositor;
+
+    const int numParticles = 20000;
+
+    for (int i = 0; i < numParticles; i++) {
+        KoColor color(colors[i % 3], cs);
+        color.setOpacity(quint8(randomSource.generate(0, 255)));
+
+        const int x = randomSource.generate(-300, 300);
+        const int y = randomSource.generate(-300, 300);
+        // the depositor keeps the opacity in a float, so avoid the values rounded differently
+        const qreal opacity = randomSource.generate(0, 255) / 255.0;
+
+        KisParticleDepositor &currentDepositor =
+            splitBatch && i >= numParticles / 2 ? secondDepositor : depositor;
+
+        currentDepositor.setColor(color);
+        currentDepositor.addPixel(x, y, op, opacity);
+
+        accessor->moveTo(x, y);
+        quint8 *dst = accessor->rawData();
+
+        switch (op) {
+        case KisParticleDepositor::Copy:
+            memcpy(dst, color.data(), cs->pixelSize());
+            break;
+        case KisParticleDepositor::CopyWithOpacity:
+            memcpy(dst, color.data(), cs->pixelSize());
+            cs->setOpacity(dst, opacity, 1);
+            break;
+        case KisParticleDepositor::AddOpacity: {
+            const quint8 newOpacity =
+                qMin(int(OPACITY_OPAQUE_U8), qRound(opacity * OPACITY_OPAQUE_U8) + cs->opacityU8(dst));
+
+            memcpy(dst, color.data(), cs->pixelSize());
+            cs->setOpacity(dst, newOpacity, 1);
+            break;
+        }
+        case KisParticleDepositor::CopyIfMoreOpaque:
+            if (cs->opacityU8(dst) < color.opacityU8()) {
+                memcpy(dst, color.data(), cs->pixelSize());
+            }
+            break;
+        case KisParticleDepositor::Over:
+            overOp->composite(dst, cs->pixelSize(), color.data(), cs->pixelSize(), 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+            break;
+        case KisParticleDepositor::OverWithOpacity:
+            color.setOpacity(opacity);
+            overOp->composite(dst, cs->pixelSize(), color.data(), cs->pixelSize(), 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+            break;
+        }
+    }
+
+    if (splitBatch) {
+        QCOMPARE(depositor.size(), numParticles / 2);
+        depositor.append(secondDepositor);
+        QCOMPARE(secondDepositor.size(), 0);
+    }
+
+    QCOMPARE(depositor.size(), numParticles);
+
+    depositor.deposit(dev1);
+
+    QCOMPARE(depositor.size(), 0);
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::comparePaintDevices(errorPoint, dev1, dev2));
+}
+
+void KisParticleDepositorTest::testCopy()
+{
+    testParticles(KisParticleDepositor::Copy);
+}
+
+void KisParticleDepositorTest::testCopyWithOpacity()
+{
+    testParticles(KisParticleDepositor::CopyWithOpacity);
+}
+
+void KisParticleDepositorTest::testAddOpacity()
+{
+    testParticles(KisParticleDepositor::AddOpacity);
+}
+
+void KisParticleDepositorTest::testCopyIfMoreOpaque()
+{
+    testParticles(KisParticleDepositor::CopyIfMoreOpaque);
+}
+
+void KisParticleDepositorTest::testOver()
+{
+    testParticles(KisParticleDepositor::Over);
+}
+
+void KisParticleDepositorTest::testOverWithOpacity()
+{
+    testParticles(KisParticleDepositor::OverWithOpacity);
+}
+
+void KisParticleDepositorTest::testAppend()
+{
+    testParticles(KisParticleDepositor::OverWithOpacity, true);
+}
+
+QTEST_MAIN(KisParticleDepositorTest)
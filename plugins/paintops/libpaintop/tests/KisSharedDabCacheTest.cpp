@@ -0,0 +1,192 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisSharedDabCacheTest.h"
+
+#include <QTest>
+#include <QPainter>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_fixed_paint_device.h>
+#include <kis_gbr_brush.h>
+#include <kis_dab_shape.h>
+#include <brushengine/kis_paint_information.h>
+#include <KisSharedDabCache.h>
+#include <kis_dab_cache.h>
+
+
+inline KisFixedPaintDeviceSP createDab(const KoColorSpace *cs, int size, const QColor &color)
+{
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+    dab->setRect(QRect(0, 0, size, size));
+    dab->initialize();
+    dab->fill(dab->bounds(), KoColor(color, cs));
+    return dab;
+}
+
+inline KisSharedDabCache::Key createKey(const KoColorSpace *cs, int size, int angle)
+{
+    KisSharedDabCache::Key key;
+    key.brushKey = "test_brush";
+    key.colorSpace = cs;
+    key.width = size;
+    key.height = size;
+    key.angle = angle;
+    return key;
+}
+
+void KisSharedDabCacheTest::testFetchDab()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisSharedDabCache cache;
+
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+
+    QVERIFY(!cache.fetchDab(createKey(cs, 10, 0), dab));
+
+    cache.addDab(createKey(cs, 10, 0), createDab(cs, 10, Qt::red));
+
+    QVERIFY(cache.fetchDab(createKey(cs, 10, 0), dab));
+    QCOMPARE(dab->bounds(), QRect(0, 0, 10, 10));
+    QCOMPARE(KoColor(dab->data(), cs), KoColor(Qt::red, cs));
+
+    // the fetched dab is a copy, the cached one is not changed
+    dab->fill(dab->bounds(), KoColor(Qt::blue, cs));
+    QVERIFY(cache.fetchDab(createKey(cs, 10, 0), dab));
+    QCOMPARE(KoColor(dab->data(), cs), KoColor(Qt::red, cs));
+
+    QVERIFY(!cache.fetchDab(createKey(cs, 10, 1), dab));
+    QVERIFY(!cache.fetchDab(createKey(KoColorSpaceRegistry::instance()->rgb16(), 10, 0), dab));
+
+    KisSharedDabCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.hits, qint64(2));
+    QCOMPARE(stats.misses, qint64(3));
+    QCOMPARE(stats.numDabs, 1);
+    QCOMPARE(stats.hitRate(), 0.4);
+
+    cache.resetStatistics();
+    stats = cache.statistics();
+    QCOMPARE(stats.hits, qint64(0));
+    QCOMPARE(stats.misses, qint64(0));
+    QCOMPARE(stats.numDabs, 1);
+}
+
+void KisSharedDabCacheTest::testMemoryLimit()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisSharedDabCache cache;
+
+    // every dab takes 64 KiB
+    cache.setMemoryLimit(4 * 64 * 1024);
+
+    for (int i = 0; i < 6; i++) {
+        cache.addDab(createKey(cs, 128, i), createDab(cs, 128, Qt::red));
+    }
+
+    KisSharedDabCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.numDabs, 4);
+    QVERIFY(stats.memoryUsage <= stats.memoryLimit);
+
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+
+    // the oldest dabs are evicted first
+    QVERIFY(!cache.fetchDab(createKey(cs, 128, 0), dab));
+    QVERIFY(!cache.fetchDab(createKey(cs, 128, 1), dab));
+    QVERIFY(cache.fetchDab(createKey(cs, 128, 5), dab));
+}
+
+void KisSharedDabCacheTest::testImageBrushesWithSameFileName()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisSharedDabCache::instance()->clear();
+
+    QImage image1(32, 32, QImage::Format_ARGB32);
+    image1.fill(Qt::black);
+
+    QImage image2 = image1;
+    QPainter gc(&image2);
+    gc.fillRect(0, 0, 16, 32, Qt::white);
+    gc.end();
+
+    // custom and clipboard brushes are all saved under the same file name
+    KisBrushSP brush1 = new KisGbrBrush(image1, "custom brush");
+    brush1->setFilename("temporaryKritaBrush.gbr");
+
+    KisBrushSP brush2 = new KisGbrBrush(image2, "custom brush");
+    brush2->setFilename("temporaryKritaBrush.gbr");
+
+    KisBrushSP brush3 = new KisGbrBrush(image1, "custom brush");
+    brush3->setFilename("temporaryKritaBrush.gbr");
+
+    QVERIFY(brush1->contentCacheKey() != brush2->contentCacheKey());
+    QCOMPARE(brush1->contentCacheKey(), brush3->contentCacheKey());
+
+    const QPointF pos(10, 10);
+    const KisPaintInformation info(pos, 1.0);
+    const KoColor color(Qt::black, cs);
+
+    QRect rc1;
+    KisDabCache cache1(brush1);
+    KisFixedPaintDeviceSP dab1 = cache1.fetchDab(cs, color, pos, KisDabShape(), info, 1.0, &rc1);
+
+    QRect rc2;
+    KisDabCache cache2(brush2);
+    KisFixedPaintDeviceSP dab2 = cache2.fetchDab(cs, color, pos, KisDabShape(), info, 1.0, &rc2);
+
+    QCOMPARE(rc1.size(), rc2.size());
+
+    const int dabSize = dab1->bounds().width() * dab1->bounds().height() * cs->pixelSize();
+    QVERIFY(memcmp(dab1->data(), dab2->data(), dabSize) != 0);
+
+    // a brush with the same pixels reuses the dab of the first one
+    KisSharedDabCache::instance()->resetStatistics();
+
+    QRect rc3;
+    KisDabCache cache3(brush3);
+    KisFixedPaintDeviceSP dab3 = cache3.fetchDab(cs, color, pos, KisDabShape(), info, 1.0, &rc3);
+
+    QCOMPARE(KisSharedDabCache::instance()->statistics().hits, qint64(1));
+    QCOMPARE(memcmp(dab1->data(), dab3->data(), dabSize), 0);
+}
+
+void KisSharedDabCacheTest::testCacheKeyWithPercentSigns()
+{
+    QImage image1(32, 32, QImage::Format_ARGB32);
+    image1.fill(Qt::black);
+
+    QImage image2(32, 32, QImage::Format_ARGB32);
+    image2.fill(Qt::white);
+
+    // the file name goes into the XML part of the key
+    KisBrushSP brush1 = new KisGbrBrush(image1, "custom brush");
+    brush1->setFilename("brush%2%3.gbr");
+
+    KisBrushSP brush2 = new KisGbrBrush(image2, "custom brush");
+    brush2->setFilename("brush%2%3.gbr");
+
+    QVERIFY(brush1->contentCacheKey().contains("brush%2%3.gbr"));
+    QVERIFY(brush1->contentCacheKey() != brush2->contentCacheKey());
+}
+
+QTEST_MAIN(KisSharedDabCacheTest)
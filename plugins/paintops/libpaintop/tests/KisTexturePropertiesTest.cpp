@@ -0,0 +1,311 @@
+/*
+ *  Copyright (c) 2026 Krita Developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisTexturePropertiesTest.h"
+
+#include <QTest>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <resources/KoPattern.h>
+
+#include <kis_pointer_utils.h>
+#include <kis_algebra_2d.h>
+#include <kis_paint_device.h>
+#include <kis_fill_painter.h>
+#include <kis_fixed_paint_device.h>
+#include <kis_iterator_ng.h>
+#include <kis_properties_configuration.h>
+#include <brushengine/kis_paint_information.h>
+
+#include <kis_texture_option.h>
+#include <kis_embedded_pattern_manager.h>
+#include <kis_pressure_texture_strength_option.h>
+#include <KisTextureMaskInfo.h>
+
+
+namespace {
+
+/**
+ * The pattern has sizes that are not multiples of each other and of
+ * the dab, so the dab always wraps around the pattern somewhere in
+ * the middle of it. Some pixels are semi-transparent to test how the
+ * alpha of the pattern goes into the mask.
+ */
+QImage createPatternImage()
+{
+    QImage image(37, 23, QImage::Format_ARGB32);
+
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            image.setPixel(x, y, qRgba((x * 7 + y * 3) % 256,
+                                       (x * 13 + y * 29) % 256,
+                                       (x * y * 5) % 256,
+                                       (x + y) % 5 ? 255 : 128 + x + y));
+        }
+    }
+
+    return image;
+}
+
+KisPropertiesConfigurationSP createSettings(const QPoint &patternOffset,
+                                            qreal scale, bool invert,
+                                            int texturingMode, qreal strength)
+{
+    static KoPattern pattern(createPatternImage(), "texture_properties_test_pattern", "");
+
+    KisPropertiesConfigurationSP setting = new KisPropertiesConfiguration();
+    KisEmbeddedPatternManager::saveEmbeddedPattern(setting, &pattern);
+
+    setting->setProperty("Texture/Pattern/Enabled", true);
+    setting->setProperty("Texture/Pattern/Scale", scale);
+    setting->setProperty("Texture/Pattern/Invert", invert);
+    setting->setProperty("Texture/Pattern/OffsetX", patternOffset.x());
+    setting->setProperty("Texture/Pattern/OffsetY", patternOffset.y());
+    setting->setProperty("Texture/Pattern/TexturingMode", texturingMode);
+    setting->setProperty("Texture/Pattern/Strength", strength);
+
+    return setting;
+}
+
+KisFixedPaintDeviceSP createDab()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+    dab->setRect(QRect(0, 0, 83, 61));
+    dab->initialize();
+
+    quint8 *pixel = dab->data();
+    for (int i = 0; i < dab->bounds().width() * dab->bounds().height(); i++) {
+        pixel[0] = (i * 3) % 256;
+        pixel[1] = (i * 5) % 256;
+        pixel[2] = (i * 11) % 256;
+        pixel[3] = (i * 17) % 256;
+        pixel += cs->pixelSize();
+    }
+
+    return dab;
+}
+
+/**
+ * The mask as it was calculated by KisTextureMaskInfo before the
+ * mask was moved from a paint device into a plain buffer
+ */
+KisPaintDeviceSP referenceMask(KisPropertiesConfigurationSP setting, QRect *maskBounds)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
+
+    KoPattern *pattern = KisEmbeddedPatternManager::loadEmbeddedPattern(setting);
+    QImage mask = pattern->pattern().convertToFormat(QImage::Format_ARGB32);
+
+    const qreal scale = setting->getDouble("Texture/Pattern/Scale", 1.0);
+    const bool invert = setting->getBool("Texture/Pattern/Invert");
+
+    QTransform tf;
+    tf.scale(scale, scale);
+    QRect rc = KisAlgebra2D::ensureRectNotSmaller(tf.mapRect(mask.rect()), QSize(2,2));
+    mask = mask.scaled(rc.size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    KisHLineIteratorSP iter = dev->createHLineIteratorNG(0, 0, mask.width());
+
+    for (int row = 0; row < mask.height(); ++row) {
+        for (int col = 0; col < mask.width(); ++col) {
+            const QRgb currentPixel = mask.pixel(col, row);
+
+            const int grayValue = (qRed(currentPixel) * 11 + qGreen(currentPixel) * 16 + qBlue(currentPixel) * 5) / 32;
+            float alpha = qAlpha(currentPixel) / 255.0;
+            float maskValue = (grayValue / 255.0) * alpha + (1 - alpha);
+
+            maskValue = ((maskValue - 0.5) * 1.0) + 0.5;
+
+            if (maskValue > 1.0) {maskValue = 1;}
+            else if (maskValue < 0) {maskValue = 0;}
+
+            if (invert) {
+                maskValue = 1 - maskValue;
+            }
+
+            cs->setOpacity(iter->rawData(), maskValue, 1);
+            iter->nextPixel();
+        }
+        iter->nextRow();
+    }
+
+    *maskBounds = QRect(0, 0, mask.width(), mask.height());
+    return dev;
+}
+
+/**
+ * The per-pixel implementation of KisTextureProperties::apply() that
+ * was used before the mask started being applied row by row
+ */
+void referenceApply(KisFixedPaintDeviceSP dab, const QPoint &offset,
+                    KisPropertiesConfigurationSP setting, const KisPaintInformation &info)
+{
+    QRect maskBounds;
+    KisPaintDeviceSP mask = referenceMask(setting, &maskBounds);
+
+    const int offsetX = setting->getInt("Texture/Pattern/OffsetX");
+    const int offsetY = setting->getInt("Texture/Pattern/OffsetY");
+    const int texturingMode = setting->getInt("Texture/Pattern/TexturingMode");
+
+    KisPressureTextureStrengthOption strengthOption;
+    strengthOption.readOptionSetting(setting);
+    strengthOption.resetAllSensors();
+
+    KisPaintDeviceSP fillDevice = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+    QRect rect = dab->bounds();
+
+    int x = offset.x() % maskBounds.width() - offsetX;
+    int y = offset.y() % maskBounds.height() - offsetY;
+
+    KisFillPainter fillPainter(fillDevice);
+    fillPainter.fillRect(x - 1, y - 1, rect.width() + 2, rect.height() + 2, mask, maskBounds);
+    fillPainter.end();
+
+    qreal pressure = strengthOption.apply(info);
+    quint8 *dabData = dab->data();
+
+    KisHLineIteratorSP iter = fillDevice->createHLineIteratorNG(x, y, rect.width());
+    for (int row = 0; row < rect.height(); ++row) {
+        for (int col = 0; col < rect.width(); ++col) {
+            if (texturingMode == KisTextureProperties::MULTIPLY) {
+                dab->colorSpace()->multiplyAlpha(dabData, quint8(*iter->oldRawData() * pressure), 1);
+            }
+            else {
+                int pressureOffset = (1.0 - pressure) * 255;
+
+                qint16 maskA = *iter->oldRawData() + pressureOffset;
+                quint8 dabA = dab->colorSpace()->opacityU8(dabData);
+
+                dabA = qMax(0, (qint16)dabA - maskA);
+                dab->colorSpace()->setOpacity(dabData, dabA, 1);
+            }
+
+            iter->nextPixel();
+            dabData += dab->pixelSize();
+        }
+        iter->nextRow();
+    }
+}
+
+QByteArray dabBytes(KisFixedPaintDeviceSP dab)
+{
+    return QByteArray(reinterpret_cast<const char*>(dab->data()),
+                      dab->bounds().width() * dab->bounds().height() * dab->pixelSize());
+}
+
+void checkApply(KisPropertiesConfigurationSP setting, const QPoint &offset)
+{
+    KisPaintInformation info(QPointF(offset), 0.7);
+
+    KisFixedPaintDeviceSP refDab = createDab();
+    referenceApply(refDab, offset, setting, info);
+
+    KisTextureProperties properties(0);
+    properties.fillProperties(setting);
+    QVERIFY(properties.m_enabled);
+
+    KisFixedPaintDeviceSP dab = createDab();
+    properties.apply(dab, offset, info);
+
+    QCOMPARE(dabBytes(dab), dabBytes(refDab));
+}
+
+}
+
+void KisTexturePropertiesTest::testApply_data()
+{
+    QTest::addColumn<QPoint>("offset");
+    QTest::addColumn<QPoint>("patternOffset");
+    QTest::addColumn<qreal>("scale");
+    QTest::addColumn<bool>("invert");
+    QTest::addColumn<int>("texturingMode");
+    QTest::addColumn<qreal>("strength");
+
+    const int multiply = KisTextureProperties::MULTIPLY;
+    const int subtract = KisTextureProperties::SUBTRACT;
+
+    QTest::newRow("multiply") << QPoint(0, 0) << QPoint(0, 0) << 1.0 << false << multiply << 1.0;
+    QTest::newRow("multiply-offset") << QPoint(113, 47) << QPoint(0, 0) << 1.0 << false << multiply << 1.0;
+    QTest::newRow("multiply-negative-offset") << QPoint(-113, -47) << QPoint(0, 0) << 1.0 << false << multiply << 1.0;
+    QTest::newRow("multiply-pattern-offset") << QPoint(113, -47) << QPoint(9, 30) << 1.0 << false << multiply << 1.0;
+    QTest::newRow("multiply-scale-down") << QPoint(113, 47) << QPoint(9, 30) << 0.4 << false << multiply << 1.0;
+    QTest::newRow("multiply-scale-up") << QPoint(-113, 47) << QPoint(9, 30) << 2.3 << false << multiply << 1.0;
+    QTest::newRow("multiply-invert") << QPoint(113, 47) << QPoint(0, 0) << 1.0 << true << multiply << 1.0;
+    QTest::newRow("multiply-strength") << QPoint(113, 47) << QPoint(9, 30) << 0.4 << true << multiply << 0.6;
+
+    QTest::newRow("subtract") << QPoint(0, 0) << QPoint(0, 0) << 1.0 << false << subtract << 1.0;
+    QTest::newRow("subtract-negative-offset") << QPoint(-113, -47) << QPoint(9, 30) << 1.0 << false << subtract << 1.0;
+    QTest::newRow("subtract-scale") << QPoint(113, 47) << QPoint(9, 30) << 2.3 << false << subtract << 1.0;
+    QTest::newRow("subtract-invert") << QPoint(113, -47) << QPoint(0, 0) << 0.4 << true << subtract << 1.0;
+    QTest::newRow("subtract-strength") << QPoint(113, 47) << QPoint(9, 30) << 1.0 << true << subtract << 0.6;
+}
+
+void KisTexturePropertiesTest::testApply()
+{
+    QFETCH(QPoint, offset);
+    QFETCH(QPoint, patternOffset);
+    QFETCH(qreal, scale);
+    QFETCH(bool, invert);
+    QFETCH(int, texturingMode);
+    QFETCH(qreal, strength);
+
+    KisPropertiesConfigurationSP setting =
+        createSettings(patternOffset, scale, invert, texturingMode, strength);
+
+    // the first properties object may calculate the mask, the second
+    // one is guaranteed to take it from the cache
+    checkApply(setting, offset);
+    checkApply(setting, offset);
+}
+
+void KisTexturePropertiesTest::testCacheHitAndMiss()
+{
+    const QPoint offset(113, -47);
+
+    KisPropertiesConfigurationSP setting1 =
+        createSettings(QPoint(9, 30), 0.7, false, KisTextureProperties::MULTIPLY, 1.0);
+
+    KisPropertiesConfigurationSP setting2 =
+        createSettings(QPoint(9, 30), 0.7, true, KisTextureProperties::MULTIPLY, 1.0);
+
+    auto fetchMask = [] (KisPropertiesConfigurationSP setting) {
+        KisTextureMaskInfoSP info = toQShared(new KisTextureMaskInfo(0));
+        info->fillProperties(setting);
+        return KisTextureMaskInfoCache::instance()->fetchCachedTextureInfo(info);
+    };
+
+    KisTextureMaskInfoSP mask1 = fetchMask(setting1);
+    KisTextureMaskInfoSP mask2 = fetchMask(setting2);
+
+    // different settings should never share the mask
+    QVERIFY(mask1 != mask2);
+
+    // switching back to the first settings should reuse its mask
+    QCOMPARE(fetchMask(setting1), mask1);
+    QCOMPARE(fetchMask(setting2), mask2);
+
+    checkApply(setting1, offset);
+    checkApply(setting2, offset);
+    checkApply(setting1, offset);
+}
+
+QTEST_MAIN(KisTexturePropertiesTest)
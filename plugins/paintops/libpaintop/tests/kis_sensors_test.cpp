@@ -18,6 +18,8 @@
 
 #include "kis_sensors_test.h"
 #include <kis_dynamic_sensor.h>
+#include <kis_curve_option.h>
+#include <kis_cubic_curve.h>
 
 #include <QTest>
 
@@ -39,6 +41,24 @@ void KisSensorsTest::testDrawingAngle()
     testBound(sensor);
 }
 
+void KisSensorsTest::testCurveOptionSensors()
+{
+    KisCurveOption option("testname", KisPaintOpOption::GENERAL, true, 1.0, 0.0, 1.0);
+    const KisPaintInformation pi(QPointF(), 0.5);
+
+    QCOMPARE(option.computeSizeLikeValue(pi), 0.5);
+
+    QList<QPointF> points;
+    points << QPointF(0.0, 0.0) << QPointF(1.0, 0.5);
+    option.setCurve(PRESSURE, true, KisCubicCurve(points));
+
+    QVERIFY(qAbs(option.computeSizeLikeValue(pi) - 0.25) < 0.01);
+
+    // the sensor is disabled after the option has already been evaluated
+    option.sensor(PRESSURE, false)->setActive(false);
+    QCOMPARE(option.computeSizeLikeValue(pi), 1.0);
+}
+
 void KisSensorsTest::testBound(KisDynamicSensorSP sensor)
 {
     Q_FOREACH (const KisPaintInformation & pi, paintInformations) {
@@ -32,6 +32,7 @@ public:
 private Q_SLOTS:
 
     void testDrawingAngle();
+    void testCurveOptionSensors();
 private:
     void testBound(KisDynamicSensorSP sensor);
 private:
@@ -19,7 +19,6 @@
 #include "particle_brush.h"
 
 #include "kis_paint_device.h"
-#include "kis_random_accessor_ng.h"
 
 #include <KoColorSpace.h>
 #include <KoColor.h>
@@ -55,46 +54,10 @@ void ParticleBrush::setInitialPosition(const QPointF &pos)
 }
 
 
-void ParticleBrush::paintParticle(KisRandomAccessorSP accWrite, const KoColorSpace * cs, const QPointF &pos, const KoColor& color, qreal weight, bool respectOpacity)
-{
-    // opacity top left, right, bottom left, right
-    KoColor myColor(color);
-    quint8 opacity = respectOpacity ? myColor.opacityU8() : OPACITY_OPAQUE_U8;
-
-    int ipx = floor(pos.x());
-    int ipy = floor(pos.y());
-    qreal fx = pos.x() - ipx;
-    qreal fy = pos.y() - ipy;
-
-    quint8 btl = qRound((1.0 - fx) * (1.0 - fy) * opacity * weight);
-    quint8 btr = qRound((fx)  * (1.0 - fy) * opacity * weight);
-    quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity * weight);
-    quint8 bbr = qRound((fx)  * (fy)  * opacity * weight);
-
-    accWrite->moveTo(ipx  , ipy);
-    myColor.setOpacity(quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btl + cs->opacityU8(accWrite->rawData()), OPACITY_OPAQUE_U8)));
-    memcpy(accWrite->rawData(), myColor.data(), cs->pixelSize());
-
-    accWrite->moveTo(ipx + 1, ipy);
-    myColor.setOpacity(quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btr + cs->opacityU8(accWrite->rawData()), OPACITY_OPAQUE_U8)));
-    memcpy(accWrite->rawData(), myColor.data(), cs->pixelSize());
-
-    accWrite->moveTo(ipx, ipy + 1);
-    myColor.setOpacity(quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbl + cs->opacityU8(accWrite->rawData()), OPACITY_OPAQUE_U8)));
-    memcpy(accWrite->rawData(), myColor.data(), cs->pixelSize());
-
-    accWrite->moveTo(ipx + 1, ipy + 1);
-    myColor.setOpacity(quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbr + cs->opacityU8(accWrite->rawData()), OPACITY_OPAQUE_U8)));
-    memcpy(accWrite->rawData(), myColor.data(), cs->pixelSize());
-}
-
-
-
-
 void ParticleBrush::draw(KisPaintDeviceSP dab, const KoColor& color, const QPointF &pos)
 {
-    KisRandomAccessorSP accessor = dab->createRandomAccessorNG(qRound(pos.x()), qRound(pos.y()));
-    const KoColorSpace * cs = dab->colorSpace();
+    const qreal opacity = qreal(color.opacityU8()) / OPACITY_OPAQUE_U8 * m_properties->weight;
+    m_depositor.setColor(color);
 
     QRect boundingRect;
 
@@ -141,11 +104,14 @@ void ParticleBrush::draw(KisPaintDeviceSP dab, const KoColor& color, const QPoin
             if (boundingRect.isEmpty() ||
                     boundingRect.contains(m_particlePos[j].toPoint())) {
 
-                paintParticle(accessor, cs, m_particlePos[j], color, m_properties->weight, true);
+                m_depositor.addParticle(m_particlePos[j].x(), m_particlePos[j].y(),
+                                        KisParticleDepositor::AddOpacity, opacity);
             }
 
         }//for j
     }//for i
+
+    m_depositor.deposit(dab);
 }
 
 
@@ -133,7 +133,6 @@ void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
 
     qreal x = info.pos().x();
     qreal y = info.pos().y();
-    KisRandomAccessorSP accessor = dab->createRandomAccessorNG(qRound(x), qRound(y));
 
     Q_ASSERT(color.colorSpace()->pixelSize() == dab->pixelSize());
     m_inkColor = color;
@@ -291,15 +290,18 @@ void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
             }
             // wu-particle
             case 2: {
-                paintParticle(accessor, m_inkColor, nx + x, ny + y);
+                // this version overwrites pixels, e.g. when it sprays two particles next
+                // to each other, the pixel with lower opacity can override other pixel.
+                m_depositor.setColor(m_inkColor);
+                m_depositor.addParticle(nx + x, ny + y, KisParticleDepositor::CopyWithOpacity);
                 break;
             }
             // pixel
             case 3: {
                 ix = qRound(nx + x);
                 iy = qRound(ny + y);
-                accessor->moveTo(ix, iy);
-                memcpy(accessor->rawData(), m_inkColor.data(), m_dabPixelSize);
+                m_depositor.setColor(m_inkColor);
+                m_depositor.addPixel(ix, iy, KisParticleDepositor::Copy);
                 break;
             }
             case 4: {
@@ -374,49 +376,14 @@ void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
             m_inkColor=color;//reset color//
         }
     }
+    m_depositor.deposit(dab);
+
     // recover from jittering of color,
     // m_inkColor.opacity is recovered with every paint
 }
 
 
 
-void SprayBrush::paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry)
-{
-    // opacity top left, right, bottom left, right
-    KoColor pcolor(color);
-    //int opacity = pcolor.opacityU8();
-
-    int ipx = int (rx);
-    int ipy = int (ry);
-    qreal fx = rx - ipx;
-    qreal fy = ry - ipy;
-
-    qreal btl = (1 - fx) * (1 - fy);
-    qreal btr = (fx)  * (1 - fy);
-    qreal bbl = (1 - fx) * (fy);
-    qreal bbr = (fx)  * (fy);
-
-    // this version overwrite pixels, e.g. when it sprays two particle next
-    // to each other, the pixel with lower opacity can override other pixel.
-    // Maybe some kind of compositing using here would be cool
-
-    pcolor.setOpacity(btl);
-    writeAccessor->moveTo(ipx  , ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(btr);
-    writeAccessor->moveTo(ipx + 1, ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(bbl);
-    writeAccessor->moveTo(ipx, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(bbr);
-    writeAccessor->moveTo(ipx + 1, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-}
-
 void SprayBrush::paintCircle(KisPainter* painter, qreal x, qreal y, qreal radius)
 {
     QPainterPath path;
@@ -33,6 +33,7 @@
 
 #include <QImage>
 #include <kis_brush.h>
+#include <KisParticleDepositor.h>
 
 class KisPaintInformation;
 
@@ -73,11 +74,12 @@ private:
     KisBrushSP m_brush;
     KisFixedPaintDeviceSP m_fixedDab;
 
+    /// pixel and wu particle shapes are written into the dab in one batch
+    KisParticleDepositor m_depositor;
+
 private:
     /// rotation in radians according the settings (gauss distribution, uniform distribution or fixed angle)
     qreal rotationAngle(KisRandomSourceSP randomSource);
-    /// Paints Wu Particle
-    void paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry);
     void paintCircle(KisPainter * painter, qreal x, qreal y, qreal radius);
     void paintEllipse(KisPainter * painter, qreal x, qreal y, qreal a, qreal b, qreal angle);
     void paintRectangle(KisPainter * painter, qreal x, qreal y, qreal width, qreal height, qreal angle);
@@ -32,6 +32,12 @@
 #include <kis_image.h>
 #include <kis_lod_transform.h>
 #include <kis_paintop_plugin_utils.h>
+#include <kis_default_bounds_base.h>
+#include <kis_pressure_sharpness_option.h>
+#include <kis_texture_option.h>
+#include <KisDabCacheUtils.h>
+#include <KisDabRenderingExecutor.h>
+#include <KisDabRenderingUpdater.h>
 
 
 KisTangentNormalPaintOp::KisTangentNormalPaintOp(const KisPaintOpSettingsSP settings, KisPainter* painter, KisNodeSP node, KisImageSP image):
@@ -64,8 +70,42 @@ KisTangentNormalPaintOp::KisTangentNormalPaintOp(const KisPaintOpSettingsSP sett
     m_rotationOption.resetAllSensors();
     m_scatterOption.resetAllSensors();
 
-    m_dabCache->setSharpnessPostprocessing(&m_sharpnessOption);
     m_rotationOption.applyFanCornersInfo(this);
+
+    /**
+     * The dabs are rendered in the stroke's worker threads, so the
+     * brush should not do any threading internally
+     */
+    m_brush->setThreadingAllowed(false);
+
+    KisBrushSP baseBrush = m_brush;
+    const int lod = painter->device()->defaultBounds()->currentLevelOfDetail();
+
+    auto resourcesFactory =
+        [baseBrush, settings, lod] () {
+            KisDabCacheUtils::DabRenderingResources *resources =
+                new KisDabCacheUtils::DabRenderingResources();
+            resources->brush = baseBrush->clone();
+
+            resources->sharpnessOption.reset(new KisPressureSharpnessOption());
+            resources->sharpnessOption->readOptionSetting(settings);
+            resources->sharpnessOption->resetAllSensors();
+
+            resources->textureOption.reset(new KisTextureProperties(lod));
+            resources->textureOption->fillProperties(settings);
+
+            return resources;
+        };
+
+    m_dabExecutor.reset(
+        new KisDabRenderingExecutor(
+                    normalColorSpace(painter->paintColor()),
+                    resourcesFactory,
+                    painter->runnableStrokeJobsInterface(),
+                    &m_mirrorOption,
+                    &m_precisionOption));
+
+    m_dabUpdater.reset(new KisDabRenderingUpdater(m_dabExecutor.data(), painter));
 }
 
 KisTangentNormalPaintOp::~KisTangentNormalPaintOp()
@@ -81,13 +121,7 @@ KisSpacingInformation KisTangentNormalPaintOp::paintAt(const KisPaintInformation
      * if so we request a profile with that space and 8bit bit depth, if not, just sRGB
      */
     KoColor currentColor = painter()->paintColor();
-    QString currentSpace = currentColor.colorSpace()->colorModelId().id();
-    const KoColorSpace* rgbColorSpace = KoColorSpaceRegistry::instance()->rgb8();
-    if (currentSpace != "RGBA") {
-        rgbColorSpace = KoColorSpaceRegistry::instance()->rgb8();
-    } else {
-        rgbColorSpace = currentColor.colorSpace();
-    }
+    const KoColorSpace* rgbColorSpace = normalColorSpace(currentColor);
     QVector <float> channelValues(4);
     qreal r, g, b;
 
@@ -138,37 +172,32 @@ KisSpacingInformation KisTangentNormalPaintOp::paintAt(const KisPaintInformation
                                   brush->maskWidth(shape, 0, 0, info),
                                   brush->maskHeight(shape, 0, 0, info));
 
-    m_maskDab =
-            m_dabCache->fetchDab(rgbColorSpace, color, cursorPos,
-                                 shape,
-                                 info, m_softnessOption.apply(info),
-                                 &m_dstDabRect);
+    m_opacityOption.setFlow(m_flowOption.apply(info));
 
-    if (m_dstDabRect.isEmpty()) return KisSpacingInformation(1.0);
+    quint8 dabOpacity = OPACITY_OPAQUE_U8;
+    quint8 dabFlow = OPACITY_OPAQUE_U8;
 
-    QRect dabRect = m_maskDab->bounds();
+    m_opacityOption.apply(info, &dabOpacity, &dabFlow);
 
-    // sanity check
-    Q_ASSERT(m_dstDabRect.size() == dabRect.size());
-    Q_UNUSED(dabRect);
+    KisDabCacheUtils::DabRequestInfo request(color,
+                                             cursorPos,
+                                             shape,
+                                             info,
+                                             m_softnessOption.apply(info));
 
-    quint8  oldOpacity = painter()->opacity();
-    QString oldCompositeOpId = painter()->compositeOp()->id();
+    m_dabExecutor->addDab(request, qreal(dabOpacity) / 255.0, qreal(dabFlow) / 255.0);
 
+    KisSpacingInformation spacingInfo = computeSpacing(info, scale, rotation);
 
-    m_opacityOption.setFlow(m_flowOption.apply(info));
-    m_opacityOption.apply(painter(), info);
-    //paint with the default color? Copied this from color smudge.//
-    //painter()->setCompositeOp(COMPOSITE_COPY);
-    //painter()->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
-    painter()->bltFixed(m_dstDabRect.topLeft(), m_maskDab, m_maskDab->bounds());
-    painter()->renderMirrorMaskSafe(m_dstDabRect, m_maskDab, !m_dabCache->needSeparateOriginal());
+    // gather statistics about dabs
+    m_dabUpdater->addSpacingSample(spacingInfo.scalarApprox());
 
-    // restore original opacity and composite mode values
-    painter()->setOpacity(oldOpacity);
-    painter()->setCompositeOp(oldCompositeOpId);
+    return spacingInfo;
+}
 
-    return computeSpacing(info, scale, rotation);
+std::pair<int, bool> KisTangentNormalPaintOp::doAsyncronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    return m_dabUpdater->doAsyncronousUpdate(jobs);
 }
 
 KisSpacingInformation KisTangentNormalPaintOp::updateSpacingImpl(const KisPaintInformation &info) const
@@ -183,6 +212,12 @@ KisTimingInformation KisTangentNormalPaintOp::updateTimingImpl(const KisPaintInf
     return KisPaintOpPluginUtils::effectiveTiming(&m_airbrushOption, &m_rateOption, info);
 }
 
+const KoColorSpace* KisTangentNormalPaintOp::normalColorSpace(const KoColor &paintColor)
+{
+    return paintColor.colorSpace()->colorModelId().id() == "RGBA" ?
+        paintColor.colorSpace() : KoColorSpaceRegistry::instance()->rgb8();
+}
+
 KisSpacingInformation KisTangentNormalPaintOp::computeSpacing(const KisPaintInformation &info,
                                                               qreal scale, qreal rotation) const
 {
@@ -202,13 +237,7 @@ void KisTangentNormalPaintOp::paintLine(const KisPaintInformation& pi1, const Ki
 
         KisPainter p(m_lineCacheDevice);
         KoColor currentColor = painter()->paintColor();
-        QString currentSpace = currentColor.colorSpace()->colorModelId().id();
-        const KoColorSpace* rgbColorSpace = KoColorSpaceRegistry::instance()->rgb8();
-        if (currentSpace != "RGBA") {
-            rgbColorSpace = KoColorSpaceRegistry::instance()->rgb8();
-        } else {
-            rgbColorSpace = currentColor.colorSpace();
-        }
+        const KoColorSpace* rgbColorSpace = normalColorSpace(currentColor);
         QVector <float> channelValues(4);
         qreal r, g, b;
 
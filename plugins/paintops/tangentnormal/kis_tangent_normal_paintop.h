@@ -20,6 +20,7 @@
 #define _KIS_TANGENTNORMALPAINTOP_H_
 
 #include <QRect>
+#include <QScopedPointer>
 
 #include <kis_brush_based_paintop.h>
 #include <kis_types.h>
@@ -36,8 +37,13 @@
 #include <kis_pressure_softness_option.h>
 #include <kis_pressure_sharpness_option.h>
 
+class KoColor;
+class KoColorSpace;
 class KisBrushBasedPaintOpSettings;
 class KisPainter;
+class KisDabRenderingExecutor;
+class KisDabRenderingUpdater;
+class KisRunnableStrokeJobData;
 
 class KisTangentNormalPaintOp: public KisBrushBasedPaintOp
 {
@@ -50,6 +56,8 @@ public:
 
     void paintLine(const KisPaintInformation &pi1, const KisPaintInformation &pi2, KisDistanceInformation *currentDistance) override;
 
+    std::pair<int, bool> doAsyncronousUpdate(QVector<KisRunnableStrokeJobData *> &jobs) override;
+
 protected:
     /*paint the dabs*/
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
@@ -62,6 +70,8 @@ private:
     KisSpacingInformation computeSpacing(const KisPaintInformation &info, qreal scale,
                                          qreal rotation) const;
 
+    static const KoColorSpace* normalColorSpace(const KoColor &paintColor);
+
 private:
     //private functions//
     KisPressureSizeOption m_sizeOption;
@@ -76,10 +86,11 @@ private:
     KisPressureSharpnessOption m_sharpnessOption;
     KisPressureFlowOption m_flowOption;
 
-    KisFixedPaintDeviceSP m_maskDab;
     KisPaintDeviceSP m_tempDev;
-    QRect m_dstDabRect;
 
     KisPaintDeviceSP m_lineCacheDevice;
+
+    QScopedPointer<KisDabRenderingExecutor> m_dabExecutor;
+    QScopedPointer<KisDabRenderingUpdater> m_dabUpdater;
 };
 #endif // _KIS_TANGENTNORMALPAINTOP_H_
@@ -24,7 +24,7 @@
 #include <kpluginfactory.h>
 
 #include <brushengine/kis_paintop_registry.h>
-#include <kis_brush_based_paintop_settings.h>
+#include "kis_tangent_normal_paintop_settings.h"
 
 #include "kis_tangent_normal_paintop.h"
 #include "kis_tangent_normal_paintop_settings_widget.h"
@@ -37,7 +37,7 @@ K_PLUGIN_FACTORY_WITH_JSON(TangentNormalPaintOpPluginFactory, "kritatangentnorma
 TangentNormalPaintOpPlugin::TangentNormalPaintOpPlugin(QObject* parent, const QVariantList&):
     QObject(parent)
 {
-    KisPaintOpRegistry::instance()->add(new KisSimplePaintOpFactory<KisTangentNormalPaintOp, KisBrushBasedPaintOpSettings, KisTangentNormalPaintOpSettingsWidget>(
+    KisPaintOpRegistry::instance()->add(new KisSimplePaintOpFactory<KisTangentNormalPaintOp, KisTangentNormalPaintOpSettings, KisTangentNormalPaintOpSettingsWidget>(
                                             "tangentnormal", i18n("Tangent Normal"), KisPaintOpFactory::categoryStable(), "krita-tangentnormal.png",
                                             QString(), QStringList(), 16)
                                        );
@@ -17,7 +17,7 @@
  */
 
 #include "kis_tangent_normal_paintop_settings_widget.h"
-#include "kis_brush_based_paintop_settings.h"
+#include "kis_tangent_normal_paintop_settings.h"
 #include "kis_tangent_tilt_option.h"
 
 #include <kis_properties_configuration.h>
@@ -74,7 +74,7 @@ KisTangentNormalPaintOpSettingsWidget::~KisTangentNormalPaintOpSettingsWidget()
 
 KisPropertiesConfigurationSP KisTangentNormalPaintOpSettingsWidget::configuration() const
 {
-    KisBrushBasedPaintOpSettingsSP config = new KisBrushBasedPaintOpSettings();
+    KisBrushBasedPaintOpSettingsSP config = new KisTangentNormalPaintOpSettings();
     config->setOptionsWidget(const_cast<KisTangentNormalPaintOpSettingsWidget*>(this));
     config->setProperty("paintop", "tangentnormal");
     writeConfiguration(config);
@@ -407,6 +407,57 @@ struct MaskParent
 
 }
 
+#include "kis_sequential_iterator.h"
+
+namespace TestUtil {
+
+/**
+ * The color spaces the file format tests check lossless round
+ * trips in: 8- and 16-bit integer RGBA
+ */
+inline QList<const KoColorSpace*> roundTripColorSpaces()
+{
+    QList<const KoColorSpace*> colorSpaces;
+    colorSpaces << KoColorSpaceRegistry::instance()->rgb8()
+                << KoColorSpaceRegistry::instance()->rgb16();
+    return colorSpaces;
+}
+
+/**
+ * Fills \p rc of \p dev with a pattern where neighbouring pixels,
+ * rows and channels get different values, so that a round trip that
+ * mixes them up, or the bytes of 16-bit channels, fails the byte by
+ * byte comparison. The pixels are made opaque if \p opaque is set.
+ */
+inline void fillRoundTripPattern(KisPaintDeviceSP dev, const QRect &rc, bool opaque = false)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+
+    KisSequentialIterator it(dev, rc);
+    while (it.nextPixel()) {
+        quint8 *pixel = it.rawData();
+        for (quint32 i = 0; i < cs->pixelSize(); i++) {
+            pixel[i] = quint8(it.x() / 3 + it.y() * 7 + i * 41);
+        }
+
+        if (opaque) {
+            cs->setOpacity(pixel, OPACITY_OPAQUE_U8, 1);
+        }
+    }
+}
+
+/**
+ * The raw pixel data of \p rc of \p dev, for comparing round trips
+ */
+inline QByteArray readDeviceBytes(KisPaintDeviceSP dev, const QRect &rc)
+{
+    QByteArray bytes(rc.width() * rc.height() * dev->pixelSize(), 0);
+    dev->readBytes(reinterpret_cast<quint8*>(bytes.data()), rc);
+    return bytes;
+}
+
+}
+
 namespace TestUtil {
 
 class MeasureAvgPortion